@@ -0,0 +1,526 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "batchrender.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDomDocument>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <cmath>
+
+BatchRender::BatchRender(const QString &jobFile, const QString &melt, int concurrency) :
+    QObject(),
+    m_jobFile(QFileInfo(jobFile).absoluteFilePath()),
+    m_melt(melt),
+    m_concurrency(concurrency),
+    m_root(QFileInfo(jobFile).absolutePath()),
+    m_stateFile(m_jobFile + QStringLiteral(".state")),
+    m_next(0),
+    m_running(0),
+    m_failed(0),
+    m_skipped(0)
+{
+}
+
+bool BatchRender::load()
+{
+    QFile file(m_jobFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Cannot read job file" << m_jobFile;
+        return false;
+    }
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (!doc.isObject()) {
+        qCritical() << "Invalid job file" << m_jobFile << ':' << error.errorString();
+        return false;
+    }
+    const QJsonObject root = doc.object();
+    if (m_melt.isEmpty()) {
+        m_melt = root.value(QStringLiteral("melt")).toString(QStringLiteral("melt"));
+    }
+    if (m_concurrency <= 0) {
+        m_concurrency = qMax(1, root.value(QStringLiteral("concurrency")).toInt(1));
+    }
+
+    // Outputs completed by a previous run
+    if (m_stateFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!m_stateFile.atEnd()) {
+            const QString done = QString::fromUtf8(m_stateFile.readLine()).trimmed();
+            if (!done.isEmpty()) {
+                m_done << done;
+            }
+        }
+        m_stateFile.close();
+    }
+
+    loadPresets();
+    const QJsonArray jobs = root.value(QStringLiteral("jobs")).toArray();
+    if (jobs.isEmpty()) {
+        qCritical() << "No jobs in" << m_jobFile;
+        return false;
+    }
+    for (int i = 0; i < jobs.count(); ++i) {
+        if (!parseJob(jobs.at(i).toObject(), i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BatchRender::loadPresets()
+{
+    // Same presets as the render dialog
+    loadPresetFile(QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kdenlive/export/profiles.xml")));
+    QDir directory(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kdenlive/export/"));
+    QStringList fileList = directory.entryList(QStringList() << QStringLiteral("*.xml"), QDir::Files);
+    // User profiles override the other ones
+    fileList.removeAll(QStringLiteral("customprofiles.xml"));
+    fileList << QStringLiteral("customprofiles.xml");
+    for (const QString &fileName : fileList) {
+        loadPresetFile(directory.absoluteFilePath(fileName));
+    }
+}
+
+void BatchRender::loadPresetFile(const QString &path)
+{
+    QFile file(path);
+    QDomDocument doc;
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        return;
+    }
+    const QDomNodeList groups = doc.elementsByTagName(QStringLiteral("group"));
+    for (int i = 0; i < groups.count(); ++i) {
+        const QDomElement group = groups.at(i).toElement();
+        const QDomNodeList profiles = group.elementsByTagName(QStringLiteral("profile"));
+        for (int j = 0; j < profiles.count(); ++j) {
+            const QDomElement profile = profiles.at(j).toElement();
+            Preset preset;
+            preset.renderer = group.attribute(QStringLiteral("renderer"), QStringLiteral("avformat"));
+            preset.args = profile.attribute(QStringLiteral("args"));
+            preset.extension = profile.attribute(QStringLiteral("extension"));
+            preset.videoQuality = profile.attribute(QStringLiteral("defaultbitrate"), profile.attribute(QStringLiteral("defaultquality")));
+            preset.audioQuality = profile.attribute(QStringLiteral("defaultaudiobitrate"), profile.attribute(QStringLiteral("defaultaudioquality")));
+            preset.speeds = profile.attribute(QStringLiteral("speeds")).split(QLatin1Char(';'), QString::SkipEmptyParts);
+            m_presets.insert(profile.attribute(QStringLiteral("name")), preset);
+        }
+    }
+}
+
+bool BatchRender::outputArguments(const QJsonObject &output, QString &consumer, QStringList &args, QString &file) const
+{
+    file = output.value(QStringLiteral("file")).toString();
+    if (file.isEmpty()) {
+        qCritical() << "Output without file name";
+        return false;
+    }
+    file = QFileInfo(m_root, file).absoluteFilePath();
+    consumer = output.value(QStringLiteral("consumer")).toString(QStringLiteral("avformat"));
+    const QString presetName = output.value(QStringLiteral("preset")).toString();
+    if (!presetName.isEmpty()) {
+        if (!m_presets.contains(presetName)) {
+            qCritical() << "Unknown preset" << presetName;
+            return false;
+        }
+        const Preset preset = m_presets.value(presetName);
+        consumer = preset.renderer;
+        if (QFileInfo(file).suffix().isEmpty() && !preset.extension.isEmpty()) {
+            file.append(QLatin1Char('.') + preset.extension);
+        }
+        const QString videoQuality = output.contains(QStringLiteral("quality")) ? QString::number(output.value(QStringLiteral("quality")).toInt()) : preset.videoQuality;
+        const QString audioQuality = output.contains(QStringLiteral("audioQuality")) ? QString::number(output.value(QStringLiteral("audioQuality")).toInt()) : preset.audioQuality;
+        args = preset.args.simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+        if (!preset.speeds.isEmpty()) {
+            // Same default speed as the render dialog
+            int speed = output.value(QStringLiteral("speed")).toInt((preset.speeds.count() - 1) * 3 / 4);
+            args << preset.speeds.at(qBound(0, speed, preset.speeds.count() - 1)).split(QLatin1Char(' '), QString::SkipEmptyParts);
+        }
+        for (int i = 0; i < args.count(); ++i) {
+            const QString paramName = args.at(i).section(QLatin1Char('='), 0, -2);
+            QString paramValue = args.at(i).section(QLatin1Char('='), -1);
+            if (!paramValue.startsWith(QLatin1Char('%'))) {
+                continue;
+            }
+            if (paramValue.startsWith(QLatin1String("%bitrate")) || paramValue == QLatin1String("%quality")) {
+                paramValue = paramValue.contains(QLatin1String("+'k'")) ? videoQuality + QLatin1Char('k') : videoQuality;
+            } else if (paramValue.startsWith(QLatin1String("%audiobitrate")) || paramValue == QLatin1String("%audioquality")) {
+                paramValue = paramValue.contains(QLatin1String("+'k'")) ? audioQuality + QLatin1Char('k') : audioQuality;
+            } else if (paramValue == QLatin1String("%passes")) {
+                paramValue = QStringLiteral("1");
+            } else if (paramValue == QLatin1String("%dar")) {
+                // The aspect ratio of the project profile is used
+                args.removeAt(i);
+                i--;
+                continue;
+            } else {
+                qCritical() << "Preset" << presetName << "requires a parameter that is not supported in batch mode:" << paramValue;
+                return false;
+            }
+            args[i] = paramName + QLatin1Char('=') + paramValue;
+        }
+    }
+    args << output.value(QStringLiteral("args")).toString().simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    if (args.isEmpty()) {
+        qCritical() << "No preset or arguments for" << file;
+        return false;
+    }
+    return true;
+}
+
+bool BatchRender::guideZone(const QString &project, const QStringList &guides, int &in, int &out) const
+{
+    QFile file(project);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        qCritical() << "Cannot read guides of" << project;
+        return false;
+    }
+    const QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+    const double den = profile.attribute(QStringLiteral("frame_rate_den")).toDouble();
+    if (den <= 0) {
+        qCritical() << "No frame rate in" << project;
+        return false;
+    }
+    const double fps = profile.attribute(QStringLiteral("frame_rate_num")).toDouble() / den;
+    QMap<int, QString> positions;
+    const QDomNodeList props = doc.elementsByTagName(QStringLiteral("property"));
+    for (int i = 0; i < props.count(); ++i) {
+        const QDomElement prop = props.at(i).toElement();
+        const QString name = prop.attribute(QStringLiteral("name"));
+        if (name.startsWith(QLatin1String("kdenlive:guide."))) {
+            // Same rounding as GenTime::frames
+            const int frame = (int) floor(name.section(QLatin1Char('.'), 1).toDouble() * fps + 0.5);
+            positions.insert(frame, prop.text());
+        }
+    }
+    const QList<int> frames = positions.keys();
+    const int start = frames.indexOf(positions.key(guides.constFirst(), -1));
+    if (start < 0) {
+        qCritical() << "No guide named" << guides.constFirst() << "in" << project;
+        return false;
+    }
+    in = frames.at(start);
+    if (guides.count() > 1) {
+        const int end = frames.indexOf(positions.key(guides.at(1), -1));
+        if (end <= start) {
+            qCritical() << "No guide named" << guides.at(1) << "after" << guides.constFirst() << "in" << project;
+            return false;
+        }
+        out = frames.at(end);
+    } else if (start + 1 < frames.count()) {
+        // Render until the next guide
+        out = frames.at(start + 1);
+    }
+    return true;
+}
+
+bool BatchRender::parseJob(const QJsonObject &job, int index)
+{
+    Task task;
+    task.process = nullptr;
+    task.progress = 0;
+    task.in = job.value(QStringLiteral("in")).toInt(-1);
+    task.out = job.value(QStringLiteral("out")).toInt(-1);
+    task.project = job.value(QStringLiteral("project")).toString();
+    if (task.project.isEmpty()) {
+        qCritical() << "Job" << index << "has no project";
+        return false;
+    }
+    task.project = QFileInfo(m_root, task.project).absoluteFilePath();
+    if (!QFile::exists(task.project)) {
+        qCritical() << "Project" << task.project << "does not exist";
+        return false;
+    }
+    task.profile = job.value(QStringLiteral("profile")).toString();
+    QStringList guides;
+    for (const QJsonValue &guide : job.value(QStringLiteral("guides")).toArray()) {
+        guides << guide.toString();
+    }
+    if (!guides.isEmpty() && !guideZone(task.project, guides, task.in, task.out)) {
+        return false;
+    }
+
+    const QJsonArray outputs = job.value(QStringLiteral("outputs")).toArray();
+    if (outputs.isEmpty()) {
+        qCritical() << "Job" << index << "has no outputs";
+        return false;
+    }
+    for (const QJsonValue &value : outputs) {
+        QString consumer;
+        QStringList args;
+        QString file;
+        if (!outputArguments(value.toObject(), consumer, args, file)) {
+            return false;
+        }
+        if (!task.consumer.isEmpty() && consumer != task.consumer) {
+            qCritical() << "All outputs of job" << index << "must use the same consumer";
+            return false;
+        }
+        task.consumer = consumer;
+        if (m_done.contains(file) && QFile::exists(file)) {
+            // Rendered by a previous run
+            m_skipped++;
+            continue;
+        }
+        task.outputs << (QStringList() << file << args);
+    }
+    if (!task.outputs.isEmpty()) {
+        m_tasks << task;
+    }
+    return true;
+}
+
+static QDomElement findProperty(const QDomElement &producer, const QString &name)
+{
+    QDomElement prop = producer.firstChildElement(QStringLiteral("property"));
+    while (!prop.isNull()) {
+        if (prop.attribute(QStringLiteral("name")) == name) {
+            return prop;
+        }
+        prop = prop.nextSiblingElement(QStringLiteral("property"));
+    }
+    return QDomElement();
+}
+
+bool BatchRender::replaceProxies(Task &task) const
+{
+    QFile file(task.project);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        qCritical() << "Cannot read" << task.project;
+        return false;
+    }
+    file.close();
+    QDomElement mlt = doc.documentElement();
+    QString root = mlt.attribute(QStringLiteral("root"));
+    if (root.isEmpty()) {
+        // The copy is not in the project folder, relative paths need a root
+        root = QFileInfo(task.project).absolutePath();
+        mlt.setAttribute(QStringLiteral("root"), root);
+    }
+    if (!root.endsWith(QLatin1Char('/'))) {
+        root.append(QLatin1Char('/'));
+    }
+    // Same as BinController::getProxies
+    QMap<QString, QString> proxies;
+    const QDomNodeList producers = doc.elementsByTagName(QStringLiteral("producer"));
+    for (int i = 0; i < producers.count(); ++i) {
+        const QDomElement e = producers.at(i).toElement();
+        QString proxy = findProperty(e, QStringLiteral("kdenlive:proxy")).text();
+        QString original = findProperty(e, QStringLiteral("kdenlive:originalurl")).text();
+        if (proxy.length() > 2 && !original.isEmpty()) {
+            if (QFileInfo(proxy).isRelative()) {
+                proxy.prepend(root);
+            }
+            if (QFileInfo(original).isRelative()) {
+                original.prepend(root);
+            }
+            proxies.insert(proxy, original);
+        }
+    }
+    if (proxies.isEmpty()) {
+        return true;
+    }
+
+    // Replace proxy clips with originals, same as MainWindow::slotPrepareRendering
+    for (int i = 0; i < producers.count(); ++i) {
+        QDomElement e = producers.at(i).toElement();
+        QDomElement resourceProp = findProperty(e, QStringLiteral("resource"));
+        QString resource = resourceProp.text();
+        const QString service = findProperty(e, QStringLiteral("mlt_service")).text();
+        if (resource.isEmpty() || service == QLatin1String("color")) {
+            continue;
+        }
+        QString prefix;
+        QString suffix;
+        if (service == QLatin1String("timewarp")) {
+            // slowmotion producer
+            prefix = resource.section(QLatin1Char(':'), 0, 0) + QLatin1Char(':');
+            resource = resource.section(QLatin1Char(':'), 1);
+        }
+        if (service == QLatin1String("framebuffer")) {
+            // slowmotion producer
+            suffix = QLatin1Char('?') + resource.section(QLatin1Char('?'), 1);
+            resource = resource.section(QLatin1Char('?'), 0, 0);
+        }
+        if (QFileInfo(resource).isRelative()) {
+            resource.prepend(root);
+        }
+        if (!proxies.contains(resource)) {
+            continue;
+        }
+        const QString replacement = proxies.value(resource);
+        resourceProp.firstChild().setNodeValue(prefix + replacement + suffix);
+        if (service == QLatin1String("timewarp")) {
+            QDomElement warp = findProperty(e, QStringLiteral("warp_resource"));
+            if (!warp.isNull()) {
+                warp.firstChild().setNodeValue(replacement);
+            }
+        }
+        // Proxy clips sometimes have a different ratio than original clips, and their metadata does not apply
+        QDomElement prop = e.firstChildElement(QStringLiteral("property"));
+        while (!prop.isNull()) {
+            QDomElement next = prop.nextSiblingElement(QStringLiteral("property"));
+            const QString name = prop.attribute(QStringLiteral("name"));
+            if (name == QLatin1String("aspect_ratio") || name.startsWith(QLatin1String("meta"))) {
+                e.removeChild(prop);
+            }
+            prop = next;
+        }
+    }
+
+    QTemporaryFile playlist(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-batch-XXXXXX.mlt")));
+    playlist.setAutoRemove(false);
+    if (!playlist.open() || playlist.write(doc.toByteArray()) < 0) {
+        qCritical() << "Cannot write the rendering playlist of" << task.project;
+        return false;
+    }
+    task.playlist = playlist.fileName();
+    return true;
+}
+
+QStringList BatchRender::meltArguments(const Task &task) const
+{
+    QStringList args;
+    args << (task.playlist.isEmpty() ? task.project : task.playlist);
+    if (task.in >= 0) {
+        args << QStringLiteral("in=%1").arg(task.in);
+    }
+    if (task.out >= 0) {
+        args << QStringLiteral("out=%1").arg(task.out);
+    }
+    if (!task.profile.isEmpty()) {
+        args << QStringLiteral("-profile") << task.profile;
+    }
+    if (task.outputs.count() == 1) {
+        const QStringList &output = task.outputs.constFirst();
+        args << QStringLiteral("-consumer") << task.consumer + QLatin1Char(':') + output.constFirst() << QStringLiteral("progress=1") << output.mid(1);
+        return args;
+    }
+    // Process the project once for all outputs
+    args << QStringLiteral("-consumer") << QStringLiteral("multi") << QStringLiteral("progress=1");
+    for (int i = 0; i < task.outputs.count(); ++i) {
+        const QStringList &output = task.outputs.at(i);
+        args << QStringLiteral("%1=%2:%3").arg(i).arg(task.consumer, output.constFirst());
+        for (int j = 1; j < output.count(); ++j) {
+            args << QStringLiteral("%1.%2").arg(i).arg(output.at(j));
+        }
+    }
+    return args;
+}
+
+void BatchRender::start()
+{
+    QTextStream out(stdout);
+    out << "Rendering " << m_tasks.count() << " jobs, " << m_concurrency << " at a time";
+    if (m_skipped > 0) {
+        out << ", skipping " << m_skipped << " outputs already rendered";
+    }
+    out << endl;
+    if (!m_stateFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Cannot write" << m_stateFile.fileName() << ", the batch will not be resumable";
+    }
+    startNextTasks();
+}
+
+void BatchRender::startNextTasks()
+{
+    while (m_running < m_concurrency && m_next < m_tasks.count()) {
+        Task &task = m_tasks[m_next];
+        if (!replaceProxies(task)) {
+            m_failed++;
+            m_next++;
+            continue;
+        }
+        task.process = new QProcess(this);
+        task.process->setProperty("task", m_next);
+        task.process->setReadChannel(QProcess::StandardError);
+        connect(task.process, &QProcess::readyReadStandardError, this, &BatchRender::slotReadProgress);
+        connect(task.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &BatchRender::slotProcessFinished);
+        const QStringList args = meltArguments(task);
+        QTextStream(stdout) << "[" << m_next + 1 << "/" << m_tasks.count() << "] " << m_melt << ' ' << args.join(QLatin1Char(' ')) << endl;
+        task.process->start(m_melt, args);
+        m_running++;
+        m_next++;
+    }
+    if (m_running == 0) {
+        QTextStream(stdout) << "Batch finished: " << m_tasks.count() - m_failed << " jobs rendered, " << m_failed << " failed" << endl;
+        m_stateFile.close();
+        qApp->exit(m_failed > 0 ? 1 : 0);
+    }
+}
+
+void BatchRender::slotReadProgress()
+{
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    if (!process) {
+        return;
+    }
+    Task &task = m_tasks[process->property("task").toInt()];
+    const QString result = QString::fromLocal8Bit(process->readAllStandardError()).simplified();
+    if (!result.startsWith(QLatin1String("Current Frame"))) {
+        task.errors.append(result + QLatin1Char('\n'));
+        return;
+    }
+    const int progress = result.section(QLatin1Char(' '), -1).toInt();
+    // Print every 10%
+    if (progress / 10 > task.progress / 10) {
+        QTextStream(stdout) << "[" << process->property("task").toInt() + 1 << "/" << m_tasks.count() << "] " << QFileInfo(task.outputs.constFirst().constFirst()).fileName() << ": " << progress << '%' << endl;
+    }
+    task.progress = qMax(task.progress, progress);
+}
+
+void BatchRender::slotProcessFinished(int exitCode, QProcess::ExitStatus status)
+{
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    if (!process) {
+        return;
+    }
+    const int index = process->property("task").toInt();
+    Task &task = m_tasks[index];
+    QTextStream out(stdout);
+    if (status == QProcess::NormalExit && exitCode == 0) {
+        for (const QStringList &output : task.outputs) {
+            if (m_stateFile.isOpen()) {
+                m_stateFile.write(output.constFirst().toUtf8() + '\n');
+            }
+            out << "[" << index + 1 << "/" << m_tasks.count() << "] " << output.constFirst() << " done" << endl;
+        }
+        m_stateFile.flush();
+    } else {
+        m_failed++;
+        QTextStream(stderr) << "[" << index + 1 << "/" << m_tasks.count() << "] Rendering of " << task.project << " failed:\n" << task.errors << endl;
+    }
+    if (!task.playlist.isEmpty()) {
+        QFile::remove(task.playlist);
+        task.playlist.clear();
+    }
+    task.process = nullptr;
+    process->deleteLater();
+    m_running--;
+    startNextTasks();
+}
@@ -0,0 +1,122 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BATCHRENDER_H
+#define BATCHRENDER_H
+
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+/**
+ * @class BatchRender
+ * @brief Renders the projects listed in a JSON job file, without GUI or D-Bus.
+ *
+ * Each job of the file renders a project, or a zone of it, to one or more outputs.
+ * The outputs of a job are encoded from a single melt process. Several jobs run at
+ * the same time within a concurrency limit. Completed outputs are recorded in a
+ * state file next to the job file, so that a batch interrupted by a crash can be
+ * started again and only renders the missing outputs. Like the render dialog,
+ * proxy clips are replaced by their original clips in a temporary playlist.
+ *
+ * Job file example:
+ * @code
+ * {
+ *   "concurrency": 2,
+ *   "jobs": [
+ *     { "project": "film.kdenlive", "guides": ["Intro", "Credits"],
+ *       "outputs": [ { "file": "film.mp4", "preset": "MP4 - the dominating format (H264/AAC)" },
+ *                    { "file": "film.wav", "args": "f=wav acodec=pcm_s16le vn=1" } ] }
+ *   ]
+ * }
+ * @endcode
+ */
+class BatchRender : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief @param concurrency overrides the number of jobs running at the same time if > 0 */
+    BatchRender(const QString &jobFile, const QString &melt, int concurrency);
+    /** @brief Read the job file, returns false and prints the error if it is not valid */
+    bool load();
+
+public slots:
+    void start();
+
+private slots:
+    void slotReadProgress();
+    void slotProcessFinished(int exitCode, QProcess::ExitStatus status);
+
+private:
+    struct Preset {
+        QString renderer;
+        QString args;
+        QString extension;
+        QString videoQuality;
+        QString audioQuality;
+        QStringList speeds;
+    };
+    struct Task {
+        QString project;
+        /** @brief Temporary copy of the project using the original clips instead of proxies, empty if not needed */
+        QString playlist;
+        QString profile;
+        int in;
+        int out;
+        /** @brief Destination file followed by its consumer arguments */
+        QList<QStringList> outputs;
+        QString consumer;
+        QProcess *process;
+        int progress;
+        QString errors;
+    };
+    QString m_jobFile;
+    QString m_melt;
+    int m_concurrency;
+    QDir m_root;
+    QList<Task> m_tasks;
+    QMap<QString, Preset> m_presets;
+    /** @brief Outputs rendered by a previous run of this job file */
+    QStringList m_done;
+    QFile m_stateFile;
+    int m_next;
+    int m_running;
+    int m_failed;
+    int m_skipped;
+    void loadPresets();
+    void loadPresetFile(const QString &path);
+    bool parseJob(const QJsonObject &job, int index);
+    /** @brief Consumer arguments of an output, from its preset and extra arguments */
+    bool outputArguments(const QJsonObject &output, QString &consumer, QStringList &args, QString &file) const;
+    /** @brief Find the zone between two guides of a Kdenlive project */
+    bool guideZone(const QString &project, const QStringList &guides, int &in, int &out) const;
+    /** @brief Write a copy of the task's project with proxy clips replaced by their originals, as done by the render dialog */
+    bool replaceProxies(Task &task) const;
+    QStringList meltArguments(const Task &task) const;
+    void startNextTasks();
+};
+
+#endif
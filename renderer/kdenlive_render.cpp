@@ -24,7 +24,9 @@
 #include <QString>
 #include <QUrl>
 #include <QDebug>
+#include "batchrender.h"
 #include "renderjob.h"
+#include "segmentedrenderjob.h"
 
 int main(int argc, char **argv)
 {
@@ -32,6 +34,25 @@ int main(int argc, char **argv)
     QStringList args = app.arguments();
     QStringList preargs;
     QString locale;
+    if (args.count() >= 2 && args.at(1).startsWith(QLatin1String("-batch:"))) {
+        // Headless rendering of a job file, no D-Bus connection to Kdenlive
+        const QString jobFile = args.at(1).section(QLatin1Char(':'), 1, -1);
+        int concurrency = 0;
+        QString melt;
+        for (int i = 2; i < args.count(); ++i) {
+            if (args.at(i).startsWith(QLatin1String("-jobs:"))) {
+                concurrency = args.at(i).section(QLatin1Char(':'), 1).toInt();
+            } else if (args.at(i).startsWith(QLatin1String("-melt:"))) {
+                melt = args.at(i).section(QLatin1Char(':'), 1, -1);
+            }
+        }
+        BatchRender batch(jobFile, melt, concurrency);
+        if (!batch.load()) {
+            return 2;
+        }
+        QMetaObject::invokeMethod(&batch, "start", Qt::QueuedConnection);
+        return app.exec();
+    }
     if (args.count() >= 7) {
         int pid = 0;
         int in = -1;
@@ -58,6 +79,31 @@ int main(int argc, char **argv)
             locale = args.at(0).section(QLatin1Char(':'), 1);
             args.removeFirst();
         }
+        QList<int> segments;
+        int parallel = 0;
+        QString ffmpeg;
+        if (args.at(0).startsWith(QLatin1String("-segments:"))) {
+            const QStringList positions = args.takeFirst().section(QLatin1Char(':'), 1).split(QLatin1Char(','), QString::SkipEmptyParts);
+            for (const QString &pos : positions) {
+                segments << pos.toInt();
+            }
+        }
+        if (args.at(0).startsWith(QLatin1String("-parallel:"))) {
+            parallel = args.takeFirst().section(QLatin1Char(':'), 1).toInt();
+        }
+        if (args.at(0).startsWith(QLatin1String("-ffmpeg:"))) {
+            ffmpeg = args.takeFirst().section(QLatin1Char(':'), 1, -1);
+        }
+        QList<QStringList> outputs;
+        while (args.at(0).startsWith(QLatin1String("-output:"))) {
+            // Destination and consumer arguments, percent encoded and separated by new lines
+            const QString output = QUrl::fromPercentEncoding(args.takeFirst().section(QLatin1Char(':'), 1).toUtf8());
+            QStringList outputArgs = output.split(QLatin1Char('\n'), QString::SkipEmptyParts);
+            if (outputArgs.count() > 1) {
+                outputArgs[0] = QFileInfo(outputArgs.at(0)).absoluteFilePath();
+                outputs << outputArgs;
+            }
+        }
         if (args.at(0).startsWith(QLatin1String("in="))) {
             in = args.takeFirst().section(QLatin1Char('='), -1).toInt();
         }
@@ -120,10 +166,26 @@ int main(int argc, char **argv)
         }
 
         qDebug() << "//STARTING RENDERING: " << erase << ',' << usekuiserver << ',' << render << ',' << profile << ',' << rendermodule << ',' << player << ',' << src << ',' << dest << ',' << preargs << ',' << args << ',' << in << ',' << out;
+        if (dualpass && !outputs.isEmpty()) {
+            qWarning() << "Additional outputs are not supported with 2 pass encoding, ignoring them";
+            outputs.clear();
+        }
+        if (!segments.isEmpty() && outputs.isEmpty() && !dualpass && in >= 0 && out > in && SegmentedRenderJob::canJoinSegments(rendermodule, dest, args)) {
+            // Render segments in parallel and join them without re-encoding
+            SegmentedRenderJob *job = new SegmentedRenderJob(erase, pid, render, profile, rendermodule, player, src, dest, preargs, args, in, out);
+            job->setSegments(segments, parallel, ffmpeg.isEmpty() ? QStringLiteral("ffmpeg") : ffmpeg);
+            if (!locale.isEmpty()) {
+                job->setLocale(locale);
+            }
+            // Start from the event loop, so that an early failure can quit the application
+            QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+            return app.exec();
+        }
         RenderJob *job = new RenderJob(doerase, usekuiserver, pid, render, profile, rendermodule, player, src, dest, preargs, args, in, out);
         if (!locale.isEmpty()) {
             job->setLocale(locale);
         }
+        job->setOutputs(outputs);
         job->start();
         RenderJob *dualjob = nullptr;
         if (dualpass) {
@@ -138,10 +200,15 @@ int main(int argc, char **argv)
         delete dualjob;
     } else {
         fprintf(stderr, "Kdenlive video renderer for MLT.\nUsage: "
-                "kdenlive_render [-erase] [-kuiserver] [-locale:LOCALE] [in=pos] [out=pos] [render] [profile] [rendermodule] [player] [src] [dest] [[arg1] [arg2] ...]\n"
+                "kdenlive_render [-erase] [-kuiserver] [-locale:LOCALE] [-segments:pos1,pos2...] [-parallel:COUNT] [-ffmpeg:PATH] [-output:OUTPUT...] [in=pos] [out=pos] [render] [profile] [rendermodule] [player] [src] [dest] [[arg1] [arg2] ...]\n"
+                "       kdenlive_render -batch:JOBFILE [-jobs:COUNT] [-melt:PATH]\n"
                 "  -erase: if that parameter is present, src file will be erased at the end\n"
                 "  -kuiserver: if that parameter is present, use KDE job tracker\n"
                 "  -locale:LOCALE : set a locale for rendering. For example, -locale:fr_FR.UTF-8 will use a french locale (comma as numeric separator)\n"
+                "  -segments:pos1,pos2... : render the video in segments starting at these frames, then join them with ffmpeg\n"
+                "  -parallel:COUNT : number of segments rendered at the same time\n"
+                "  -ffmpeg:PATH : path to the ffmpeg executable used to join the segments\n"
+                "  -output:OUTPUT : also encode the frames to another file, OUTPUT is the percent encoded destination followed by its arguments, separated by new lines\n"
                 "  in=pos: start rendering at frame pos\n"
                 "  out=pos: end rendering at frame pos\n"
                 "  render: path to MLT melt renderer\n"
@@ -150,7 +217,10 @@ int main(int argc, char **argv)
                 "  player: path to video player to play when rendering is over, use '-' to disable playing\n"
                 "  src: source file (usually MLT XML)\n"
                 "  dest: destination file\n"
-                "  args: space separated libavformat arguments\n");
+                "  args: space separated libavformat arguments\n"
+                "  -batch:JOBFILE : render the projects listed in a JSON job file, outputs already rendered by a previous run are skipped\n"
+                "  -jobs:COUNT : number of batch jobs rendered at the same time\n"
+                "  -melt:PATH : path to the melt executable used for batch rendering\n");
     }
 }
 
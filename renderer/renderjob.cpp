@@ -23,6 +23,30 @@
 #include <QFile>
 #include <QThread>
 #include <QStringList>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QSysInfo>
+
+static double profileFps(const QString &profile)
+{
+    QFile file(profile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return 0;
+    }
+    double num = 0;
+    double den = 0;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).simplified();
+        if (line.startsWith(QLatin1String("frame_rate_num="))) {
+            num = line.section(QLatin1Char('='), 1).toDouble();
+        } else if (line.startsWith(QLatin1String("frame_rate_den="))) {
+            den = line.section(QLatin1Char('='), 1).toDouble();
+        }
+    }
+    return den > 0 ? num / den : 0;
+}
 
 // Can't believe I need to do this to sleep.
 class SleepThread : QThread
@@ -39,6 +63,8 @@ RenderJob::RenderJob(bool erase, bool usekuiserver, int pid, const QString &rend
     QObject(),
     m_scenelist(scenelist),
     m_dest(dest),
+    m_rendermodule(rendermodule),
+    m_consumerIndex(0),
     m_progress(0),
     m_prog(renderer),
     m_player(player),
@@ -50,7 +76,12 @@ RenderJob::RenderJob(bool erase, bool usekuiserver, int pid, const QString &rend
     m_seconds(0),
     m_frame(0),
     m_pid(pid),
-    m_dualpass(false)
+    m_dualpass(false),
+    m_statsFile(dest + QStringLiteral(".progress.jsonl")),
+    m_frameCount(in >= 0 && out > in ? out - in + 1 : 0),
+    m_profileFps(profileFps(profile)),
+    m_statsTime(0),
+    m_statsFrame(0)
 {
     m_renderProcess = new QProcess;
     m_renderProcess->setReadChannel(QProcess::StandardError);
@@ -73,6 +104,7 @@ RenderJob::RenderJob(bool erase, bool usekuiserver, int pid, const QString &rend
         m_args << QStringLiteral("profile=") + profile;
     }
     m_args << QStringLiteral("-profile") << profile;
+    m_consumerIndex = m_args.count();
     m_args << QStringLiteral("-consumer") << rendermodule + QLatin1Char(':') + m_dest << QStringLiteral("progress=1") << args;
 
     m_dualpass = args.contains(QStringLiteral("pass=1"));
@@ -96,22 +128,189 @@ void RenderJob::setLocale(const QString &locale)
     qputenv("LC_NUMERIC", locale.toUtf8().constData());
 }
 
+void RenderJob::setOutputs(const QList<QStringList> &outputs)
+{
+    if (outputs.isEmpty()) {
+        return;
+    }
+    // Skip -consumer, the consumer url and progress
+    const QStringList consumerArgs = m_args.mid(m_consumerIndex + 3);
+    m_args = m_args.mid(0, m_consumerIndex);
+    m_args << QStringLiteral("-consumer") << QStringLiteral("multi") << QStringLiteral("progress=1");
+    m_args << QStringLiteral("0=") + m_rendermodule + QLatin1Char(':') + m_dest;
+    for (const QString &arg : consumerArgs) {
+        if (arg.startsWith(QLatin1String("real_time=")) || arg.startsWith(QLatin1String("glsl."))) {
+            // Processing parameters, not encoding ones
+            m_args << arg;
+        } else {
+            m_args << QStringLiteral("0.") + arg;
+        }
+    }
+    int index = 1;
+    for (const QStringList &output : outputs) {
+        if (output.isEmpty()) {
+            continue;
+        }
+        const QString dest = output.constFirst();
+        m_outputs << dest;
+        m_args << QStringLiteral("%1=%2:%3").arg(index).arg(m_rendermodule, dest);
+        for (int i = 1; i < output.count(); ++i) {
+            if (output.at(i).startsWith(QLatin1String("real_time="))) {
+                continue;
+            }
+            m_args << QStringLiteral("%1.%2").arg(index).arg(output.at(i));
+        }
+        index++;
+    }
+}
+
+void RenderJob::callKdenlive(const QString &method, QList<QVariant> args)
+{
+    m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, method, args);
+    for (const QString &output : m_outputs) {
+        args[0] = output;
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, method, args);
+    }
+}
+
+int RenderJob::pass() const
+{
+    if (m_args.contains(QStringLiteral("pass=1"))) {
+        return 1;
+    }
+    return m_args.contains(QStringLiteral("pass=2")) ? 2 : 0;
+}
+
+qint64 RenderJob::outputSize() const
+{
+    qint64 size = QFileInfo(m_dest).size();
+    for (const QString &output : m_outputs) {
+        size += QFileInfo(output).size();
+    }
+    return size;
+}
+
+void RenderJob::writeStats(QJsonObject stats)
+{
+    if (!m_statsFile.isOpen()) {
+        return;
+    }
+    stats.insert(QStringLiteral("time"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    if (pass() > 0) {
+        stats.insert(QStringLiteral("pass"), pass());
+    }
+    m_statsFile.write(QJsonDocument(stats).toJson(QJsonDocument::Compact) + '\n');
+    m_statsFile.flush();
+}
+
+void RenderJob::updateStats(int frame)
+{
+    const qint64 elapsed = m_renderTimer.elapsed();
+    if (elapsed - m_statsTime < 1000 || frame <= m_statsFrame) {
+        return;
+    }
+    const double fps = (frame - m_statsFrame) * 1000.0 / (elapsed - m_statsTime);
+    // melt counts frames from the in point
+    const int done = frame;
+    const double averageFps = done * 1000.0 / qMax((qint64)1, elapsed);
+    m_statsTime = elapsed;
+    m_statsFrame = frame;
+
+    QJsonObject stats;
+    stats.insert(QStringLiteral("event"), QStringLiteral("progress"));
+    stats.insert(QStringLiteral("frame"), done);
+    if (m_frameCount > 0) {
+        stats.insert(QStringLiteral("frames"), m_frameCount);
+        stats.insert(QStringLiteral("eta"), qRound((m_frameCount - done) / qMax(0.01, averageFps)));
+    }
+    stats.insert(QStringLiteral("fps"), qRound(fps * 10) / 10.0);
+    stats.insert(QStringLiteral("averageFps"), qRound(averageFps * 10) / 10.0);
+    if (m_profileFps > 0) {
+        // Render speed compared to real time playback
+        stats.insert(QStringLiteral("speed"), qRound(fps / m_profileFps * 100) / 100.0);
+    }
+    stats.insert(QStringLiteral("elapsed"), elapsed / 1000.0);
+    stats.insert(QStringLiteral("bytes"), outputSize());
+    writeStats(stats);
+
+    if (m_kdenliveinterface && m_kdenliveinterface->isValid()) {
+        QList<QVariant> args;
+        args << m_dest << QString::fromUtf8(QJsonDocument(stats).toJson(QJsonDocument::Compact));
+        callKdenlive(QStringLiteral("setRenderingStats"), args);
+    }
+}
+
+void RenderJob::addToHistory(const QString &status)
+{
+    const qint64 elapsed = m_renderTimer.isValid() ? m_renderTimer.elapsed() : 0;
+    const int done = m_statsFrame;
+    QJsonObject stats;
+    stats.insert(QStringLiteral("event"), status);
+    stats.insert(QStringLiteral("frame"), done);
+    if (m_frameCount > 0) {
+        stats.insert(QStringLiteral("frames"), m_frameCount);
+    }
+    stats.insert(QStringLiteral("duration"), elapsed / 1000.0);
+    if (elapsed > 0) {
+        const double averageFps = done * 1000.0 / elapsed;
+        stats.insert(QStringLiteral("averageFps"), qRound(averageFps * 10) / 10.0);
+        if (m_profileFps > 0) {
+            stats.insert(QStringLiteral("speed"), qRound(averageFps / m_profileFps * 100) / 100.0);
+        }
+    }
+    stats.insert(QStringLiteral("bytes"), outputSize());
+    writeStats(stats);
+    m_statsFile.close();
+
+    // Keep one line per render in a file shared by all renders of this machine
+    const QString historyDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kdenlive");
+    QFile history(historyDir + QStringLiteral("/renderhistory.jsonl"));
+    if (!QDir().mkpath(historyDir) || !history.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Unable to write render history to " << history.fileName();
+        return;
+    }
+    stats.insert(QStringLiteral("time"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    stats.insert(QStringLiteral("host"), QSysInfo::machineHostName());
+    stats.insert(QStringLiteral("cpus"), QThread::idealThreadCount());
+    stats.insert(QStringLiteral("dest"), m_dest);
+    stats.insert(QStringLiteral("outputs"), m_outputs.count() + 1);
+    if (m_profileFps > 0) {
+        stats.insert(QStringLiteral("profileFps"), m_profileFps);
+    }
+    if (pass() > 0) {
+        stats.insert(QStringLiteral("pass"), pass());
+    }
+    // Encoding parameters that matter most for the render speed
+    for (const QString &arg : m_args.mid(m_consumerIndex)) {
+        const QString name = arg.section(QLatin1Char('='), 0, 0);
+        if (name == QLatin1String("vcodec") || name == QLatin1String("acodec") || name == QLatin1String("threads") || name == QLatin1String("real_time") || name == QLatin1String("s")) {
+            stats.insert(name, arg.section(QLatin1Char('='), 1));
+        }
+    }
+    history.write(QJsonDocument(stats).toJson(QJsonDocument::Compact) + '\n');
+}
+
 void RenderJob::slotAbort(const QString &url)
 {
-    if (m_dest == url) {
+    if (m_dest == url || m_outputs.contains(url)) {
         slotAbort();
     }
 }
 
+void RenderJob::killRender()
+{
+    m_renderProcess->kill();
+}
+
 void RenderJob::slotAbort()
 {
     qWarning() << "Job aborted by user...";
-    m_renderProcess->kill();
+    killRender();
 
     if (m_kdenliveinterface) {
         m_dbusargs[1] = -3;
         m_dbusargs.append(QString());
-        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
+        callKdenlive(QStringLiteral("setRenderingFinished"), m_dbusargs);
     }
     if (m_jobUiserver) {
         m_jobUiserver->call(QStringLiteral("terminate"), QString());
@@ -120,6 +319,11 @@ void RenderJob::slotAbort()
         QFile(m_scenelist).remove();
     }
     QFile(m_dest).remove();
+    for (const QString &output : m_outputs) {
+        QFile(output).remove();
+    }
+    addToHistory(QStringLiteral("aborted"));
+    m_statsFile.remove();
     m_logstream << "Job aborted by user" << endl;
     m_logstream.flush();
     m_logfile.close();
@@ -133,6 +337,9 @@ void RenderJob::receivedStderr()
         m_errorMessage.append(result + QStringLiteral("<br>"));
     } else {
         m_logstream << "melt: " << result << endl;
+        // Several progress messages may have been received, use the last one: "Current Frame: 123, percentage: 4"
+        int frame = result.section(QLatin1Char(','), -2, -2).section(QLatin1Char(' '), -1).toInt();
+        updateStats(frame);
         int pro = result.section(QLatin1Char(' '), -1).toInt();
         if (pro <= m_progress || pro <= 0 || pro > 100) {
             return;
@@ -143,10 +350,9 @@ void RenderJob::receivedStderr()
         } else if (m_args.contains(QStringLiteral("pass=2"))) {
             m_progress = 50 + m_progress / 2.0;
         }
-        int frame = result.section(QLatin1Char(','), 1).section(QLatin1Char(' '), -1).toInt();
         if (m_kdenliveinterface && m_kdenliveinterface->isValid()) {
             m_dbusargs[1] = m_progress;
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+            callKdenlive(QStringLiteral("setRenderingProgress"), m_dbusargs);
         }
         if (m_jobUiserver) {
             m_jobUiserver->call(QStringLiteral("setPercent"), (uint) m_progress);
@@ -213,10 +419,32 @@ void RenderJob::start()
 
     // Because of the logging, we connect to stderr in all cases.
     connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+
+    startStats();
     m_renderProcess->start(m_prog, m_args);
     m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << endl;
 }
 
+void RenderJob::startStats()
+{
+    // The second pass of a dual pass encoding continues the stats of the first one
+    if (!m_statsFile.open(pass() == 2 ? QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text : QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "Unable to write render stats to " << m_statsFile.fileName();
+    }
+    QJsonObject stats;
+    stats.insert(QStringLiteral("event"), QStringLiteral("start"));
+    stats.insert(QStringLiteral("dest"), m_dest);
+    if (m_frameCount > 0) {
+        stats.insert(QStringLiteral("frames"), m_frameCount);
+    }
+    if (m_profileFps > 0) {
+        stats.insert(QStringLiteral("profileFps"), m_profileFps);
+    }
+    stats.insert(QStringLiteral("args"), m_args.join(QLatin1Char(' ')));
+    writeStats(stats);
+    m_renderTimer.start();
+}
+
 void RenderJob::initKdenliveDbusInterface()
 {
     QString kdenliveId;
@@ -248,7 +476,7 @@ void RenderJob::initKdenliveDbusInterface()
         m_dbusargs.append(m_dest);
         m_dbusargs.append((int) 0);
         if (!m_args.contains(QStringLiteral("pass=2"))) {
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+            callKdenlive(QStringLiteral("setRenderingProgress"), m_dbusargs);
         }
         connect(m_kdenliveinterface, SIGNAL(abortRenderJob(QString)),
                 this, SLOT(slotAbort(QString)));
@@ -274,7 +502,7 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
         if (m_kdenliveinterface) {
             m_dbusargs[1] = (int) - 2;
             m_dbusargs.append(error);
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
+            callKdenlive(QStringLiteral("setRenderingFinished"), m_dbusargs);
         }
         QProcess::startDetached(QStringLiteral("kdialog"), QStringList() << QStringLiteral("--error") << error);
         m_logstream << error << endl;
@@ -285,39 +513,55 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
     }
     if (status == QProcess::CrashExit || m_renderProcess->error() != QProcess::UnknownError || m_renderProcess->exitCode() != 0) {
         // rendering crashed
-        if (m_kdenliveinterface) {
-            m_dbusargs[1] = (int) - 2;
-            m_dbusargs.append(m_errorMessage);
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
-        }
-        QStringList args;
-        QString error = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
-        args << QStringLiteral("--error") << error;
-        m_logstream << error << endl;
-        QProcess::startDetached(QStringLiteral("kdialog"), args);
-        qApp->quit();
+        renderFailed(m_errorMessage);
     } else {
-        if (!m_dualpass && m_kdenliveinterface) {
-            m_dbusargs[1] = (int) - 1;
-            m_dbusargs.append(QString());
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
-        }
-        m_logstream << "Rendering of " << m_dest << " finished" << endl;
-        if (!m_dualpass && m_player.length() > 3 && m_player.contains(QLatin1Char(' '))) {
-            QStringList args = m_player.split(QLatin1Char(' '));
-            QString exec = args.takeFirst();
-            // Decode url
-            QString url = QUrl::fromEncoded(args.takeLast().toUtf8()).toLocalFile();
-            args << url;
-            QProcess::startDetached(exec, args);
-        }
-        m_logstream.flush();
-        if (m_dualpass) {
-            emit renderingFinished();
-            deleteLater();
-        } else  {
-            m_logfile.remove();
-            qApp->quit();
-        }
+        renderSucceeded();
+    }
+}
+
+void RenderJob::renderFailed(const QString &details)
+{
+    if (m_kdenliveinterface) {
+        m_dbusargs[1] = (int) - 2;
+        m_dbusargs.append(details);
+        callKdenlive(QStringLiteral("setRenderingFinished"), m_dbusargs);
+    }
+    addToHistory(QStringLiteral("failed"));
+    QStringList args;
+    QString error = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
+    args << QStringLiteral("--error") << error;
+    m_logstream << error << endl;
+    QProcess::startDetached(QStringLiteral("kdialog"), args);
+    qApp->quit();
+}
+
+void RenderJob::renderSucceeded()
+{
+    if (!m_dualpass && m_kdenliveinterface) {
+        m_dbusargs[1] = (int) - 1;
+        m_dbusargs.append(QString());
+        callKdenlive(QStringLiteral("setRenderingFinished"), m_dbusargs);
+    }
+    if (m_frameCount > 0) {
+        // The last progress message is usually not the last frame
+        m_statsFrame = m_frameCount;
+    }
+    addToHistory(QStringLiteral("finished"));
+    m_logstream << "Rendering of " << m_dest << " finished" << endl;
+    if (!m_dualpass && m_player.length() > 3 && m_player.contains(QLatin1Char(' '))) {
+        QStringList args = m_player.split(QLatin1Char(' '));
+        QString exec = args.takeFirst();
+        // Decode url
+        QString url = QUrl::fromEncoded(args.takeLast().toUtf8()).toLocalFile();
+        args << url;
+        QProcess::startDetached(exec, args);
+    }
+    m_logstream.flush();
+    if (m_dualpass) {
+        emit renderingFinished();
+        deleteLater();
+    } else  {
+        m_logfile.remove();
+        qApp->quit();
     }
 }
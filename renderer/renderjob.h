@@ -24,6 +24,8 @@
 #include <QObject>
 #include <QDBusInterface>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QJsonObject>
 // Testing
 #include <QTemporaryFile>
 #include <QTextStream>
@@ -34,11 +36,14 @@ class RenderJob : public QObject
 
 public:
     RenderJob(bool erase, bool usekuiserver, int pid, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &player, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, int in = -1, int out = -1);
-    ~RenderJob();
+    virtual ~RenderJob();
     void setLocale(const QString &locale);
+    /** @brief Encode the rendered frames to additional files, each output is the destination followed by its consumer arguments.
+     *  The timeline is only processed once, frames are dispatched to all encoders through MLT's multi consumer. */
+    void setOutputs(const QList<QStringList> &outputs);
 
 public slots:
-    void start();
+    virtual void start();
 
 private slots:
     void slotIsOver(QProcess::ExitStatus status, bool isWritable = true);
@@ -47,9 +52,14 @@ private slots:
     void slotAbort(const QString &url);
     void slotCheckProcess(QProcess::ProcessState state);
 
-private:
+protected:
     QString m_scenelist;
     QString m_dest;
+    /** @brief Additional destination files of a multi-output job. */
+    QStringList m_outputs;
+    QString m_rendermodule;
+    /** @brief Position of the consumer arguments in m_args. */
+    int m_consumerIndex;
     int m_progress;
     QString m_prog;
     QString m_player;
@@ -71,7 +81,37 @@ private:
     QStringList m_args;
     /** @brief Used to write to the log file. */
     QTextStream m_logstream;
+    /** @brief JSON lines file receiving the render progress and timings. */
+    QFile m_statsFile;
+    QElapsedTimer m_renderTimer;
+    /** @brief Number of frames to render (0 if unknown). */
+    int m_frameCount;
+    /** @brief Frame rate of the project profile, used to compare the render speed with real time. */
+    double m_profileFps;
+    qint64 m_statsTime;
+    /** @brief Last frame reported by melt, counted from the in point. */
+    int m_statsFrame;
     void initKdenliveDbusInterface();
+    /** @brief Stop the render processes, called when the job is aborted. */
+    virtual void killRender();
+    /** @brief Open the stats file and start timing the render. */
+    void startStats();
+    /** @brief Report a failed render to Kdenlive and the user, then quit. @param details the render process errors */
+    void renderFailed(const QString &details);
+    /** @brief Report a successful render to Kdenlive and start the player, then quit or start the second pass. */
+    void renderSucceeded();
+    /** @brief Call a method of Kdenlive's rendering interface for each output of this job, the first argument is the output url. */
+    void callKdenlive(const QString &method, QList<QVariant> args);
+    /** @brief Pass number (1 or 2) for dual pass encoding, 0 otherwise. */
+    int pass() const;
+    /** @brief Write the progress of the render process to the stats file and send it to Kdenlive, at most once per second. */
+    void updateStats(int frame);
+    /** @brief Append a line to the JSON lines stats file next to the output. */
+    void writeStats(QJsonObject stats);
+    /** @brief Add this render to the render history, used to follow the render speed of a machine over time. */
+    void addToHistory(const QString &status);
+    /** @brief Total size of the files written by this job. */
+    qint64 outputSize() const;
 
 signals:
     void renderingFinished();
@@ -0,0 +1,314 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "segmentedrenderjob.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+SegmentedRenderJob::SegmentedRenderJob(bool erase, int pid, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &player, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, int in, int out) :
+    RenderJob(erase, false, pid, renderer, profile, rendermodule, player, scenelist, dest, preargs, args, in, out),
+    m_profile(profile),
+    m_ffmpeg(QStringLiteral("ffmpeg")),
+    m_preargs(preargs),
+    m_consumerArgs(args),
+    m_in(in),
+    m_out(out),
+    m_parallel(2),
+    m_joinProcess(nullptr),
+    m_tmpDir(nullptr)
+{
+    m_audio.process = nullptr;
+}
+
+SegmentedRenderJob::~SegmentedRenderJob()
+{
+    killProcesses();
+    delete m_tmpDir;
+}
+
+bool SegmentedRenderJob::canJoinSegments(const QString &rendermodule, const QString &dest, const QStringList &args)
+{
+    if (rendermodule != QLatin1String("avformat") || args.contains(QStringLiteral("vn=1"))) {
+        return false;
+    }
+    // Containers and codecs that the ffmpeg concat demuxer can join with stream copy
+    static const QStringList containers {QStringLiteral("mp4"), QStringLiteral("m4v"), QStringLiteral("mov"), QStringLiteral("mkv"), QStringLiteral("webm"), QStringLiteral("avi"), QStringLiteral("ts")};
+    static const QStringList codecs {QStringLiteral("libx264"), QStringLiteral("libx265"), QStringLiteral("mpeg4"), QStringLiteral("mpeg2video"), QStringLiteral("libvpx"), QStringLiteral("libvpx-vp9"), QStringLiteral("prores"), QStringLiteral("prores_ks"), QStringLiteral("dnxhd"), QStringLiteral("mjpeg"), QStringLiteral("ffv1"), QStringLiteral("huffyuv"), QStringLiteral("utvideo")};
+    if (!containers.contains(QFileInfo(dest).suffix().toLower())) {
+        return false;
+    }
+    for (const QString &arg : args) {
+        if (arg.startsWith(QLatin1String("vcodec="))) {
+            return codecs.contains(arg.section(QLatin1Char('='), 1));
+        }
+    }
+    return false;
+}
+
+void SegmentedRenderJob::setSegments(const QList<int> &boundaries, int parallel, const QString &ffmpeg)
+{
+    m_parallel = qMax(1, parallel);
+    m_ffmpeg = ffmpeg;
+    m_segments.clear();
+    int start = m_in;
+    QList<int> ends = boundaries;
+    ends << m_out + 1;
+    for (int pos : ends) {
+        if (pos <= start || pos > m_out + 1) {
+            continue;
+        }
+        Segment segment;
+        segment.in = start;
+        segment.out = pos - 1;
+        segment.process = nullptr;
+        segment.progress = 0;
+        segment.frame = 0;
+        segment.finished = false;
+        m_segments << segment;
+        start = pos;
+    }
+}
+
+QProcess *SegmentedRenderJob::createProcess(Segment &segment, const QString &extraArg)
+{
+    QStringList args;
+    args << m_scenelist << QStringLiteral("in=%1").arg(segment.in) << QStringLiteral("out=%1").arg(segment.out);
+    args << m_preargs;
+    if (m_scenelist.startsWith(QLatin1String("consumer:"))) {
+        // Use MLT's producer_consumer, safer to pass profile in an explicit way
+        args << QStringLiteral("profile=") + m_profile;
+    }
+    args << QStringLiteral("-profile") << m_profile;
+    args << QStringLiteral("-consumer") << m_rendermodule + QLatin1Char(':') + segment.file << QStringLiteral("progress=1") << m_consumerArgs << extraArg;
+    segment.process = new QProcess(this);
+    segment.process->setReadChannel(QProcess::StandardError);
+    QProcess *process = segment.process;
+    connect(process, &QProcess::readyReadStandardError, this, [this, process]() {
+        const QString result = QString::fromLocal8Bit(process->readAllStandardError()).simplified();
+        if (!result.startsWith(QLatin1String("Current Frame"))) {
+            m_errorMessage.append(result + QStringLiteral("<br>"));
+            return;
+        }
+        // Several progress messages may have been received, use the last one: "Current Frame: 123, percentage: 4"
+        int frame = result.section(QLatin1Char(','), -2, -2).section(QLatin1Char(' '), -1).toInt();
+        int pro = result.section(QLatin1Char(' '), -1).toInt();
+        if (pro <= 0 || pro > 100) {
+            return;
+        }
+        for (Segment &s : m_segments) {
+            if (s.process == process) {
+                s.progress = pro;
+                s.frame = frame;
+                updateProgress();
+                return;
+            }
+        }
+        if (m_audio.process == process) {
+            m_audio.progress = pro;
+        }
+    });
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &SegmentedRenderJob::slotProcessFinished);
+    process->start(m_prog, args);
+    m_logstream << "Started render process: " << m_prog << ' ' << args.join(QLatin1Char(' ')) << endl;
+    return process;
+}
+
+void SegmentedRenderJob::start()
+{
+    initKdenliveDbusInterface();
+    startStats();
+    const QFileInfo destInfo(m_dest);
+    if (!QFileInfo(destInfo.absolutePath()).isWritable()) {
+        finish(false, tr("Cannot write to %1, check permissions.").arg(m_dest));
+        return;
+    }
+    // Keep the parts on the destination disk, they are as large as the final file
+    m_tmpDir = new QTemporaryDir(destInfo.absolutePath() + QStringLiteral("/.kdenlive-segments-XXXXXX"));
+    if (!m_tmpDir->isValid() || m_segments.isEmpty()) {
+        finish(false, tr("Cannot create temporary folder in %1.").arg(destInfo.absolutePath()));
+        return;
+    }
+    const QString extension = destInfo.suffix();
+    for (int i = 0; i < m_segments.count(); ++i) {
+        m_segments[i].file = m_tmpDir->filePath(QStringLiteral("segment_%1.%2").arg(i, 4, 10, QLatin1Char('0')).arg(extension));
+    }
+    if (!m_consumerArgs.contains(QStringLiteral("an=1"))) {
+        // Render the audio in one pass, encoders add padding at the start of each file that would be audible at segment joins
+        m_audio.in = m_in;
+        m_audio.out = m_out;
+        m_audio.file = m_tmpDir->filePath(QStringLiteral("audio.%1").arg(extension));
+        m_audio.progress = 0;
+        m_audio.frame = 0;
+        m_audio.finished = false;
+        createProcess(m_audio, QStringLiteral("vn=1"));
+    }
+    startNextSegments();
+}
+
+void SegmentedRenderJob::startNextSegments()
+{
+    int running = 0;
+    for (const Segment &segment : m_segments) {
+        if (segment.process && !segment.finished) {
+            running++;
+        }
+    }
+    for (Segment &segment : m_segments) {
+        if (running >= m_parallel) {
+            break;
+        }
+        if (!segment.process) {
+            createProcess(segment, QStringLiteral("an=1"));
+            running++;
+        }
+    }
+}
+
+void SegmentedRenderJob::updateProgress()
+{
+    // The video segments give the progress, the audio pass is much faster. Keep 5% for joining.
+    qint64 done = 0;
+    int frames = 0;
+    for (const Segment &s : m_segments) {
+        done += (qint64)(s.finished ? 100 : s.progress) * (s.out - s.in + 1);
+        frames += s.finished ? s.out - s.in + 1 : s.frame;
+    }
+    updateStats(frames);
+    int progress = (int)(done * 95 / (100 * (qint64)(m_out - m_in + 1)));
+    if (progress <= m_progress) {
+        return;
+    }
+    m_progress = progress;
+    if (m_kdenliveinterface && m_kdenliveinterface->isValid()) {
+        m_dbusargs[1] = m_progress;
+        callKdenlive(QStringLiteral("setRenderingProgress"), m_dbusargs);
+    }
+}
+
+void SegmentedRenderJob::slotProcessFinished(int exitCode, QProcess::ExitStatus status)
+{
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    Segment *segment = nullptr;
+    if (m_audio.process == process) {
+        segment = &m_audio;
+    } else {
+        for (Segment &s : m_segments) {
+            if (s.process == process) {
+                segment = &s;
+                break;
+            }
+        }
+    }
+    if (!segment || segment->finished) {
+        return;
+    }
+    segment->finished = true;
+    if (status == QProcess::CrashExit || exitCode != 0) {
+        m_logstream << "Render process failed for frames " << segment->in << '-' << segment->out << endl;
+        finish(false, m_errorMessage);
+        return;
+    }
+    updateProgress();
+    startNextSegments();
+    if (m_audio.process && !m_audio.finished) {
+        return;
+    }
+    for (const Segment &s : m_segments) {
+        if (!s.finished) {
+            return;
+        }
+    }
+    joinSegments();
+}
+
+void SegmentedRenderJob::joinSegments()
+{
+    QFile list(m_tmpDir->filePath(QStringLiteral("segments.txt")));
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        finish(false, tr("Cannot write to %1.").arg(list.fileName()));
+        return;
+    }
+    QTextStream stream(&list);
+    for (const Segment &segment : m_segments) {
+        QString path = segment.file;
+        stream << "file '" << path.replace(QLatin1Char('\''), QStringLiteral("'\\''")) << "'\n";
+    }
+    stream.flush();
+    list.close();
+
+    QStringList args;
+    args << QStringLiteral("-y") << QStringLiteral("-v") << QStringLiteral("error") << QStringLiteral("-f") << QStringLiteral("concat") << QStringLiteral("-safe") << QStringLiteral("0") << QStringLiteral("-i") << list.fileName();
+    if (m_audio.process) {
+        args << QStringLiteral("-i") << m_audio.file << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map") << QStringLiteral("1:a");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    m_joinProcess = new QProcess(this);
+    m_joinProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_joinProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &SegmentedRenderJob::slotJoinFinished);
+    m_joinProcess->start(m_ffmpeg, args);
+    m_logstream << "Joining segments: " << m_ffmpeg << ' ' << args.join(QLatin1Char(' ')) << endl;
+}
+
+void SegmentedRenderJob::slotJoinFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (status == QProcess::CrashExit || exitCode != 0 || m_joinProcess->error() != QProcess::UnknownError) {
+        finish(false, tr("Joining the rendered segments failed.") + QStringLiteral("<br>") + QString::fromLocal8Bit(m_joinProcess->readAll()));
+        return;
+    }
+    finish(true);
+}
+
+void SegmentedRenderJob::killProcesses()
+{
+    QList<QProcess *> processes;
+    for (const Segment &segment : m_segments) {
+        processes << segment.process;
+    }
+    processes << m_audio.process << m_joinProcess;
+    for (QProcess *process : processes) {
+        if (process && process->state() != QProcess::NotRunning) {
+            process->disconnect(this);
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+}
+
+void SegmentedRenderJob::killRender()
+{
+    killProcesses();
+}
+
+void SegmentedRenderJob::finish(bool success, const QString &error)
+{
+    killProcesses();
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    if (!success) {
+        m_logstream << error << endl;
+        renderFailed(error);
+        return;
+    }
+    renderSucceeded();
+}
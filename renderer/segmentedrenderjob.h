@@ -0,0 +1,93 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEGMENTEDRENDERJOB_H
+#define SEGMENTEDRENDERJOB_H
+
+#include "renderjob.h"
+
+class QTemporaryDir;
+
+/**
+ * @class SegmentedRenderJob
+ * @brief Renders the video in segments processed in parallel, then joins them without re-encoding.
+ *
+ * Each segment is rendered by its own melt process without audio, while the audio is
+ * rendered in one continuous pass to avoid seams. The parts are finally joined with
+ * the ffmpeg concat demuxer using stream copy. Progress, stats and the end of the render
+ * are reported to Kdenlive like a normal RenderJob.
+ */
+class SegmentedRenderJob : public RenderJob
+{
+    Q_OBJECT
+
+public:
+    SegmentedRenderJob(bool erase, int pid, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &player, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, int in, int out);
+    ~SegmentedRenderJob();
+    /** @brief Set the frames where a new segment starts, the number of segments rendered at the same time and the ffmpeg executable */
+    void setSegments(const QList<int> &boundaries, int parallel, const QString &ffmpeg);
+    /** @brief Returns true if files rendered with these parameters can be joined without re-encoding */
+    static bool canJoinSegments(const QString &rendermodule, const QString &dest, const QStringList &args);
+
+public slots:
+    void start() Q_DECL_OVERRIDE;
+
+private slots:
+    void slotProcessFinished(int exitCode, QProcess::ExitStatus status);
+    void slotJoinFinished(int exitCode, QProcess::ExitStatus status);
+
+protected:
+    void killRender() Q_DECL_OVERRIDE;
+
+private:
+    struct Segment {
+        int in;
+        int out;
+        QString file;
+        QProcess *process;
+        int progress;
+        /** @brief Last frame reported by melt, counted from the segment in point */
+        int frame;
+        bool finished;
+    };
+    QString m_profile;
+    QString m_ffmpeg;
+    QStringList m_preargs;
+    /** @brief Consumer arguments passed to each melt process */
+    QStringList m_consumerArgs;
+    int m_in;
+    int m_out;
+    int m_parallel;
+    /** @brief Video segments */
+    QList<Segment> m_segments;
+    /** @brief The continuous audio pass, its process is null if the render has no audio */
+    Segment m_audio;
+    QProcess *m_joinProcess;
+    QTemporaryDir *m_tmpDir;
+    QProcess *createProcess(Segment &segment, const QString &extraArg);
+    void startNextSegments();
+    void updateProgress();
+    void joinSegments();
+    void finish(bool success, const QString &error = QString());
+    void killProcesses();
+};
+
+#endif
@@ -43,6 +43,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "mltcontroller/clipcontroller.h"
 #include "mltcontroller/clippropertiescontroller.h"
 #include "project/projectcommands.h"
+#include "project/cacheledger.h"
+#include "project/sharedcache.h"
 #include "project/invaliddialog.h"
 #include "projectsortproxymodel.h"
 #include "bincommands.h"
@@ -700,6 +702,7 @@ Bin::~Bin()
     m_proxyModel->selectionModel()->blockSignals(true);
     setEnabled(false);
     abortOperations();
+    removeProxySegments();
     delete m_infoMessage;
     delete m_propertiesPanel;
 }
@@ -976,6 +979,16 @@ void Bin::deleteClip(const QString &id)
         return;
     }
     m_jobManager->discardJobs(id);
+    removeProxySegments(id);
+    if (SharedCache::isEnabled()) {
+        // The shared proxy and thumbnail of the clip can be evicted
+        QStringList files;
+        files << clip->getProducerProperty(QStringLiteral("kdenlive:proxy"));
+        if (!clip->hash().isEmpty()) {
+            files << SharedCache::instance()->thumbnailPath(clip->hash());
+        }
+        SharedCache::instance()->removeReferences(files, getDocumentProperty(QStringLiteral("documentid")));
+    }
     ClipType type = clip->clipType();
     QString url = clip->url();
     clip->setClipStatus(AbstractProjectItem::StatusDeleting);
@@ -1258,6 +1271,7 @@ void Bin::setDocument(KdenliveDoc *project)
     delete m_itemView;
     m_itemView = nullptr;
     delete m_jobManager;
+    removeProxySegments();
     m_clipCounter = 1;
     m_folderCounter = 1;
     m_doc = project;
@@ -2103,9 +2117,56 @@ void Bin::slotThumbnailReady(const QString &id, const QImage &img, bool fromFile
     if (clip) {
         clip->setThumbnail(img);
         // Save thumbnail for later reuse
-        bool ok = false;
         if (!fromFile) {
-            img.save(m_doc->getCacheDir(CacheThumbs, &ok).absoluteFilePath(clip->hash() + QStringLiteral(".png")));
+            if (clip->hash().isEmpty()) {
+                // The file is still being hashed
+                m_thumbnailsWaitingHash.insert(id, img);
+            } else {
+                saveThumbnail(clip, img);
+            }
+        }
+    }
+}
+
+void Bin::saveThumbnail(ProjectClip *clip, const QImage &img)
+{
+    bool ok = false;
+    const QString thumbName = clip->hash() + QStringLiteral(".png");
+    QDir thumbFolder = m_doc->getCacheDir(CacheThumbs, &ok);
+    if (ok && img.save(thumbFolder.absoluteFilePath(thumbName))) {
+        CacheLedger::instance()->addFile(thumbFolder, thumbName);
+    }
+    if (SharedCache::isEnabled()) {
+        img.save(SharedCache::instance()->thumbnailPath(clip->hash()));
+    }
+}
+
+void Bin::delayProxy(const QString &id, bool force, const QString &commandText)
+{
+    m_proxiesWaitingHash.insert(id, qMakePair(force, commandText));
+}
+
+void Bin::fileHashReady(const QString &id)
+{
+    const QImage img = m_thumbnailsWaitingHash.take(id);
+    const bool proxy = m_proxiesWaitingHash.contains(id);
+    const QPair<bool, QString> proxyRequest = m_proxiesWaitingHash.take(id);
+    ProjectClip *clip = m_rootFolder ? m_rootFolder->clip(id) : nullptr;
+    if (!clip || clip->hash().isEmpty()) {
+        return;
+    }
+    if (!img.isNull()) {
+        saveThumbnail(clip, img);
+    }
+    if (proxy) {
+        // The request command was already pushed, add the proxy in a new one with the same text
+        QUndoCommand *command = new QUndoCommand();
+        command->setText(proxyRequest.second.isEmpty() ? i18n("Add proxy clip") : proxyRequest.second);
+        m_doc->slotProxyCurrentItem(true, QList<ProjectClip *>() << clip, proxyRequest.first, command);
+        if (command->childCount() > 0) {
+            m_doc->commandStack()->push(command);
+        } else {
+            delete command;
         }
     }
 }
@@ -2159,7 +2220,12 @@ void Bin::slotProducerReady(const requestClipInfo &info, ClipController *control
 {
     ProjectClip *clip = m_rootFolder->clip(info.clipId);
     if (clip) {
-        if (clip->setProducer(controller, info.replaceProducer) && !clip->hasProxy()) {
+        bool ready = clip->setProducer(controller, info.replaceProducer);
+        if (m_proxySegments.contains(info.clipId) && !m_proxySegments.value(info.clipId).contains(clip->getProducerProperty(QStringLiteral("resource")))) {
+            // The temporary proxy was replaced
+            removeProxySegments(info.clipId);
+        }
+        if (ready && !clip->hasProxy()) {
             emit producerReady(info.clipId);
             // Check for file modifications
             ClipType t = clip->clipType();
@@ -2466,6 +2532,25 @@ void Bin::gotProxy(const QString &id, const QString &path)
     }
 }
 
+void Bin::releaseProxySegments(const QString &id, const QStringList &files)
+{
+    m_proxySegments[id] << files;
+    ProjectClip *clip = m_rootFolder ? m_rootFolder->clip(id) : nullptr;
+    if (!clip || !files.contains(clip->getProducerProperty(QStringLiteral("resource")))) {
+        removeProxySegments(id);
+    }
+}
+
+void Bin::removeProxySegments(const QString &id)
+{
+    const QStringList ids = id.isEmpty() ? m_proxySegments.keys() : QStringList(id);
+    for (const QString &clipId : ids) {
+        for (const QString &file : m_proxySegments.take(clipId)) {
+            QFile::remove(file);
+        }
+    }
+}
+
 void Bin::reloadProducer(const QString &id, const QDomElement &xml)
 {
     m_doc->getFileProperties(xml, id, 150, true);
@@ -3857,7 +3942,11 @@ QStringList Bin::getProxyHashList()
     QList<ProjectClip *> clipList = m_rootFolder->childClips();
     foreach (ProjectClip *clp, clipList) {
         if (clp->clipType() == AV || clp->clipType() == Video || clp->clipType() == Playlist) {
-            list << clp->hash();
+            // Clips that are still being hashed have no proxy yet
+            const QString clipHash = clp->hash();
+            if (!clipHash.isEmpty()) {
+                list << clipHash;
+            }
         }
     }
     return list;
@@ -240,6 +240,8 @@ public:
 
     /** @brief A proxy clip was just created, pass it to the responsible item  */
     void gotProxy(const QString &id, const QString &path);
+    /** @brief Delete the proxy segment @param files of a clip once its producer does not use them anymore  */
+    void releaseProxySegments(const QString &id, const QStringList &files);
 
     /** @brief Get the document's renderer frame size  */
     const QSize getRenderSize();
@@ -341,6 +343,11 @@ public:
     void rebuildProxies();
     /** @brief Return a list of all clips hashes used in this project */
     QStringList getProxyHashList();
+    /** @brief Create the proxy of a clip once its hash is known, the proxy is named after it.
+     *  @param commandText the text of the undo command the proxy was requested in */
+    void delayProxy(const QString &id, bool force, const QString &commandText = QString());
+    /** @brief The hash of a clip was computed, run the operations waiting for it */
+    void fileHashReady(const QString &id);
     /** @brief Get info (id, name) of a folder (or the currently selected one)  */
     const QStringList getFolderInfo(const QModelIndex &selectedIx = QModelIndex());
     /** @brief Save a clip zone as MLT playlist */
@@ -535,6 +542,16 @@ private:
     bool m_gainedFocus;
     /** @brief List of Clip Ids that want an audio thumb. */
     QStringList m_audioThumbsList;
+    /** @brief Thumbnails to save once the clip hash is known, by clip id */
+    QHash<QString, QImage> m_thumbnailsWaitingHash;
+    /** @brief Clips to proxy once their hash is known, with the force flag and the undo command text */
+    QHash<QString, QPair<bool, QString> > m_proxiesWaitingHash;
+    /** @brief Segment files of finished proxy jobs still used by the temporary proxy, by clip id */
+    QHash<QString, QStringList> m_proxySegments;
+    /** @brief Delete the proxy segments kept for a clip, or for all clips when @param id is empty */
+    void removeProxySegments(const QString &id = QString());
+    /** @brief Save a clip thumbnail in the project and shared caches */
+    void saveThumbnail(ProjectClip *clip, const QImage &img);
     QString m_processingAudioThumb;
     QMutex m_audioThumbMutex;
     /** @brief Total number of milliseconds to process for audio thumbnails */
@@ -33,6 +33,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "lib/audio/audioStreamInfo.h"
 #include "utils/KoIconUtils.h"
 #include "mltcontroller/clippropertiescontroller.h"
+#include "project/cacheledger.h"
+#include "project/filehasher.h"
 
 #include <QDomElement>
 #include <QFile>
@@ -46,6 +48,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, ClipController *controller, ProjectFolder *parent) :
     AbstractProjectItem(AbstractProjectItem::ClipItem, id, parent)
     , m_abortAudioThumb(false)
+    , m_audioThumbsPending(false)
     , m_controller(controller)
     , m_thumbsProducer(nullptr)
 {
@@ -60,8 +63,9 @@ ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, ClipController *
     } else {
         m_thumbnail = thumb;
     }
+    connect(&m_hashWatcher, &QFutureWatcherBase::finished, this, &ProjectClip::slotFileHashReady);
     // Make sure we have a hash for this clip
-    hash();
+    requestFileHash();
     setParent(parent);
     connect(this, &ProjectClip::updateJobStatus, this, &ProjectClip::setJobStatus);
     bin()->loadSubClips(id, m_controller->getPropertiesFromPrefix(QStringLiteral("kdenlive:clipzone.")));
@@ -72,6 +76,7 @@ ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, ClipController *
 ProjectClip::ProjectClip(const QDomElement &description, const QIcon &thumb, ProjectFolder *parent) :
     AbstractProjectItem(AbstractProjectItem::ClipItem, description, parent)
     , m_abortAudioThumb(false)
+    , m_audioThumbsPending(false)
     , m_controller(nullptr)
     , m_type(Unknown)
     , m_thumbsProducer(nullptr)
@@ -95,6 +100,7 @@ ProjectClip::ProjectClip(const QDomElement &description, const QIcon &thumb, Pro
         m_name = i18n("Untitled");
     }
     connect(this, &ProjectClip::updateJobStatus, this, &ProjectClip::setJobStatus);
+    connect(&m_hashWatcher, &QFutureWatcherBase::finished, this, &ProjectClip::slotFileHashReady);
     setParent(parent);
     connect(this, &ProjectClip::updateThumbProgress, bin(), &Bin::doUpdateThumbsProgress);
 }
@@ -378,7 +384,7 @@ bool ProjectClip::setProducer(ClipController *controller, bool replaceProducer)
     }
     bin()->emitItemUpdated(this);
     // Make sure we have a hash for this clip
-    getFileHash();
+    requestFileHash();
     createAudioThumbs();
     return isNewProducer;
 }
@@ -386,6 +392,11 @@ bool ProjectClip::setProducer(ClipController *controller, bool replaceProducer)
 void ProjectClip::createAudioThumbs()
 {
     if (KdenliveSettings::audiothumbnails() && (m_type == AV || m_type == Audio || m_type == Playlist)) {
+        if (isHashPending()) {
+            // The audio thumbnail is named after the hash
+            m_audioThumbsPending = true;
+            return;
+        }
         bin()->requestAudioThumbs(m_id, duration().ms());
         emit updateJobStatus(AbstractClipJob::THUMBJOB, JobWaiting, 0);
     }
@@ -541,6 +552,7 @@ const QString ProjectClip::hash()
             return clipHash;
         }
     }
+    // File hashes are computed in a worker thread, see requestFileHash
     return getFileHash();
 }
 
@@ -566,27 +578,7 @@ const QString ProjectClip::getFileHash() const
         fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
     default:
-        QFile file(m_controller ? m_controller->clipUrl() : m_temporaryUrl);
-        if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
-            /*
-             * 1 MB = 1 second per 450 files (or faster)
-             * 10 MB = 9 seconds per 450 files (or faster)
-             */
-            if (file.size() > 2000000) {
-                fileData = file.read(1000000);
-                if (file.seek(file.size() - 1000000)) {
-                    fileData.append(file.readAll());
-                }
-            } else {
-                fileData = file.readAll();
-            }
-            file.close();
-            if (m_controller) {
-                m_controller->setProperty(QStringLiteral("kdenlive:file_size"), QString::number(file.size()));
-            }
-            fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-        }
-        break;
+        return QString();
     }
     if (fileHash.isEmpty()) {
         return QString();
@@ -598,6 +590,51 @@ const QString ProjectClip::getFileHash() const
     return result;
 }
 
+void ProjectClip::requestFileHash()
+{
+    if (!m_controller || !m_controller->property(QStringLiteral("kdenlive:file_hash")).isEmpty()) {
+        return;
+    }
+    if (m_type == SlideShow || m_type == Text || m_type == QText || m_type == Color) {
+        getFileHash();
+        return;
+    }
+    // Read the file in a worker thread, unless it was already hashed
+    const QString path = m_controller->clipUrl();
+    const QString cached = FileHasher::instance()->cachedHash(path);
+    if (!cached.isEmpty()) {
+        m_controller->setProperty(QStringLiteral("kdenlive:file_size"), QString::number(QFileInfo(path).size()));
+        m_controller->setProperty(QStringLiteral("kdenlive:file_hash"), cached);
+        return;
+    }
+    if (!m_hashWatcher.isRunning()) {
+        m_hashWatcher.setFuture(FileHasher::instance()->hashAsync(path));
+    }
+}
+
+bool ProjectClip::isHashPending() const
+{
+    return m_hashWatcher.isRunning();
+}
+
+void ProjectClip::slotFileHashReady()
+{
+    if (!m_controller) {
+        return;
+    }
+    const QString result = m_hashWatcher.result();
+    if (!result.isEmpty() && m_controller->property(QStringLiteral("kdenlive:file_hash")).isEmpty()) {
+        m_controller->setProperty(QStringLiteral("kdenlive:file_size"), QString::number(QFileInfo(m_controller->clipUrl()).size()));
+        m_controller->setProperty(QStringLiteral("kdenlive:file_hash"), result);
+    }
+    // Run the operations that were waiting for the hash
+    if (m_audioThumbsPending) {
+        m_audioThumbsPending = false;
+        createAudioThumbs();
+    }
+    bin()->fileHashReady(m_id);
+}
+
 double ProjectClip::getOriginalFps() const
 {
     if (!m_controller) {
@@ -954,6 +991,7 @@ void ProjectClip::doExtractImage()
         m_thumbMutex.unlock();
         if (ok && thumbFolder.exists(hash() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".png"))) {
             emit thumbReady(pos, QImage(thumbFolder.absoluteFilePath(hash() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".png"))));
+            CacheLedger::instance()->addFile(thumbFolder, hash() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".png"));
             continue;
         }
         if (pos >= max) {
@@ -995,6 +1033,8 @@ void ProjectClip::discardAudioThumb()
     QString audioThumbPath = getAudioThumbPath(m_controller->audioInfo());
     if (!audioThumbPath.isEmpty()) {
         QFile::remove(audioThumbPath);
+        bool ok = false;
+        CacheLedger::instance()->removeFile(bin()->getCacheDir(CacheAudio, &ok), audioThumbPath);
     }
     audioFrameCache.clear();
     qCDebug(KDENLIVE_LOG) << "////////////////////  DISCARD AUIIO THUMBNS";
@@ -1062,6 +1102,8 @@ void ProjectClip::slotCreateAudioThumbs()
         }
     }
     if (!audioLevels.isEmpty()) {
+        bool ok = false;
+        CacheLedger::instance()->addFile(bin()->getCacheDir(CacheAudio, &ok), audioPath);
         emit updateJobStatus(AbstractClipJob::THUMBJOB, JobDone, 0);
         updateAudioThumbnail(audioLevels);
         return;
@@ -1289,7 +1331,11 @@ void ProjectClip::slotCreateAudioThumbs()
             }
             image.setPixel(i / channels, i % channels, p);
         }
-        image.save(audioPath);
+        bool ok = false;
+        QDir thumbFolder = bin()->getCacheDir(CacheAudio, &ok);
+        if (image.save(audioPath) && ok) {
+            CacheLedger::instance()->addFile(thumbFolder, audioPath);
+        }
     }
     m_abortAudioThumb = false;
 }
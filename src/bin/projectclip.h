@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QUrl>
 #include <QMutex>
 #include <QFuture>
+#include <QFutureWatcher>
 
 class ProjectFolder;
 class AudioStreamInfo;
@@ -147,8 +148,11 @@ public:
 
     QString getToolTip() const Q_DECL_OVERRIDE;
 
-    /** @brief The clip hash created from the clip's resource. */
+    /** @brief The clip hash created from the clip's resource, empty while the file is hashed in a worker thread.
+     *  Operations that need it can wait for Bin::fileHashReady. */
     const QString hash();
+    /** @brief Returns true while the clip file is hashed in a worker thread. */
+    bool isHashPending() const;
 
     /** @brief Set a property on the MLT producer. */
     void setProducerProperty(const QString &name, int data);
@@ -230,10 +234,15 @@ public slots:
 
 private:
     bool m_abortAudioThumb;
+    /** @brief True if the audio thumbnails were requested before the clip hash was known */
+    bool m_audioThumbsPending;
     /** @brief The Clip controller for this clip. */
     ClipController *m_controller;
-    /** @brief Generate and store file hash if not available. */
+    /** @brief Generate and store the hash of slideshow, title and color clips, which is based on their description. */
     const QString getFileHash() const;
+    /** @brief Store the file hash if not available, reading the file in a worker thread if needed. */
+    void requestFileHash();
+    QFutureWatcher<QString> m_hashWatcher;
     /** @brief Store clip url temporarily while the clip controller has not been created. */
     QString m_temporaryUrl;
     ClipType m_type;
@@ -251,6 +260,7 @@ private:
 
 private slots:
     void updateFfmpegProgress();
+    void slotFileHashReady();
 
 signals:
     void gotAudioData();
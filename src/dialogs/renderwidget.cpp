@@ -33,6 +33,7 @@
 #include <KNotification>
 #include <KMimeTypeTrader>
 #include <KIO/DesktopExecParser>
+#include <KIO/Global>
 #include <knotifications_version.h>
 #include <kio_version.h>
 
@@ -51,6 +52,7 @@
 #include <QStandardPaths>
 #include <QMimeDatabase>
 #include <QDir>
+#include <QJsonObject>
 
 #include <locale>
 #ifdef Q_OS_MAC
@@ -78,9 +80,12 @@ const int ParametersRole = Qt::UserRole + 1;
 const int TimeRole = Qt::UserRole + 2;
 const int ProgressRole = Qt::UserRole + 3;
 const int ExtraInfoRole = Qt::UserRole + 5;
+const int StatsRole = Qt::UserRole + 6;
 
 const int DirectRenderType = QTreeWidgetItem::Type;
 const int ScriptRenderType = QTreeWidgetItem::UserType;
+// Additional file encoded by a direct render job, ParametersRole holds the job's destination
+const int OutputRenderType = QTreeWidgetItem::UserType + 1;
 
 // Running job status
 enum JOBSTATUS {
@@ -218,6 +223,14 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     m_view.error_box->setVisible(false);
     m_view.tc_type->setEnabled(false);
     m_view.checkTwoPass->setEnabled(false);
+    m_view.parallel_render->setChecked(KdenliveSettings::parallelrender());
+    connect(m_view.parallel_render, &QCheckBox::toggled, this, [](bool checked) {
+        KdenliveSettings::setParallelrender(checked);
+    });
+    m_view.preview_render->setChecked(KdenliveSettings::renderusepreview());
+    connect(m_view.preview_render, &QCheckBox::toggled, this, [](bool checked) {
+        KdenliveSettings::setRenderusepreview(checked);
+    });
     m_view.proxy_render->setHidden(!enableProxy);
     connect(m_view.proxy_render, &QCheckBox::toggled, this, &RenderWidget::slotProxyWarn);
     KColorScheme scheme(palette().currentColorGroup(), KColorScheme::Window, KSharedConfig::openConfig(KdenliveSettings::colortheme()));
@@ -235,6 +248,9 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     m_view.encoder_threads->setMaximum(QThread::idealThreadCount());
     m_view.encoder_threads->setValue(KdenliveSettings::encodethreads());
     connect(m_view.encoder_threads, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateEncodeThreads(int)));
+    m_view.render_budget->setMaximum(QThread::idealThreadCount() * 2);
+    m_view.render_budget->setValue(KdenliveSettings::renderthreadbudget());
+    connect(m_view.render_budget, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRenderBudget(int)));
 
     m_view.rescale_keep->setChecked(KdenliveSettings::rescalekeepratio());
     connect(m_view.rescale_width, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRescaleWidth(int)));
@@ -1167,14 +1183,77 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
                 zoneOut /= ratio;
             }
         }
+        int renderIn = zoneIn;
+        int renderOut = zoneOut;
         if (m_view.render_guide->isChecked()) {
             double fps = profile->fps();
             double guideStart = m_view.guide_start->itemData(m_view.guide_start->currentIndex()).toDouble();
             double guideEnd = m_view.guide_end->itemData(m_view.guide_end->currentIndex()).toDouble();
-            render_process_args << "in=" + QString::number((int) GenTime(guideStart).frames(fps)) << "out=" + QString::number((int) GenTime(guideEnd).frames(fps));
-        } else {
-            render_process_args << "in=" + QString::number(zoneIn) << "out=" + QString::number(zoneOut);
+            renderIn = (int) GenTime(guideStart).frames(fps);
+            renderOut = (int) GenTime(guideEnd).frames(fps);
+        }
+
+        // Encode the ticked profiles from the same render, so that the timeline is only processed once
+        QStringList outputDests;
+        if (!stemExport && !m_view.checkTwoPass->isChecked()) {
+            const QList<QTreeWidgetItem *> outputs = checkedProfiles();
+            QStringList usedNames;
+            usedNames << dest;
+            QStringList existingFiles;
+            QFileInfo destInfo(dest);
+            for (QTreeWidgetItem *output : outputs) {
+                const QString outputExtension = output->data(0, ExtensionRole).toString();
+                QString outputDest = destInfo.absolutePath() + QLatin1Char('/') + destInfo.completeBaseName() + QLatin1Char('.') + outputExtension;
+                int ix = 1;
+                while (usedNames.contains(outputDest)) {
+                    outputDest = destInfo.absolutePath() + QLatin1Char('/') + destInfo.completeBaseName() + QStringLiteral("_%1.").arg(ix++) + outputExtension;
+                }
+                QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(outputDest, Qt::MatchExactly, 1);
+                if (!existing.isEmpty()) {
+                    int status = static_cast<RenderJobItem *>(existing.at(0))->status();
+                    if (status == RUNNINGJOB || status == WAITINGJOB || status == STARTINGJOB) {
+                        KMessageBox::information(this, i18n("There is already a job writing file:<br /><b>%1</b><br />Abort the job if you want to overwrite it...", outputDest), i18n("Already running"));
+                        return;
+                    }
+                }
+                if (QFile::exists(outputDest)) {
+                    existingFiles << outputDest;
+                }
+                usedNames << outputDest;
+                outputDests << outputDest;
+                const QStringList outputArgs = QStringList() << outputDest << outputArguments(output, exportAudio);
+                render_process_args << QStringLiteral("-output:") + QString::fromUtf8(QUrl::toPercentEncoding(outputArgs.join(QLatin1Char('\n'))));
+            }
+            if (!existingFiles.isEmpty() && KMessageBox::warningContinueCancelList(this, i18n("These output files already exist. Do you want to overwrite them?"), existingFiles) != KMessageBox::Continue) {
+                foreach (const QString &playlistFilePath, playlistPaths) {
+                    QFile playlistFile(playlistFilePath);
+                    if (playlistFile.exists()) {
+                        playlistFile.remove();
+                    }
+                }
+                return;
+            }
+        }
+
+        // Split the render in segments encoded in parallel, not possible for audio stems, 2 pass, frame rate changes or multiple outputs
+        if (m_view.parallel_render->isChecked() && m_view.parallel_render->isEnabled() && !stemExport && !resizeProfile && !m_view.checkTwoPass->isChecked() && outputDests.isEmpty()) {
+            int threads = KdenliveSettings::encodethreads();
+            if (renderArgs.contains(QStringLiteral("threads="))) {
+                threads = renderArgs.section(QStringLiteral("threads="), 1, 1).section(QLatin1Char(' '), 0, 0).toInt();
+            }
+            const QList<int> boundaries = segmentBoundaries(renderIn, renderOut, profile->fps(), threads);
+            if (!boundaries.isEmpty()) {
+                QStringList positions;
+                for (int pos : boundaries) {
+                    positions << QString::number(pos);
+                }
+                const int budget = KdenliveSettings::renderthreadbudget() > 0 ? KdenliveSettings::renderthreadbudget() : QThread::idealThreadCount();
+                render_process_args << QStringLiteral("-segments:%1").arg(positions.join(QLatin1Char(',')));
+                render_process_args << QStringLiteral("-parallel:%1").arg(qMax(2, budget / qMax(1, threads)));
+                render_process_args << QStringLiteral("-ffmpeg:%1").arg(KdenliveSettings::ffmpegpath());
+            }
         }
+        render_process_args << "in=" + QString::number(renderIn) << "out=" + QString::number(renderOut);
 
         if (!overlayargs.isEmpty()) {
             render_process_args << "preargs=" + overlayargs.join(QLatin1Char(' '));
@@ -1421,10 +1500,22 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
         renderItem->setData(1, ParametersRole, render_process_args);
         if (exportAudio == false) {
             renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
+        } else if (!outputDests.isEmpty()) {
+            renderItem->setData(1, ExtraInfoRole, i18np("Also rendering %1 other file", "Also rendering %1 other files", outputDests.count()));
         } else {
             renderItem->setData(1, ExtraInfoRole, QString());
         }
 
+        // The additional outputs are only listed to follow their progress, they are rendered by the job above
+        for (const QString &outputDest : outputDests) {
+            QList<QTreeWidgetItem *> existingOutput = m_view.running_jobs->findItems(outputDest, Qt::MatchExactly, 1);
+            qDeleteAll(existingOutput);
+            RenderJobItem *outputItem = new RenderJobItem(m_view.running_jobs, QStringList() << QString() << outputDest, OutputRenderType);
+            outputItem->setData(1, TimeRole, QDateTime::currentDateTime());
+            outputItem->setData(1, ParametersRole, dest);
+            outputItem->setData(1, ExtraInfoRole, i18n("Rendered with %1", QFileInfo(dest).fileName()));
+        }
+
         m_view.running_jobs->setCurrentItem(renderItem);
         m_view.tabWidget->setCurrentIndex(1);
         // check render status
@@ -1439,34 +1530,170 @@ void RenderWidget::checkRenderStatus()
         return;
     }
 
+    const int budget = KdenliveSettings::renderthreadbudget() > 0 ? KdenliveSettings::renderthreadbudget() : QThread::idealThreadCount();
     RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
 
-    // Make sure no other rendering is running
+    // Count the threads used by the running jobs
+    int usedThreads = 0;
+    bool runningJob = false;
     while (item) {
-        if (item->status() == RUNNINGJOB) {
-            return;
+        // Additional outputs are rendered by another job
+        if (item->type() != OutputRenderType && (item->status() == RUNNINGJOB || item->status() == STARTINGJOB)) {
+            usedThreads += jobThreads(item);
+            runningJob = true;
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
     item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
     bool waitingJob = false;
 
-    // Find first waiting job
+    // Start waiting jobs in queue order while they fit in the budget
     while (item) {
-        if (item->status() == WAITINGJOB) {
-            item->setData(1, TimeRole, QDateTime::currentDateTime());
+        if (item->status() == WAITINGJOB && item->type() != OutputRenderType) {
             waitingJob = true;
+            int threads = jobThreads(item);
+            if (runningJob && usedThreads + threads > budget) {
+                // Don't let the next jobs overtake this one
+                break;
+            }
+            item->setData(1, TimeRole, QDateTime::currentDateTime());
             startRendering(item);
-            item->setStatus(STARTINGJOB);
-            break;
+            if (item->status() == WAITINGJOB) {
+                item->setStatus(STARTINGJOB);
+                usedThreads += threads;
+                runningJob = true;
+            }
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    if (waitingJob == false && m_view.shutdown->isChecked()) {
+    if (!waitingJob && !runningJob && m_view.shutdown->isChecked()) {
         emit shutdown();
     }
 }
 
+QList<int> RenderWidget::segmentBoundaries(int in, int out, double fps, int threads) const
+{
+    QList<int> boundaries;
+    const int budget = KdenliveSettings::renderthreadbudget() > 0 ? KdenliveSettings::renderthreadbudget() : QThread::idealThreadCount();
+    // threads=0 lets the encoder use all cores, nothing to gain from parallel segments
+    const int processes = threads > 0 ? budget / threads : 1;
+    // Don't create segments shorter than 10 seconds, startup and joining would cost more than we gain
+    const int minLength = qMax(1, (int)(10 * fps));
+    const int segments = qMin(processes, (out - in + 1) / minLength);
+    if (segments < 2) {
+        return boundaries;
+    }
+    // Prefer cutting at guides, where scene changes usually happen
+    int previous = in;
+    for (int i = 0; i < m_view.guide_start->count(); ++i) {
+        int pos = (int) GenTime(m_view.guide_start->itemData(i).toDouble()).frames(fps);
+        if (pos - previous >= minLength && out + 1 - pos >= minLength) {
+            boundaries << pos;
+            previous = pos;
+        }
+    }
+    if (boundaries.count() + 1 < segments) {
+        // Not enough guides to keep all processes busy, use segments of equal duration
+        boundaries.clear();
+        for (int i = 1; i < segments; ++i) {
+            boundaries << in + (int)((qint64)(out - in + 1) * i / segments);
+        }
+    }
+    return boundaries;
+}
+
+int RenderWidget::jobThreads(RenderJobItem *item) const
+{
+    QStringList params;
+    if (item->type() == DirectRenderType) {
+        params = item->data(1, ParametersRole).toStringList();
+    } else if (item->type() == ScriptRenderType) {
+        QFile file(item->data(1, ParametersRole).toString());
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            params = QString::fromUtf8(file.readAll()).split(QRegExp(QStringLiteral("[\\s\"]")), QString::SkipEmptyParts);
+        }
+    }
+    int threads = 0;
+    int processes = 1;
+    bool found = false;
+    for (const QString &param : params) {
+        if (param.startsWith(QLatin1String("-output:"))) {
+            // One more encoder working at the same time
+            processes++;
+        } else if (param.startsWith(QLatin1String("threads="))) {
+            // A script may render several stems, keep the largest value
+            threads = qMax(threads, param.section(QLatin1Char('='), 1).toInt());
+            found = true;
+        } else if (param.startsWith(QLatin1String("-parallel:"))) {
+            // Segments rendered in parallel
+            processes = qMax(processes, param.section(QLatin1Char(':'), 1).toInt());
+        }
+    }
+    if (!found) {
+        return processes;
+    }
+    // threads=0 lets the encoder use all cores
+    return threads > 0 ? threads * processes : QThread::idealThreadCount();
+}
+
+QList<QTreeWidgetItem *> RenderWidget::checkedProfiles() const
+{
+    QList<QTreeWidgetItem *> profiles;
+    for (int i = 0; i < m_view.formats->topLevelItemCount(); ++i) {
+        QTreeWidgetItem *group = m_view.formats->topLevelItem(i);
+        for (int j = 0; j < group->childCount(); ++j) {
+            QTreeWidgetItem *item = group->child(j);
+            if (item == m_view.formats->currentItem() || item->isHidden() || item->checkState(0) != Qt::Checked) {
+                continue;
+            }
+            const QString params = item->data(0, ParamsRole).toString();
+            if (!item->data(0, ErrorRole).isNull() || item->data(0, ExtensionRole).toString().isEmpty() || params.contains(QLatin1String("%dv_standard"))) {
+                // Broken profile or profile requiring user input
+                continue;
+            }
+            profiles << item;
+        }
+    }
+    return profiles;
+}
+
+QStringList RenderWidget::outputArguments(QTreeWidgetItem *item, bool exportAudio) const
+{
+    std::unique_ptr<ProfileModel> &profile = ProfileRepository::get()->getProfile(m_profile);
+    const QString videoQuality = item->data(0, DefaultBitrateRole).toString();
+    const QString audioQuality = item->data(0, DefaultAudioBitrateRole).toString();
+    QStringList args = item->data(0, ParamsRole).toString().simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    const QStringList speeds = item->data(0, SpeedsRole).toStringList();
+    if (!speeds.isEmpty()) {
+        // Same default speed as in the dialog
+        args << speeds.at((speeds.count() - 1) * 3 / 4).split(QLatin1Char(' '), QString::SkipEmptyParts);
+    }
+    for (int i = 0; i < args.count(); ++i) {
+        QString paramName = args.at(i).section(QLatin1Char('='), 0, -2);
+        QString paramValue = args.at(i).section(QLatin1Char('='), -1);
+        if (!paramValue.startsWith(QLatin1Char('%'))) {
+            continue;
+        }
+        if (paramValue.startsWith(QStringLiteral("%bitrate")) || paramValue == QStringLiteral("%quality")) {
+            paramValue = paramValue.contains("+'k'") ? videoQuality + 'k' : videoQuality;
+        } else if (paramValue.startsWith(QStringLiteral("%audiobitrate")) || paramValue == QStringLiteral("%audioquality")) {
+            paramValue = paramValue.contains("+'k'") ? audioQuality + 'k' : audioQuality;
+        } else if (paramValue == QStringLiteral("%dar")) {
+            paramValue = '@' + QString::number(profile->display_aspect_num()) + QLatin1Char('/') + QString::number(profile->display_aspect_den());
+        } else if (paramValue == QStringLiteral("%passes")) {
+            paramValue = QStringLiteral("1");
+        }
+        args[i] = paramName + QLatin1Char('=') + paramValue;
+    }
+    if (!exportAudio) {
+        args << QStringLiteral("an=1");
+    }
+    if (!item->data(0, ParamsRole).toString().contains(QStringLiteral("threads="))) {
+        args << QStringLiteral("threads=%1").arg(KdenliveSettings::encodethreads());
+    }
+    return args;
+}
+
 void RenderWidget::startRendering(RenderJobItem *item)
 {
     if (item->type() == DirectRenderType) {
@@ -1489,7 +1716,7 @@ int RenderWidget::waitingJobsCount() const
     int count = 0;
     RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
     while (item) {
-        if (item->status() == WAITINGJOB || item->status() == STARTINGJOB) {
+        if ((item->status() == WAITINGJOB || item->status() == STARTINGJOB) && item->type() != OutputRenderType) {
             count++;
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
@@ -1529,6 +1756,11 @@ void RenderWidget::refreshView()
         QTreeWidgetItem *group = m_view.formats->topLevelItem(i);
         for (int j = 0; j < group->childCount(); ++j) {
             QTreeWidgetItem *item = group->child(j);
+            // Ticked profiles are rendered as additional outputs of the same job
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            if (item->data(0, Qt::CheckStateRole).isNull()) {
+                item->setCheckState(0, Qt::Unchecked);
+            }
             QString std = item->data(0, StandardRole).toString();
             if (std.isEmpty()
                 || (std.contains(QStringLiteral("PAL"), Qt::CaseInsensitive) && profile->frame_rate_num() == 25 && profile->frame_rate_den() == 1)
@@ -2178,10 +2410,44 @@ void RenderWidget::setRenderJob(const QString &dest, int progress)
         QString est = (days > 0) ? i18np("%1 day ", "%1 days ", days) : QString();
         est.append(when.toString(QStringLiteral("hh:mm:ss")));
         QString t = i18n("Remaining time %1", est);
+        const QString stats = item->data(1, StatsRole).toString();
+        if (!stats.isEmpty()) {
+            t = i18nc("remaining time - render speed", "%1 - %2", t, stats);
+        }
         item->setData(1, Qt::UserRole, t);
     }
 }
 
+void RenderWidget::setRenderStats(const QString &dest, const QJsonObject &stats)
+{
+    QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
+    if (existing.isEmpty()) {
+        return;
+    }
+    RenderJobItem *item = static_cast<RenderJobItem *>(existing.at(0));
+    const double fps = stats.value(QStringLiteral("fps")).toDouble();
+    QString speed;
+    if (stats.contains(QStringLiteral("speed"))) {
+        speed = i18n("%1 fps (%2x real time)", fps, stats.value(QStringLiteral("speed")).toDouble());
+    } else {
+        speed = i18n("%1 fps", fps);
+    }
+    item->setData(1, StatsRole, speed);
+    QStringList details;
+    if (stats.contains(QStringLiteral("frames"))) {
+        details << i18n("Frame %1 of %2", stats.value(QStringLiteral("frame")).toInt(), stats.value(QStringLiteral("frames")).toInt());
+    } else {
+        details << i18n("Frame %1", stats.value(QStringLiteral("frame")).toInt());
+    }
+    if (stats.contains(QStringLiteral("pass"))) {
+        details << i18n("Pass %1 of 2", stats.value(QStringLiteral("pass")).toInt());
+    }
+    details << speed;
+    details << i18n("Average speed: %1 fps", stats.value(QStringLiteral("averageFps")).toDouble());
+    details << i18n("Written: %1", KIO::convertSize((KIO::filesize_t) stats.value(QStringLiteral("bytes")).toDouble()));
+    item->setToolTip(1, details.join(QLatin1Char('\n')));
+}
+
 void RenderWidget::setRenderStatus(const QString &dest, int status, const QString &error)
 {
     RenderJobItem *item;
@@ -2247,7 +2513,23 @@ void RenderWidget::slotAbortCurrentJob()
         if (current->status() == RUNNINGJOB) {
             emit abortProcess(current->text(1));
         } else {
+            // A job and its additional outputs are removed together
+            const QString jobDest = current->type() == OutputRenderType ? current->data(1, ParametersRole).toString() : current->text(1);
+            const bool waiting = current->status() == WAITINGJOB;
             delete current;
+            if (waiting) {
+                int ix = 0;
+                RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(ix));
+                while (item) {
+                    bool output = item->type() == OutputRenderType;
+                    if (item->status() == WAITINGJOB && ((output && item->data(1, ParametersRole).toString() == jobDest) || (!output && item->text(1) == jobDest))) {
+                        delete item;
+                    } else {
+                        ix++;
+                    }
+                    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(ix));
+                }
+            }
             slotCheckJob();
             checkRenderStatus();
         }
@@ -2257,7 +2539,7 @@ void RenderWidget::slotAbortCurrentJob()
 void RenderWidget::slotStartCurrentJob()
 {
     RenderJobItem *current = static_cast<RenderJobItem *>(m_view.running_jobs->currentItem());
-    if (current && current->status() == WAITINGJOB) {
+    if (current && current->status() == WAITINGJOB && current->type() != OutputRenderType) {
         startRendering(current);
     }
     m_view.start_job->setEnabled(false);
@@ -2273,7 +2555,7 @@ void RenderWidget::slotCheckJob()
             m_view.start_job->setEnabled(false);
         } else {
             m_view.abort_job->setText(i18n("Remove Job"));
-            m_view.start_job->setEnabled(current->status() == WAITINGJOB);
+            m_view.start_job->setEnabled(current->status() == WAITINGJOB && current->type() != OutputRenderType);
         }
         activate = true;
     }
@@ -2625,6 +2907,12 @@ void RenderWidget::slotUpdateEncodeThreads(int val)
     KdenliveSettings::setEncodethreads(val);
 }
 
+void RenderWidget::slotUpdateRenderBudget(int val)
+{
+    KdenliveSettings::setRenderthreadbudget(val);
+    checkRenderStatus();
+}
+
 void RenderWidget::slotUpdateRescaleWidth(int val)
 {
     KdenliveSettings::setDefaultrescalewidth(val);
@@ -2695,6 +2983,47 @@ bool RenderWidget::isStemAudioExportEnabled() const
             && m_view.stemAudioExport->isVisible() && m_view.stemAudioExport->isEnabled());
 }
 
+bool RenderWidget::previewRendering(const QString &previewParams) const
+{
+    if (!m_view.preview_render->isChecked() || previewParams.isEmpty() || isStemAudioExportEnabled()) {
+        return false;
+    }
+    if (m_view.rescale->isChecked() && m_view.rescale->isEnabled()) {
+        // Preview chunks are rendered at project size
+        return false;
+    }
+    // Chunks are reused only if they were encoded exactly like the export, otherwise quality would suffer.
+    // Container and threading options do not change the encoded frames
+    static const QStringList ignoredArgs {QStringLiteral("f"), QStringLiteral("threads"), QStringLiteral("real_time"), QStringLiteral("movflags")};
+    auto parseArgs = [this](const QString &params, QMap<QString, QString> &args, bool resolve) {
+        const QStringList list = params.simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+        for (const QString &arg : list) {
+            const QString key = arg.section(QLatin1Char('='), 0, -2);
+            QString value = arg.section(QLatin1Char('='), -1);
+            if (resolve && (value.startsWith(QStringLiteral("%bitrate")) || value == QStringLiteral("%quality"))) {
+                value = QString::number(m_view.video->value()) + (value.contains("+'k'") ? QStringLiteral("k") : QString());
+            } else if (resolve && (value.startsWith(QStringLiteral("%audiobitrate")) || value == QStringLiteral("%audioquality"))) {
+                value = QString::number(m_view.audio->value()) + (value.contains("+'k'") ? QStringLiteral("k") : QString());
+            }
+            if (value.contains(QLatin1Char('%'))) {
+                // Placeholder that cannot be compared
+                return false;
+            }
+            if (!ignoredArgs.contains(key)) {
+                args.insert(key, value);
+            }
+        }
+        return true;
+    };
+    QMap<QString, QString> renderArgs;
+    QMap<QString, QString> previewArgs;
+    if (!parseArgs(m_view.advanced_params->toPlainText(), renderArgs, true) || !parseArgs(previewParams, previewArgs, false)) {
+        return false;
+    }
+    // Codec, quality, bitrate, pixel format, preset, size and audio settings must all match
+    return renderArgs.contains(QStringLiteral("vcodec")) && renderArgs == previewArgs;
+}
+
 void RenderWidget::setRescaleEnabled(bool enable)
 {
     for (int i = 0; i < m_view.rescale_box->layout()->count(); ++i) {
@@ -31,6 +31,7 @@
 
 class QDomElement;
 class QKeyEvent;
+class QJsonObject;
 
 // RenderViewDelegate is used to draw the progress bars.
 class RenderViewDelegate : public QStyledItemDelegate
@@ -118,6 +119,8 @@ public:
     void setProfile(const QString &profile);
     void setRenderJob(const QString &dest, int progress = 0);
     void setRenderStatus(const QString &dest, int status, const QString &error);
+    /** @brief Display the render speed sent by a running job. */
+    void setRenderStats(const QString &dest, const QJsonObject &stats);
     void setDocumentPath(const QString &path);
     void reloadProfiles();
     void setRenderProfile(const QMap<QString, QString> &props);
@@ -134,6 +137,8 @@ public:
     bool proxyRendering();
     /** @brief Returns true if the stem audio export checkbox is set. */
     bool isStemAudioExportEnabled() const;
+    /** @brief Returns true if timeline preview chunks rendered with @param previewParams can replace the timeline for this export. */
+    bool previewRendering(const QString &previewParams) const;
     enum RenderError {
         CompositeError = 0,
         ProfileError = 1,
@@ -183,6 +188,7 @@ private slots:
     void slotStartCurrentJob();
     void slotCopyToFavorites();
     void slotUpdateEncodeThreads(int);
+    void slotUpdateRenderBudget(int);
     void slotUpdateRescaleHeight(int);
     void slotUpdateRescaleWidth(int);
     void slotSwitchAspectRatio();
@@ -215,9 +221,17 @@ private:
     void parseFile(const QString &exportFile, bool editable);
     void updateButtons();
     QUrl filenameWithExtension(QUrl url, const QString &extension);
-    /** @brief Check if a job needs to be started. */
+    /** @brief Start the waiting jobs, in queue order, as long as the running jobs stay within the thread budget. */
     void checkRenderStatus();
     void startRendering(RenderJobItem *item);
+    /** @brief Number of encoding threads a job will use, from its threads= parameter. */
+    int jobThreads(RenderJobItem *item) const;
+    /** @brief Frames where a new segment starts for a parallel render of [in, out], at guides if possible. */
+    QList<int> segmentBoundaries(int in, int out, double fps, int threads) const;
+    /** @brief Returns the valid profiles ticked in the profile list, except the current one. */
+    QList<QTreeWidgetItem *> checkedProfiles() const;
+    /** @brief Consumer arguments for an additional output, using the default qualities of its profile. */
+    QStringList outputArguments(QTreeWidgetItem *item, bool exportAudio) const;
     bool saveProfile(QDomElement newprofile);
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, const QString &profileName);
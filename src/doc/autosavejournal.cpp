@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "autosavejournal.h"
+#include "kdenlive_debug.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QStandardPaths>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//static
+QString AutoSaveJournal::journalPath(const QString &autoSaveFile)
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/journal"));
+    if (!dir.exists()) {
+        dir.mkpath(QStringLiteral("."));
+    }
+    return dir.absoluteFilePath(QFileInfo(autoSaveFile).fileName() + QStringLiteral(".journal"));
+}
+
+//static
+QJsonObject AutoSaveJournal::checkpointInfo(const QString &autoSaveFile)
+{
+    QFileInfo info(autoSaveFile);
+    QJsonObject checkpoint;
+    checkpoint.insert(QStringLiteral("checkpoint"), info.fileName());
+    checkpoint.insert(QStringLiteral("size"), QString::number(info.size()));
+    checkpoint.insert(QStringLiteral("modified"), QString::number(info.lastModified().toMSecsSinceEpoch()));
+    return checkpoint;
+}
+
+//static
+void AutoSaveJournal::clear(const QString &autoSaveFile)
+{
+    QFile::remove(journalPath(autoSaveFile));
+}
+
+//static
+bool AutoSaveJournal::start(const QString &autoSaveFile)
+{
+    QFile file(journalPath(autoSaveFile));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KDENLIVE_LOG) << "// Cannot create autosave journal" << file.fileName();
+        return false;
+    }
+    file.write(QJsonDocument(checkpointInfo(autoSaveFile)).toJson(QJsonDocument::Compact) + '\n');
+    sync(&file);
+    return file.error() == QFile::NoError;
+}
+
+//static
+bool AutoSaveJournal::append(const QString &autoSaveFile, const QList<QJsonObject> &records)
+{
+    QFile file(journalPath(autoSaveFile));
+    if (!file.exists() || !file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+    QByteArray data;
+    for (const QJsonObject &record : records) {
+        data.append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+        data.append('\n');
+    }
+    file.write(data);
+    sync(&file);
+    return file.error() == QFile::NoError;
+}
+
+//static
+QList<QJsonObject> AutoSaveJournal::records(const QString &autoSaveFile)
+{
+    QList<QJsonObject> records;
+    QFile file(journalPath(autoSaveFile));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+    // The journal is only valid for the checkpoint it was started after
+    QJsonObject checkpoint = QJsonDocument::fromJson(file.readLine()).object();
+    if (checkpoint != checkpointInfo(autoSaveFile)) {
+        qCDebug(KDENLIVE_LOG) << "// Autosave journal does not match autosave file, ignoring it";
+        return records;
+    }
+    while (!file.atEnd()) {
+        QJsonParseError error;
+        QJsonObject record = QJsonDocument::fromJson(file.readLine(), &error).object();
+        if (error.error != QJsonParseError::NoError || record.isEmpty()) {
+            // Incomplete last record
+            break;
+        }
+        records << record;
+    }
+    return records;
+}
+
+//static
+void AutoSaveJournal::sync(QFileDevice *file)
+{
+    file->flush();
+#ifdef Q_OS_WIN
+    _commit(file->handle());
+#else
+    fsync(file->handle());
+#endif
+}
@@ -0,0 +1,59 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUTOSAVEJOURNAL_H
+#define AUTOSAVEJOURNAL_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+class QFileDevice;
+
+/**
+ * @class AutoSaveJournal
+ * @brief Journal of the timeline edits made since the autosave file was last written.
+ *
+ * The autosave file is a full checkpoint of the project. Between checkpoints, the replayable
+ * commands pushed on the undo stack are appended to the journal, one json record per line.
+ * The first line identifies the checkpoint the journal applies to.
+ */
+class AutoSaveJournal
+{
+public:
+    /** @brief Returns the journal file of an autosave file. */
+    static QString journalPath(const QString &autoSaveFile);
+    /** @brief Empty the journal, before a new checkpoint is written. */
+    static void clear(const QString &autoSaveFile);
+    /** @brief Start a new journal once the autosave file was written. */
+    static bool start(const QString &autoSaveFile);
+    /** @brief Append records to the journal, returns false if they could not be written. */
+    static bool append(const QString &autoSaveFile, const QList<QJsonObject> &records);
+    /** @brief Returns the journal records, empty if the journal does not belong to the current autosave file. */
+    static QList<QJsonObject> records(const QString &autoSaveFile);
+    /** @brief Flush a file to disk so that it survives a system crash. */
+    static void sync(QFileDevice *file);
+
+private:
+    static QJsonObject checkpointInfo(const QString &autoSaveFile);
+};
+
+#endif
@@ -18,6 +18,8 @@
  ***************************************************************************/
 
 #include "documentchecker.h"
+#include "projectscanner.h"
+#include "mediarelinker.h"
 #include "kthumb.h"
 
 #include "titler/titlewidget.h"
@@ -34,8 +36,11 @@
 #include <QTreeWidgetItem>
 #include <QFile>
 #include <QFileDialog>
-#include <QCryptographicHash>
 #include <QStandardPaths>
+#include <QProgressDialog>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 const int hashRole = Qt::UserRole;
 const int sizeRole = Qt::UserRole + 1;
@@ -57,11 +62,16 @@ const int LUMAPLACEHOLDER = 12;
 
 enum TITLECLIPTYPE { TITLE_IMAGE_ELEMENT = 20, TITLE_FONT_ELEMENT = 21 };
 
-DocumentChecker::DocumentChecker(const QUrl &url, const QDomDocument &doc):
-    m_url(url), m_doc(doc), m_dialog(nullptr)
+DocumentChecker::DocumentChecker(const QUrl &url, const QDomDocument &doc, const ProjectScanner *scanner):
+    m_url(url), m_doc(doc), m_dialog(nullptr), m_scanner(scanner)
 {
 }
 
+bool DocumentChecker::fileExists(const QString &path) const
+{
+    return m_scanner ? m_scanner->exists(path) : QFile::exists(path);
+}
+
 bool DocumentChecker::hasErrorInClips()
 {
     int max;
@@ -98,7 +108,7 @@ bool DocumentChecker::hasErrorInClips()
             if (!storageFolder.isEmpty() && QFileInfo(storageFolder).isRelative()) {
                 storageFolder.prepend(root);
             }
-            if (!storageFolder.isEmpty() && !QFile::exists(storageFolder) && projectDir.exists( documentid)) {
+            if (!storageFolder.isEmpty() && !fileExists(storageFolder) && projectDir.exists( documentid)) {
                 storageFolder = projectDir.absolutePath();
                 EffectsList::setProperty(playlists.at(i).toElement(), QStringLiteral("kdenlive:docproperties.storagefolder"), projectDir.absoluteFilePath(documentid));
                 m_doc.documentElement().setAttribute(QStringLiteral("modified"), QStringLiteral("1"));
@@ -171,7 +181,7 @@ bool DocumentChecker::hasErrorInClips()
             if (QFileInfo(proxy).isRelative()) {
                 proxy.prepend(root);
             }
-            if (!QFile::exists(proxy)) {
+            if (!fileExists(proxy)) {
                 // Missing clip found
                 // Check if proxy exists in current storage folder
                 bool fixed = false;
@@ -196,7 +206,7 @@ bool DocumentChecker::hasErrorInClips()
             if (slideshow && !EffectsList::property(e, QStringLiteral("ttl")).isEmpty()) {
                 original = QFileInfo(original).absolutePath();
             }
-            if (!QFile::exists(original)) {
+            if (!fileExists(original)) {
                 // clip has proxy but original clip is missing
                 missingSources.append(e);
             }
@@ -208,7 +218,7 @@ bool DocumentChecker::hasErrorInClips()
         if ((service == QLatin1String("qimage") || service == QLatin1String("pixbuf")) && slideshow) {
             resource = QFileInfo(resource).absolutePath();
         }
-        if (!QFile::exists(resource)) {
+        if (!fileExists(resource)) {
             // Missing clip found
             m_missingClips.append(e);
         }
@@ -244,13 +254,13 @@ bool DocumentChecker::hasErrorInClips()
         if (QFileInfo(filePath).isRelative()) {
             filePath.prepend(root);
         }
-        if (!QFile::exists(filePath)) {
+        if (!fileExists(filePath)) {
             QString lumaName = filePath.section(QLatin1Char('/'), -1);
             // check if this was an old format luma, not in correct folder
             QString fixedLuma = filePath.section(QLatin1Char('/'), 0, -2);
             lumaName.prepend(hdProfile ? QStringLiteral("/HD/") : QStringLiteral("/PAL/"));
             fixedLuma.append(lumaName);
-            if (QFile::exists(fixedLuma)) {
+            if (fileExists(fixedLuma)) {
                 // Auto replace pgm with png for lumas
                 autoFixLuma.insert(filePath, fixedLuma);
                 continue;
@@ -263,7 +273,7 @@ bool DocumentChecker::hasErrorInClips()
                 lumaPath = dir.absolutePath();
             }
             lumaName.prepend(lumaPath);
-            if (QFile::exists(lumaName)) {
+            if (fileExists(lumaName)) {
                 autoFixLuma.insert(filePath, lumaName);
                 continue;
             }
@@ -273,7 +283,7 @@ bool DocumentChecker::hasErrorInClips()
             } else if (filePath.endsWith(QLatin1String(".png"))) {
                 fixedLuma = filePath.section(QLatin1Char('.'), 0, -2) + QStringLiteral(".pgm");
             }
-            if (!fixedLuma.isEmpty() && QFile::exists(fixedLuma)) {
+            if (!fixedLuma.isEmpty() && fileExists(fixedLuma)) {
                 // Auto replace pgm with png for lumas
                 autoFixLuma.insert(filePath, fixedLuma);
             } else {
@@ -560,62 +570,79 @@ void DocumentChecker::slotSearchClips()
     int ix = 0;
     bool fixed = false;
     m_ui.recursiveSearch->setChecked(true);
-    //TODO: make non modal
+    // All missing files are searched in a single crawl of the folder
+    MediaRelinker relinker(newpath);
+    QHash<QTreeWidgetItem *, int> requests;
     QTreeWidgetItem *child = m_ui.treeWidget->topLevelItem(ix);
-    QDir searchDir(newpath);
     while (child) {
         if (child->data(0, statusRole).toInt() == SOURCEMISSING) {
             for (int j = 0; j < child->childCount(); ++j) {
                 QTreeWidgetItem *subchild = child->child(j);
-                QString clipPath = searchFileRecursively(searchDir, subchild->data(0, sizeRole).toString(), subchild->data(0, hashRole).toString(), subchild->text(1));
-                if (!clipPath.isEmpty()) {
-                    fixed = true;
-                    subchild->setText(1, clipPath);
-                    subchild->setIcon(0, KoIconUtils::themedIcon(QStringLiteral("dialog-ok")));
-                    subchild->setData(0, statusRole, CLIPOK);
-                }
+                requests.insert(subchild, relinker.addRequest(subchild->text(1), fileSize(subchild), subchild->data(0, hashRole).toString()));
             }
         } else if (child->data(0, statusRole).toInt() == CLIPMISSING) {
-            bool perfectMatch = true;
             ClipType type = (ClipType) child->data(0, clipTypeRole).toInt();
-            QString clipPath;
-            if (type != SlideShow) {
+            if (type == SlideShow) {
                 // Slideshows cannot be found with hash / size
-                clipPath = searchFileRecursively(searchDir, child->data(0, sizeRole).toString(), child->data(0, hashRole).toString(), child->text(1));
-            }
-            if (clipPath.isEmpty()) {
-                clipPath = searchPathRecursively(searchDir, QUrl::fromLocalFile(child->text(1)).fileName(), type);
-                perfectMatch = false;
-            }
-            if (!clipPath.isEmpty()) {
-                fixed = true;
-                child->setText(1, clipPath);
-                child->setIcon(0, perfectMatch ? KoIconUtils::themedIcon(QStringLiteral("dialog-ok")) : KoIconUtils::themedIcon(QStringLiteral("dialog-warning")));
-                child->setData(0, statusRole, CLIPOK);
+                requests.insert(child, relinker.addRequest(child->text(1), -1, QString(), true));
+            } else {
+                requests.insert(child, relinker.addRequest(child->text(1), fileSize(child), child->data(0, hashRole).toString()));
             }
         } else if (child->data(0, statusRole).toInt() == LUMAMISSING) {
-            QString fileName = searchLuma(searchDir, child->data(0, idRole).toString());
+            QString fileName = searchLuma(child->data(0, idRole).toString());
             if (!fileName.isEmpty()) {
                 fixed = true;
                 child->setText(1, fileName);
                 child->setIcon(0, KoIconUtils::themedIcon(QStringLiteral("dialog-ok")));
                 child->setData(0, statusRole, LUMAOK);
+            } else {
+                requests.insert(child, relinker.addRequest(child->data(0, idRole).toString()));
             }
         } else if (child->data(0, typeRole).toInt() == TITLE_IMAGE_ELEMENT && child->data(0, statusRole).toInt() == CLIPPLACEHOLDER) {
             // Search missing title images
-            QString missingFileName = QUrl::fromLocalFile(child->text(1)).fileName();
-            QString newPath = searchPathRecursively(searchDir, missingFileName);
-            if (!newPath.isEmpty()) {
-                // File found
-                fixed = true;
-                child->setText(1, newPath);
-                child->setIcon(0, KoIconUtils::themedIcon(QStringLiteral("dialog-ok")));
-                child->setData(0, statusRole, CLIPOK);
-            }
+            requests.insert(child, relinker.addRequest(child->text(1)));
         }
         ix++;
         child = m_ui.treeWidget->topLevelItem(ix);
     }
+    if (!requests.isEmpty()) {
+        QProgressDialog progress(i18n("Searching missing files"), i18n("Cancel"), 0, 0, m_dialog);
+        progress.setWindowModality(Qt::WindowModal);
+        progress.setMinimumDuration(500);
+        connect(&relinker, &MediaRelinker::progress, &progress, [&progress](int done, int total) {
+            if (total == 0) {
+                progress.setLabelText(i18np("Indexing files: %1 file", "Indexing files: %1 files", done));
+            } else {
+                progress.setLabelText(i18n("Comparing files"));
+                progress.setMaximum(total);
+                progress.setValue(done);
+            }
+        });
+        connect(&progress, &QProgressDialog::canceled, &relinker, &MediaRelinker::cancel, Qt::DirectConnection);
+        QEventLoop loop;
+        QFutureWatcher<void> watcher;
+        connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+        watcher.setFuture(QtConcurrent::run(&relinker, &MediaRelinker::run));
+        loop.exec();
+    }
+    QHash<QTreeWidgetItem *, int>::const_iterator i = requests.constBegin();
+    for (; i != requests.constEnd(); ++i) {
+        QTreeWidgetItem *item = i.key();
+        const QString path = relinker.result(i.value());
+        if (path.isEmpty()) {
+            continue;
+        }
+        if (item->parent() != nullptr && !relinker.isPerfectMatch(i.value())) {
+            // Sources of proxy clips are only accepted if their content matches
+            continue;
+        }
+        fixed = true;
+        item->setText(1, path);
+        // Clips found by name only may not be the right ones
+        bool perfectMatch = item->data(0, statusRole).toInt() != CLIPMISSING || relinker.isPerfectMatch(i.value());
+        item->setIcon(0, perfectMatch ? KoIconUtils::themedIcon(QStringLiteral("dialog-ok")) : KoIconUtils::themedIcon(QStringLiteral("dialog-warning")));
+        item->setData(0, statusRole, item->data(0, statusRole).toInt() == LUMAMISSING ? LUMAOK : CLIPOK);
+    }
     m_ui.recursiveSearch->setChecked(false);
     m_ui.recursiveSearch->setEnabled(true);
     if (fixed) {
@@ -625,7 +652,14 @@ void DocumentChecker::slotSearchClips()
     checkStatus();
 }
 
-QString DocumentChecker::searchLuma(const QDir &dir, const QString &file) const
+qint64 DocumentChecker::fileSize(const QTreeWidgetItem *item) const
+{
+    bool ok;
+    qint64 size = item->data(0, sizeRole).toString().toLongLong(&ok);
+    return ok ? size : -1;
+}
+
+QString DocumentChecker::searchLuma(const QString &file) const
 {
     QDir searchPath(KdenliveSettings::mltpath());
     QString fname = QUrl::fromLocalFile(file).fileName();
@@ -650,90 +684,7 @@ QString DocumentChecker::searchLuma(const QDir &dir, const QString &file) const
         return result.filePath();
     }
     // Try in Kdenlive's standard KDE path
-    QString res = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("lumas/") + fname);
-    if (!res.isEmpty()) {
-        return res;
-    }
-    // Try in user's chosen folder
-    return searchPathRecursively(dir, fname);
-}
-
-QString DocumentChecker::searchPathRecursively(const QDir &dir, const QString &fileName, ClipType type) const
-{
-    QString foundFileName;
-    QStringList filters;
-    if (type == SlideShow) {
-        if (fileName.contains(QLatin1Char('%'))) {
-            filters << fileName.section(QLatin1Char('%'), 0, -2) + QLatin1Char('*');
-        } else {
-            return QString();
-        }
-    } else {
-        filters << fileName;
-    }
-    QDir searchDir(dir);
-    searchDir.setNameFilters(filters);
-    QStringList filesAndDirs = searchDir.entryList(QDir::Files | QDir::Readable);
-    if (!filesAndDirs.isEmpty()) {
-        // File Found
-        if (type == SlideShow) {
-            return searchDir.absoluteFilePath(fileName);
-        }
-        return searchDir.absoluteFilePath(filesAndDirs.at(0));
-    }
-    searchDir.setNameFilters(QStringList());
-    filesAndDirs = searchDir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchPathRecursively(searchDir.absoluteFilePath(filesAndDirs.at(i)), fileName, type);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
-QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName) const
-{
-    if (matchSize.isEmpty() && matchHash.isEmpty()) {
-        return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
-    }
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                * 1 MB = 1 second per 450 files (or faster)
-                * 10 MB = 9 seconds per 450 files (or faster)
-                */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash, fileName);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
+    return QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("lumas/") + fname);
 }
 
 void DocumentChecker::slotEditItem(QTreeWidgetItem *item, int)
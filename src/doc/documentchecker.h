@@ -27,12 +27,15 @@
 #include <QUrl>
 #include <QDomElement>
 
+class ProjectScanner;
+
 class DocumentChecker: public QObject
 {
     Q_OBJECT
 
 public:
-    explicit DocumentChecker(const QUrl &url, const QDomDocument &doc);
+    /** @param scanner optional result of a previous scan of the project files */
+    explicit DocumentChecker(const QUrl &url, const QDomDocument &doc, const ProjectScanner *scanner = nullptr);
     ~DocumentChecker();
     /**
      * @brief checks for problems with the clips in the project
@@ -51,7 +54,8 @@ private slots:
     void slotDeleteSelected();
     QString getProperty(const QDomElement &effect, const QString &name);
     void setProperty(const QDomElement &effect, const QString &name, const QString &value);
-    QString searchLuma(const QDir &dir, const QString &file) const;
+    /** @brief Search a luma file in the standard folders. */
+    QString searchLuma(const QString &file) const;
     /** @brief Check if images and fonts in this clip exists, returns a list of images that do exist so we don't check twice. */
     void checkMissingImagesAndFonts(const QStringList &images, const QStringList &fonts, const QString &id, const QString &baseClip);
     void slotCheckButtons();
@@ -62,8 +66,8 @@ private:
     Ui::MissingClips_UI m_ui;
     QDialog *m_dialog;
     QPair <QString, QString>m_rootReplacement;
-    QString searchPathRecursively(const QDir &dir, const QString &fileName, ClipType type = Unknown) const;
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName) const;
+    /** @brief Returns the size of a missing file, or -1 if unknown. */
+    qint64 fileSize(const QTreeWidgetItem *item) const;
     void checkStatus();
     QMap<QString, QString> m_missingTitleImages;
     QMap<QString, QString> m_missingTitleFonts;
@@ -72,6 +76,8 @@ private:
     QStringList m_safeImages;
     QStringList m_safeFonts;
     QStringList m_missingProxyIds;
+    const ProjectScanner *m_scanner;
+    bool fileExists(const QString &path) const;
 
     void fixClipItem(QTreeWidgetItem *child, const QDomNodeList &producers, const QDomNodeList &trans);
     void fixSourceClipItem(QTreeWidgetItem *child, const QDomNodeList &producers);
@@ -33,6 +33,11 @@
 #include "dialogs/profilesdialog.h"
 #include "titler/titlewidget.h"
 #include "project/notesplugin.h"
+#include "project/cacheledger.h"
+#include "project/sharedcache.h"
+#include "projectscanner.h"
+#include "projectserializer.h"
+#include "autosavejournal.h"
 #include "project/dialogs/noteswidget.h"
 #include "core.h"
 #include "bin/bin.h"
@@ -41,6 +46,7 @@
 #include "mltcontroller/bincontroller.h"
 #include "mltcontroller/effectscontroller.h"
 #include "timeline/transitionhandler.h"
+#include "timeline/timelinecommands.h"
 
 #include <KMessageBox>
 #include <klocalizedstring.h>
@@ -51,6 +57,9 @@
 
 #include <QCryptographicHash>
 #include <QFile>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QTemporaryFile>
 #include "kdenlive_debug.h"
 #include <QFileDialog>
 #include <QDomImplementation>
@@ -61,6 +70,7 @@
 #include <mlt++/Mlt.h>
 #include <KJobWidgets/KJobWidgets>
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 #include <locale>
 #ifdef Q_OS_MAC
@@ -68,6 +78,7 @@
 #endif
 
 DocUndoStack::DocUndoStack(QUndoGroup *parent) : QUndoStack(parent)
+    , m_pushing(false)
 {
 }
 
@@ -77,7 +88,17 @@ void DocUndoStack::push(QUndoCommand *cmd)
     if (index() < count()) {
         emit invalidate();
     }
+    // A command that can be merged may be deleted by the push
+    const bool mergeable = cmd->id() != -1;
+    m_pushing = true;
     QUndoStack::push(cmd);
+    m_pushing = false;
+    emit commandPushed(mergeable ? nullptr : command(index() - 1));
+}
+
+bool DocUndoStack::isPushing() const
+{
+    return m_pushing;
 }
 
 const double DOCUMENTVERSION = 0.96;
@@ -91,7 +112,12 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     m_render(render),
     m_notesWidget(notes->widget()),
     m_modified(false),
-    m_projectFolder(projectFolder)
+    m_projectFolder(projectFolder),
+    m_autoSavePending(false),
+    m_autoSaveSnapshotTime(0),
+    m_journalValid(false),
+    m_journalSize(0),
+    m_journalSnapshot(0)
 {
     // init m_profile struct
     m_commandStack = new DocUndoStack(undoGroup);
@@ -111,6 +137,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     bool success = false;
     connect(m_commandStack, &QUndoStack::indexChanged, this, &KdenliveDoc::slotModified);
     connect(m_commandStack, &DocUndoStack::invalidate, this, &KdenliveDoc::checkPreviewStack);
+    connect(m_commandStack, &DocUndoStack::commandPushed, this, &KdenliveDoc::slotCommandPushed);
     connect(m_render, &Render::setDocumentNotes, this, &KdenliveDoc::slotSetDocumentNotes);
     connect(pCore->producerQueue(), &ProducerQueue::switchProfile, this, &KdenliveDoc::switchProfile);
     //connect(m_commandStack, SIGNAL(cleanChanged(bool)), this, SLOT(setModified(bool)));
@@ -120,6 +147,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     connect(&m_fileWatcher, &KDirWatch::dirty, this, &KdenliveDoc::slotClipModified);
     connect(&m_fileWatcher, &KDirWatch::deleted, this, &KdenliveDoc::slotClipMissing);
     connect(&m_modifiedTimer, &QTimer::timeout, this, &KdenliveDoc::slotProcessModifiedClips);
+    connect(&m_autoSaveWatcher, &QFutureWatcherBase::finished, this, &KdenliveDoc::slotAutoSaveFinished);
 
     // init default document properties
     m_documentProperties[QStringLiteral("zoom")] = QLatin1Char('7');
@@ -168,12 +196,18 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
             //KMessageBox::error(parent, KIO::NetAccess::lastErrorString());
         } else {
             qCDebug(KDENLIVE_LOG) << " // / processing file open";
+            QElapsedTimer loadTime;
+            loadTime.start();
+            // Check the project files in a worker thread while the document is parsed
+            ProjectScanner scanner(url);
+            QFuture<void> scanning = QtConcurrent::run(&scanner, &ProjectScanner::scan);
             QString errorMsg;
             int line;
             int col;
             QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
             success = m_document.setContent(&file, false, &errorMsg, &line, &col);
             file.close();
+            qCDebug(KDENLIVE_LOG) << "// Project parsed in" << loadTime.elapsed() << "ms";
 
             if (!success) {
                 // It is corrupted
@@ -231,15 +265,18 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
                      */
                     // TODO: backup the document or alert the user?
                     success = validator.validate(DOCUMENTVERSION);
-                    if (success && !KdenliveSettings::gpu_accel()) {
+                    scanning.waitForFinished();
+                    if (success && !KdenliveSettings::gpu_accel() && scanner.usesMovit()) {
                         success = validator.checkMovit();
                     }
+                    qCDebug(KDENLIVE_LOG) << "// Project validated in" << loadTime.elapsed() << "ms";
                     if (success) { // Let the validator handle error messages
                         qCDebug(KDENLIVE_LOG) << " // / processing file validate ok";
                         parent->slotGotProgressInfo(i18n("Check missing clips"), 100);
                         qApp->processEvents();
-                        DocumentChecker d(m_url, m_document);
+                        DocumentChecker d(m_url, m_document, &scanner);
                         success = !d.hasErrorInClips();
+                        qCDebug(KDENLIVE_LOG) << "// Project clips checked in" << loadTime.elapsed() << "ms";
                         if (success) {
                             loadDocumentProperties();
                             if (m_document.documentElement().attribute(QStringLiteral("modified")) == QLatin1String("1")) {
@@ -252,6 +289,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
                     }
                 }
             }
+            scanning.waitForFinished();
         }
     }
 
@@ -306,8 +344,10 @@ KdenliveDoc::~KdenliveDoc()
     //qCDebug(KDENLIVE_LOG) << "// DEL CLP MAN";
     delete m_clipManager;
     //qCDebug(KDENLIVE_LOG) << "// DEL CLP MAN done";
+    m_autoSaveWatcher.waitForFinished();
     if (m_autosave) {
         if (!m_autosave->fileName().isEmpty()) {
+            AutoSaveJournal::clear(m_autosave->fileName());
             m_autosave->remove();
         }
         delete m_autosave;
@@ -319,7 +359,7 @@ int KdenliveDoc::setSceneList()
     //m_render->resetProfile(m_profile);
     pCore->bin()->isLoading = true;
     pCore->producerQueue()->abortOperations();
-    if (m_render->setSceneList(m_document.toString(), m_documentProperties.value(QStringLiteral("position")).toInt()) == -1) {
+    if (m_render->setSceneList(m_document, m_documentProperties.value(QStringLiteral("position")).toInt()) == -1) {
         // INVALID MLT Consumer, something is wrong
         return -1;
     }
@@ -329,6 +369,18 @@ int KdenliveDoc::setSceneList()
     QDir thumbsFolder = getCacheDir(CacheThumbs, &ok);
     if (ok) {
         pCore->binController()->checkThumbnails(thumbsFolder);
+        // Thumbnails can be regenerated, drop the least recently used ones
+        const qint64 maxSize = (qint64) KdenliveSettings::thumbcachesize() * 1024 * 1024;
+        CacheLedger::instance()->trim(thumbsFolder, maxSize);
+        QDir audioFolder = getCacheDir(CacheAudio, &ok);
+        if (ok) {
+            CacheLedger::instance()->trim(audioFolder, maxSize);
+        }
+    }
+    if (SharedCache::isEnabled()) {
+        // Mark the shared files used by this project as recently used
+        SharedCache::instance()->addReferences(sharedFiles(), getDocumentProperty(QStringLiteral("documentid")));
+        SharedCache::instance()->evict();
     }
     m_documentProperties.remove(QStringLiteral("position"));
     pCore->monitorManager()->activateMonitor(Kdenlive::ClipMonitor, true);
@@ -545,6 +597,26 @@ QDomDocument KdenliveDoc::createEmptyDocument(const QList<TrackInfo> &tracks)
     return doc;
 }
 
+QStringList KdenliveDoc::sharedFiles() const
+{
+    QStringList files;
+    const QList<ClipController *> controllers = pCore->binController()->getControllerList();
+    for (ClipController *ctrl : controllers) {
+        files << ctrl->property(QStringLiteral("kdenlive:proxy"));
+        if (!ctrl->getClipHash().isEmpty()) {
+            files << SharedCache::instance()->thumbnailPath(ctrl->getClipHash());
+        }
+    }
+    return files;
+}
+
+void KdenliveDoc::releaseSharedFiles()
+{
+    if (SharedCache::isEnabled()) {
+        SharedCache::instance()->removeReferences(sharedFiles(), getDocumentProperty(QStringLiteral("documentid")));
+    }
+}
+
 bool KdenliveDoc::useProxy() const
 {
     return m_documentProperties.value(QStringLiteral("enableproxy")).toInt();
@@ -560,23 +632,174 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
     return m_documentProperties.value(QStringLiteral("generateimageproxy")).toInt() && width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt();
 }
 
+bool KdenliveDoc::openAutoSave()
+{
+    if (!m_render || !m_autosave) {
+        return false;
+    }
+    if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
+        // show error: could not open the autosave file
+        qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
+    }
+    //qCDebug(KDENLIVE_LOG) << "// AUTOSAVE FILE: " << m_autosave->fileName();
+    return true;
+}
+
+bool KdenliveDoc::autoSaveJournal()
+{
+    return openAutoSave() && writeJournal();
+}
+
+void KdenliveDoc::resetAutoSaveJournal()
+{
+    if (m_autosave) {
+        AutoSaveJournal::clear(m_autosave->fileName());
+    }
+    m_journalRecords.clear();
+    m_journalValid = true;
+    m_journalSize = 0;
+    m_journalSnapshot = 0;
+    m_checkpointTime.invalidate();
+}
+
 void KdenliveDoc::slotAutoSave()
 {
     if (m_render && m_autosave) {
-        if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
-            // show error: could not open the autosave file
-            qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
+        if (deferAutoSave() || !openAutoSave()) {
+            return;
         }
-        //qCDebug(KDENLIVE_LOG) << "// AUTOSAVE FILE: " << m_autosave->fileName();
-        QDomDocument sceneList = xmlSceneList(m_render->sceneList(m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile()));
-        if (sceneList.isNull()) {
+        // Write a full checkpoint, the journal restarts after it
+        m_autoSaveTime.start();
+        m_checkpointTime.invalidate();
+        if (!m_journalValid) {
+            m_journalRecords.clear();
+            m_journalValid = true;
+        }
+        // Only take a snapshot of the timeline here, the autosave file is written in a thread
+        const QByteArray snapshot = m_render->sceneList(m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile()).toUtf8();
+        if (snapshot.isEmpty()) {
             //Make sure we don't save if scenelist is corrupted
             KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
             return;
         }
-        m_autosave->resize(0);
-        m_autosave->write(sceneList.toString().toUtf8());
-        m_autosave->flush();
+        m_autoSaveSnapshotTime = m_autoSaveTime.elapsed();
+        // Records pushed from now on are not in the snapshot and go to the next journal
+        m_journalSnapshot = m_journalRecords.count();
+        m_autoSaveWatcher.setFuture(QtConcurrent::run(&KdenliveDoc::writeAutoSave, snapshot, customEffectsXml(), static_cast<QFile *>(m_autosave)));
+    }
+}
+
+bool KdenliveDoc::writeJournal()
+{
+    if (!KdenliveSettings::autosavejournal() || !m_journalValid || !m_checkpointTime.isValid()) {
+        return false;
+    }
+    if (m_journalSize + m_journalRecords.count() > KdenliveSettings::journalcheckpoint() || m_checkpointTime.elapsed() > 600000) {
+        // Time for a new checkpoint
+        return false;
+    }
+    if (m_journalRecords.isEmpty()) {
+        return true;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    if (!AutoSaveJournal::append(m_autosave->fileName(), m_journalRecords)) {
+        return false;
+    }
+    qCDebug(KDENLIVE_LOG) << "// Autosave journal:" << m_journalRecords.count() << "records written in" << timer.elapsed() << "ms";
+    m_journalSize += m_journalRecords.count();
+    m_journalRecords.clear();
+    return true;
+}
+
+void KdenliveDoc::slotCommandPushed(const QUndoCommand *command)
+{
+    if (!m_journalValid) {
+        return;
+    }
+    QJsonObject record = command ? JournalCommand::record(command) : QJsonObject();
+    if (record.isEmpty()) {
+        // This change can only be saved in a full autosave
+        m_journalValid = false;
+        m_journalRecords.clear();
+        return;
+    }
+    m_journalRecords << record;
+}
+
+bool KdenliveDoc::deferAutoSave()
+{
+    if (m_autoSaveWatcher.isRunning()) {
+        m_autoSavePending = true;
+        return true;
+    }
+    if (m_commandStack->isPushing()) {
+        // Wait until the command is in the journal
+        QMetaObject::invokeMethod(this, "startAutoSave", Qt::QueuedConnection);
+        return true;
+    }
+    return false;
+}
+
+void KdenliveDoc::waitForAutoSave()
+{
+    m_autoSaveWatcher.waitForFinished();
+}
+
+//static
+QString KdenliveDoc::writeAutoSave(const QByteArray &snapshot, const QString &customEffects, QFile *destination)
+{
+    QString error;
+    QBuffer source;
+    source.setData(snapshot);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return source.errorString();
+    }
+    // Keep the previous autosave until the new one is complete
+    QSaveFile file(destination->fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return file.errorString();
+    }
+    ProjectSerializer serializer(BinController::binPlaylistId());
+    serializer.setCustomEffects(customEffects);
+    if (!serializer.write(&source, &file)) {
+        error = serializer.errorString();
+        file.cancelWriting();
+        return error;
+    }
+    // Make sure the autosave survives a system crash
+    AutoSaveJournal::sync(&file);
+    // The autosave file is replaced, reopen it so that it is not left on the previous file
+    destination->close();
+    if (!file.commit()) {
+        error = file.errorString();
+    }
+    destination->open(QIODevice::ReadWrite);
+    return error;
+}
+
+void KdenliveDoc::slotAutoSaveFinished()
+{
+    const QString error = m_autoSaveWatcher.result();
+    if (!error.isEmpty()) {
+        qCWarning(KDENLIVE_LOG) << "//////  ERROR writing autosave: " << error;
+        KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
+    } else {
+        qCDebug(KDENLIVE_LOG) << "// Autosave written in" << m_autoSaveTime.elapsed() << "ms, GUI thread snapshot took" << m_autoSaveSnapshotTime << "ms";
+        // Only drop the records contained in the checkpoint
+        m_journalRecords = m_journalRecords.mid(m_journalSnapshot);
+        m_journalSize = 0;
+        if (KdenliveSettings::autosavejournal() && AutoSaveJournal::start(m_autosave->fileName())) {
+            m_checkpointTime.start();
+        }
+    }
+    m_journalSnapshot = 0;
+    if (m_autoSavePending) {
+        // Changes were made while writing, schedule a new autosave
+        m_autoSavePending = false;
+        if (m_modified) {
+            emit startAutoSave();
+        }
     }
 }
 
@@ -683,18 +906,45 @@ QString KdenliveDoc::documentNotes() const
     return m_notesWidget->toHtml();
 }
 
-bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
+bool KdenliveDoc::writeSceneList(QIODevice *destination, const QString &root, const QMap<QString, QString> &replacements, QString &error)
 {
-    QDomDocument sceneList = xmlSceneList(scene);
-    if (sceneList.isNull()) {
-        //Make sure we don't save if scenelist is corrupted
-        KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", path));
+    // Let MLT write the scene to disk, then stream it to its destination
+    QTemporaryFile mltFile(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
+    if (!mltFile.open()) {
+        error = mltFile.errorString();
+        return false;
+    }
+    mltFile.close();
+    if (!m_render->writeSceneList(mltFile.fileName(), root) || !mltFile.open()) {
+        error = i18n("Cannot create scene list");
+        return false;
+    }
+    ProjectSerializer serializer(BinController::binPlaylistId());
+    serializer.setCustomEffects(customEffectsXml());
+    serializer.setReplacements(replacements);
+    if (!serializer.write(&mltFile, destination)) {
+        error = serializer.errorString();
+        qCWarning(KDENLIVE_LOG) << "//////  ERROR writing scene list: " << error;
         return false;
     }
+    return true;
+}
+
+QString KdenliveDoc::customEffectsXml() const
+{
+    // check if project contains custom effects to embed them in project file
+    QDomDocument customeffects = initEffects::getUsedCustomEffects(m_render->usedEffects());
+    if (customeffects.documentElement().childNodes().isEmpty()) {
+        return QString();
+    }
+    return customeffects.toString();
+}
 
+bool KdenliveDoc::saveSceneList(const QString &path, const QString &root, const QMap<QString, QString> &replacements)
+{
     // Backup current version
     backupLastSavedVersion(path);
-    QFile file(path);
+    QSaveFile file(path);
 
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         qCWarning(KDENLIVE_LOG) << "//////  ERROR writing to file: " << path;
@@ -702,15 +952,19 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
         return false;
     }
 
-    file.write(sceneList.toString().toUtf8());
-    if (file.error() != QFile::NoError) {
+    QString error;
+    if (!writeSceneList(&file, root, replacements, error)) {
+        //Make sure we don't save if scenelist is corrupted
+        file.cancelWriting();
+        KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", path));
+        return false;
+    }
+    if (!file.commit()) {
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
-        file.close();
         return false;
     }
-    file.close();
     cleanupBackupFiles();
-    QFileInfo info(file);
+    QFileInfo info(path);
     QString fileName = QUrl::fromLocalFile(path).fileName().section(QLatin1Char('.'), 0, -2);
     fileName.append(QLatin1Char('-') + m_documentProperties.value(QStringLiteral("documentid")));
     fileName.append(info.lastModified().toString(QStringLiteral("-yyyy-MM-dd-hh-mm")));
@@ -899,10 +1153,21 @@ void KdenliveDoc::setUrl(const QUrl &url)
 
 void KdenliveDoc::slotModified()
 {
-    setModified(m_commandStack->isClean() == false);
+    if (!m_commandStack->isPushing()) {
+        // Undo and redo are not written in the autosave journal
+        m_journalValid = false;
+    }
+    updateModified(m_commandStack->isClean() == false);
 }
 
 void KdenliveDoc::setModified(bool mod)
+{
+    // Changes made outside of the undo stack need a full autosave
+    m_journalValid = false;
+    updateModified(mod);
+}
+
+void KdenliveDoc::updateModified(bool mod)
 {
     // fix mantis#3160: The document may have an empty URL if not saved yet, but should have a m_autosave in any case
     if (m_autosave && mod && KdenliveSettings::crashrecovery()) {
@@ -929,49 +1194,6 @@ const QString KdenliveDoc::description() const
     }
 }
 
-QString KdenliveDoc::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const
-{
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (file.open(QIODevice::ReadOnly)) {
-            if (QString::number(file.size()) == matchSize) {
-                /*
-                * 1 MB = 1 second per 450 files (or faster)
-                * 10 MB = 9 seconds per 450 files (or faster)
-                */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                } else {
-                    qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << "size match but not hash";
-                }
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
 void KdenliveDoc::deleteClip(const QString &clipId, ClipType type, const QString &url)
 {
     pCore->binController()->removeBinClip(clipId);
@@ -1022,8 +1244,8 @@ void KdenliveDoc::cacheImage(const QString &fileId, const QImage &img) const
 {
     bool ok = false;
     QDir dir = getCacheDir(CacheThumbs, &ok);
-    if (ok) {
-        img.save(dir.absoluteFilePath(fileId + QStringLiteral(".png")));
+    if (ok && img.save(dir.absoluteFilePath(fileId + QStringLiteral(".png")))) {
+        CacheLedger::instance()->addFile(dir, fileId + QStringLiteral(".png"));
     }
 }
 
@@ -1342,6 +1564,10 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipLi
         extension.prepend(QStringLiteral("-") + proxySize);
     }
 
+    // Proxies are shared with other projects, unless the project has its own folder
+    const bool sharedProxy = SharedCache::isEnabled() && m_projectFolder.isEmpty();
+    QStringList removedProxies;
+
     // Prepare updated properties
     QMap<QString, QString> newProps;
     QMap<QString, QString> oldProps;
@@ -1363,8 +1589,18 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipLi
             }
 
             if (doProxy) {
+                if (item->hash().isEmpty()) {
+                    // The proxy is named after the clip hash, create it when the file is hashed
+                    pCore->bin()->delayProxy(item->clipId(), force, hasParent ? masterCommand->text() : QString());
+                    continue;
+                }
                 newProps.clear();
-                QString path = dir.absoluteFilePath(item->hash() + (t == Image ? QStringLiteral(".png") : extension));
+                QString path;
+                if (sharedProxy) {
+                    path = SharedCache::instance()->proxyPath(item->hash(), t == Image ? QStringLiteral("image") : params, t == Image ? QStringLiteral(".png") : extension);
+                } else {
+                    path = dir.absoluteFilePath(item->hash() + (t == Image ? QStringLiteral(".png") : extension));
+                }
                 // insert required duration for proxy
                 newProps.insert(QStringLiteral("proxy_out"), item->getProducerProperty(QStringLiteral("out")));
                 newProps.insert(QStringLiteral("kdenlive:proxy"), path);
@@ -1373,6 +1609,7 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipLi
                 //oldProps = clip->currentProperties(newProps);
                 oldProps.insert(QStringLiteral("kdenlive:proxy"), QStringLiteral("-"));
             } else {
+                removedProxies << item->getProducerProperty(QStringLiteral("kdenlive:proxy"));
                 if (t == SlideShow) {
                     // Revert to picture aspect ratio
                     newProps.insert(QStringLiteral("aspect_ratio"), QStringLiteral("1"));
@@ -1388,6 +1625,9 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipLi
             pCore->bin()->doDisplayMessage(i18n("Clip type does not support proxies"), KMessageWidget::Information);
         }
     }
+    if (!removedProxies.isEmpty()) {
+        SharedCache::instance()->removeReferences(removedProxies, getDocumentProperty(QStringLiteral("documentid")));
+    }
     if (!hasParent) {
         if (masterCommand->childCount() > 0) {
             m_commandStack->push(masterCommand);
@@ -36,6 +36,9 @@
 #include <kautosavefile.h>
 #include <KDirWatch>
 #include <QUndoStack>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QJsonObject>
 
 #include "gentime.h"
 #include "timecode.h"
@@ -52,6 +55,8 @@ class ProjectClip;
 class ClipController;
 
 class QTextEdit;
+class QIODevice;
+class QFile;
 class QUndoGroup;
 class QTimer;
 class QUndoGroup;
@@ -67,8 +72,14 @@ class DocUndoStack: public QUndoStack
 public:
     explicit DocUndoStack(QUndoGroup *parent = nullptr);
     void push(QUndoCommand *cmd);
+    /** @brief Returns true while a command is pushed and executed. */
+    bool isPushing() const;
 signals:
     void invalidate();
+    /** @brief A command was pushed and executed, nullptr if it could have been merged with the previous one. */
+    void commandPushed(const QUndoCommand *command);
+private:
+    bool m_pushing;
 };
 
 class KdenliveDoc: public QObject
@@ -119,8 +130,10 @@ public:
     double projectDuration() const;
     /** @brief Returns the project file xml. */
     QDomDocument xmlSceneList(const QString &scene);
-    /** @brief Saves the project file xml to a file. */
-    bool saveSceneList(const QString &path, const QString &scene);
+    /** @brief Saves the project file xml to a file.
+     * @param root the folder clip paths are relative to
+     * @param replacements text replacements applied to the saved xml */
+    bool saveSceneList(const QString &path, const QString &root, const QMap<QString, QString> &replacements = QMap<QString, QString>());
     /** @brief Saves only the MLT xml to a file for preview rendering. */
     void saveMltPlaylist(const QString &fileName);
     void cacheImage(const QString &fileId, const QImage &img) const;
@@ -178,6 +191,16 @@ public:
     static int compositingMode();
     /** @brief Move project data files to new url */
     void moveProjectData(const QString &src, const QString &dest);
+    /** @brief The project is closed, its proxies and thumbnails in the shared cache can be evicted. */
+    void releaseSharedFiles();
+    /** @brief Returns true and schedules a new autosave if an autosave is already being written. */
+    bool deferAutoSave();
+    /** @brief Append the changes to the autosave journal, returns false if a full autosave is needed instead. */
+    bool autoSaveJournal();
+    /** @brief Delete the autosave journal once the project was saved, the next autosave is a full one. */
+    void resetAutoSaveJournal();
+    /** @brief Wait until the running autosave is written, needed before using the autosave file. */
+    void waitForAutoSave();
 
 private:
     QUrl m_url;
@@ -206,8 +229,6 @@ private:
     QMap<QString, QString> m_documentProperties;
     QMap<QString, QString> m_documentMetadata;
 
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
-
     /** @brief Creates a new project. */
     QDomDocument createEmptyDocument(int videotracks, int audiotracks);
     QDomDocument createEmptyDocument(const QList<TrackInfo> &tracks);
@@ -216,6 +237,36 @@ private:
     void updateProjectFolderPlacesEntry();
     /** @brief Only keep some backup files, delete some */
     void cleanupBackupFiles();
+    /** @brief Stream the project file xml to @param destination, returns false and sets @param error on failure */
+    bool writeSceneList(QIODevice *destination, const QString &root, const QMap<QString, QString> &replacements, QString &error);
+    /** @brief Returns the proxies and thumbnails of the project clips, the ones in the shared cache are referenced by this project */
+    QStringList sharedFiles() const;
+    /** @brief Returns the definitions of the custom effects used in the project, empty if there are none */
+    QString customEffectsXml() const;
+    /** @brief Write an autosave from the MLT xml @param snapshot of the timeline, called in a thread. Returns an error message on failure, the previous autosave is then kept */
+    static QString writeAutoSave(const QByteArray &snapshot, const QString &customEffects, QFile *destination);
+    /** @brief Watches the autosave being written in a thread */
+    QFutureWatcher<QString> m_autoSaveWatcher;
+    /** @brief True if an autosave was requested while another one was written */
+    bool m_autoSavePending;
+    /** @brief Time spent writing the current autosave, and in the GUI thread for its snapshot */
+    QElapsedTimer m_autoSaveTime;
+    qint64 m_autoSaveSnapshotTime;
+    /** @brief Journal records of the commands pushed since the last autosave */
+    QList<QJsonObject> m_journalRecords;
+    /** @brief False if changes were made that cannot be replayed from the journal */
+    bool m_journalValid;
+    /** @brief Number of records in the journal since the last checkpoint */
+    int m_journalSize;
+    /** @brief Number of journal records already contained in the autosave being written */
+    int m_journalSnapshot;
+    /** @brief Time since the last full autosave, invalid if it failed */
+    QElapsedTimer m_checkpointTime;
+    /** @brief Append the pending records to the autosave journal, returns false if a full autosave is needed */
+    bool writeJournal();
+    /** @brief Open the autosave file, returns false if there is none */
+    bool openAutoSave();
+    void updateModified(bool mod);
     /** @brief Load document properties from the xml file */
     void loadDocumentProperties();
     /** @brief update document properties to reflect a change in the current profile */
@@ -230,8 +281,8 @@ public slots:
      * @param mod (optional) true if the document has to be saved */
     void setModified(bool mod = true);
     void slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipList = QList<ProjectClip *>(), bool force = false, QUndoCommand *masterCommand = nullptr);
-    /** @brief Saves the current project at the autosave location.
-     * @description The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
+    /** @brief Saves the current project at the autosave location, always writing a full checkpoint.
+     * @description The autosave files are in ~/.kde/data/stalefiles/kdenlive/, see autoSaveJournal() for small changes */
     void slotAutoSave();
 
 private slots:
@@ -244,6 +295,8 @@ private slots:
     void slotSwitchProfile();
     /** @brief Check if we did a new action invalidating more recent undo items. */
     void checkPreviewStack();
+    void slotAutoSaveFinished();
+    void slotCommandPushed(const QUndoCommand *command);
 
 signals:
     void resetProjectList();
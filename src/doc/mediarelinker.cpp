@@ -0,0 +1,177 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mediarelinker.h"
+#include "kdenlive_debug.h"
+#include "project/filehasher.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QtConcurrent>
+
+struct MediaRelinker::HashCandidate
+{
+    typedef QString result_type;
+    MediaRelinker *relinker;
+    int total;
+    QString operator()(const QPair<QString, bool> &candidate) const
+    {
+        if (relinker->m_cancel.load() != 0) {
+            return QString();
+        }
+        // Projects created by older versions store an MD5 hash
+        const QString hash = candidate.second ? FileHasher::legacyHash(candidate.first) : FileHasher::instance()->hash(candidate.first);
+        emit relinker->progress(relinker->m_hashed.fetchAndAddRelaxed(1) + 1, total);
+        return hash;
+    }
+};
+
+MediaRelinker::MediaRelinker(const QString &searchFolder, QObject *parent)
+    : QObject(parent)
+    , m_searchFolder(searchFolder)
+    , m_cancel(0)
+    , m_hashed(0)
+{
+}
+
+int MediaRelinker::addRequest(const QString &fileName, qint64 size, const QString &hash, bool pattern)
+{
+    Request request;
+    request.fileName = QFileInfo(fileName).fileName();
+    request.size = size;
+    request.hash = hash;
+    request.pattern = pattern;
+    request.perfect = false;
+    m_requests << request;
+    return m_requests.count() - 1;
+}
+
+void MediaRelinker::cancel()
+{
+    m_cancel.store(1);
+}
+
+void MediaRelinker::crawl()
+{
+    int count = 0;
+    QDirIterator it(m_searchFolder, QDir::Files | QDir::Readable | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext() && m_cancel.load() == 0) {
+        const QString path = it.next();
+        const QFileInfo info = it.fileInfo();
+        m_sizeIndex.insert(info.size(), path);
+        // Prefer the match closest to the search folder
+        const QString name = info.fileName();
+        QHash<QString, QString>::iterator match = m_nameIndex.find(name);
+        if (match == m_nameIndex.end()) {
+            m_nameIndex.insert(name, path);
+        } else if (path.count(QLatin1Char('/')) < match.value().count(QLatin1Char('/'))) {
+            match.value() = path;
+        }
+        if (++count % 500 == 0) {
+            emit progress(count, 0);
+        }
+    }
+}
+
+QString MediaRelinker::searchPattern(const QString &fileName) const
+{
+    if (!fileName.contains(QLatin1Char('%'))) {
+        return QString();
+    }
+    const QString prefix = fileName.section(QLatin1Char('%'), 0, -2);
+    QHash<QString, QString>::const_iterator it = m_nameIndex.constBegin();
+    for (; it != m_nameIndex.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            return QFileInfo(it.value()).absoluteDir().absoluteFilePath(fileName);
+        }
+    }
+    return QString();
+}
+
+void MediaRelinker::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    crawl();
+    // Only read the files that have the size of a missing clip, each of them once
+    QList<QPair<QString, bool> > candidates;
+    QSet<QPair<qint64, bool> > sizes;
+    for (const Request &request : m_requests) {
+        if (request.size < 0 || request.hash.isEmpty()) {
+            continue;
+        }
+        const QPair<qint64, bool> size(request.size, FileHasher::isLegacyHash(request.hash));
+        if (!sizes.contains(size)) {
+            sizes.insert(size);
+            const QList<QString> paths = m_sizeIndex.values(request.size);
+            for (const QString &path : paths) {
+                candidates << qMakePair(path, size.second);
+            }
+        }
+    }
+    HashCandidate hasher;
+    hasher.relinker = this;
+    hasher.total = candidates.count();
+    const QList<QString> hashes = QtConcurrent::blockingMapped<QList<QString> >(candidates, hasher);
+    QHash<QPair<QString, bool>, QString> candidateHashes;
+    for (int i = 0; i < candidates.count(); ++i) {
+        candidateHashes.insert(candidates.at(i), hashes.at(i));
+    }
+    int found = 0;
+    for (Request &request : m_requests) {
+        if (request.pattern) {
+            request.result = searchPattern(request.fileName);
+        } else {
+            if (!request.hash.isEmpty()) {
+                const QList<QString> paths = m_sizeIndex.values(request.size);
+                const bool legacy = FileHasher::isLegacyHash(request.hash);
+                for (const QString &path : paths) {
+                    if (candidateHashes.value(qMakePair(path, legacy)) == request.hash) {
+                        request.result = path;
+                        request.perfect = true;
+                        break;
+                    }
+                }
+            }
+            if (request.result.isEmpty()) {
+                request.result = m_nameIndex.value(request.fileName);
+            }
+        }
+        if (!request.result.isEmpty()) {
+            found++;
+        }
+    }
+    qCDebug(KDENLIVE_LOG) << "// Relinked" << found << "of" << m_requests.count() << "files," << m_sizeIndex.count() << "indexed and" << candidates.count() << "compared in" << timer.elapsed() << "ms";
+}
+
+QString MediaRelinker::result(int request) const
+{
+    return m_requests.at(request).result;
+}
+
+bool MediaRelinker::isPerfectMatch(int request) const
+{
+    return m_requests.at(request).perfect;
+}
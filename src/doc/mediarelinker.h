@@ -0,0 +1,87 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEDIARELINKER_H
+#define MEDIARELINKER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+/**
+ * @class MediaRelinker
+ * @brief Finds the new location of several missing files in one crawl of a folder.
+ *
+ * The search folder is listed once to index its files by size and by name. The files
+ * whose size matches a missing clip are then hashed in parallel and compared to the
+ * hash stored in the project. Files that cannot be matched by content are searched
+ * by name.
+ */
+class MediaRelinker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MediaRelinker(const QString &searchFolder, QObject *parent = nullptr);
+    /** @brief Add a missing file, returns the index of its result.
+     *  @param fileName the missing file path, only its name is searched
+     *  @param size the file size or -1 if unknown
+     *  @param hash the kdenlive:file_hash of the clip, can be empty
+     *  @param pattern true to search a slideshow, whose name is a pattern like img_%03d.png */
+    int addRequest(const QString &fileName, qint64 size = -1, const QString &hash = QString(), bool pattern = false);
+    /** @brief Crawl the folder and resolve all requests, can be called from a worker thread. */
+    void run();
+    /** @brief Returns the path found for a request, empty if it was not found. */
+    QString result(int request) const;
+    /** @brief Returns true if the file found for a request has the same content as the missing one. */
+    bool isPerfectMatch(int request) const;
+
+public slots:
+    /** @brief Stop the search as soon as possible, the results found so far are kept. */
+    void cancel();
+
+private:
+    struct HashCandidate;
+    struct Request {
+        QString fileName;
+        qint64 size;
+        QString hash;
+        bool pattern;
+        QString result;
+        bool perfect;
+    };
+    QString m_searchFolder;
+    QList<Request> m_requests;
+    QMultiHash<qint64, QString> m_sizeIndex;
+    QHash<QString, QString> m_nameIndex;
+    QAtomicInt m_cancel;
+    QAtomicInt m_hashed;
+    void crawl();
+    QString searchPattern(const QString &fileName) const;
+
+signals:
+    /** @brief Emitted with the number of files indexed while crawling (total is 0), then while hashing. */
+    void progress(int done, int total);
+};
+
+#endif
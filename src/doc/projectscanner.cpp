@@ -0,0 +1,160 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "projectscanner.h"
+#include "kdenlive_debug.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+
+static bool fileExists(const QString &path)
+{
+    return QFile::exists(path);
+}
+
+ProjectScanner::ProjectScanner(const QUrl &url)
+    : m_url(url)
+    , m_valid(false)
+    , m_movit(false)
+{
+}
+
+QString ProjectScanner::rootPath(const QString &root) const
+{
+    // Same rules as the document validator and checker
+    QString dir = root;
+    if (dir.isEmpty() || dir == QLatin1String("$CURRENTPATH") || !QDir(dir).exists()) {
+        dir = m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    }
+    return QDir::cleanPath(dir) + QDir::separator();
+}
+
+void ProjectScanner::scan()
+{
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(m_url.toLocalFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QString currentPath = m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    const QStringList pathProperties {QStringLiteral("resource"), QStringLiteral("warp_resource"), QStringLiteral("luma"), QStringLiteral("kdenlive:proxy"), QStringLiteral("kdenlive:originalurl")};
+    QString root;
+    QStringList elements;
+    QString property;
+    QString value;
+    QSet<QString> paths;
+    QXmlStreamReader xml(&file);
+    while (!xml.atEnd()) {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (elements.isEmpty()) {
+                root = rootPath(attributes.value(QLatin1String("root")).toString());
+            }
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                if (attribute.value().contains(QLatin1String("movit."))) {
+                    m_movit = true;
+                }
+            }
+            if (xml.name() == QLatin1String("property") && !elements.isEmpty() && (elements.last() == QLatin1String("producer") || elements.last() == QLatin1String("transition"))) {
+                const QString name = attributes.value(QLatin1String("name")).toString();
+                if (pathProperties.contains(name)) {
+                    property = name;
+                    value.clear();
+                }
+            }
+            elements << xml.name().toString();
+            break;
+        }
+        case QXmlStreamReader::Characters:
+            if (!property.isEmpty()) {
+                value.append(xml.text());
+            } else if (xml.text().contains(QLatin1String("movit."))) {
+                m_movit = true;
+            }
+            break;
+        case QXmlStreamReader::EndElement:
+            elements.removeLast();
+            if (!property.isEmpty()) {
+                if (value.contains(QLatin1String("movit."))) {
+                    m_movit = true;
+                }
+                value.replace(QLatin1String("$CURRENTPATH"), currentPath);
+                if (!value.isEmpty() && (property != QLatin1String("kdenlive:proxy") || value.length() > 1)) {
+                    if (QFileInfo(value).isRelative()) {
+                        value.prepend(root);
+                    }
+                    paths << value;
+                    // Slideshows and slowmotion clips are checked on their folder or source file
+                    if (value.contains(QLatin1Char('?'))) {
+                        paths << value.section(QLatin1Char('?'), 0, 0);
+                    }
+                    if (value.contains(QStringLiteral("/.all.")) || value.contains(QLatin1Char('?')) || value.contains(QLatin1Char('%'))) {
+                        paths << QFileInfo(value).absolutePath();
+                    }
+                }
+                property.clear();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (xml.hasError()) {
+        qCDebug(KDENLIVE_LOG) << "// Project scan failed:" << xml.errorString();
+        return;
+    }
+    const qint64 parseTime = timer.elapsed();
+    // Network or sleeping disks answer slowly, query them in parallel
+    const QStringList list = paths.toList();
+    const QList<bool> found = QtConcurrent::blockingMapped<QList<bool> >(list, fileExists);
+    for (int i = 0; i < list.count(); ++i) {
+        m_files.insert(list.at(i), found.at(i));
+    }
+    m_valid = true;
+    qCDebug(KDENLIVE_LOG) << "// Project scan:" << parseTime << "ms to read," << timer.elapsed() - parseTime << "ms to check" << list.count() << "files";
+}
+
+bool ProjectScanner::isValid() const
+{
+    return m_valid;
+}
+
+bool ProjectScanner::usesMovit() const
+{
+    return !m_valid || m_movit;
+}
+
+bool ProjectScanner::exists(const QString &path) const
+{
+    QHash<QString, bool>::const_iterator it = m_files.constFind(path);
+    if (it != m_files.constEnd()) {
+        return it.value();
+    }
+    return QFile::exists(path);
+}
@@ -0,0 +1,58 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECTSCANNER_H
+#define PROJECTSCANNER_H
+
+#include <QHash>
+#include <QString>
+#include <QUrl>
+
+/**
+ * @class ProjectScanner
+ * @brief Streams a project file to find the files it uses, and checks which of them exist.
+ *
+ * The scan runs in a worker thread while the project document is parsed and validated,
+ * so that the missing clip checks do not have to wait for the file system.
+ */
+class ProjectScanner
+{
+public:
+    explicit ProjectScanner(const QUrl &url);
+    /** @brief Read the project file and check its files, can be called from a worker thread. */
+    void scan();
+    /** @brief Returns false if the scan did not complete. */
+    bool isValid() const;
+    /** @brief Returns true if the project uses some GPU (Movit) services. */
+    bool usesMovit() const;
+    /** @brief Returns true if a file exists, from the scan result when the path was checked. */
+    bool exists(const QString &path) const;
+
+private:
+    QUrl m_url;
+    bool m_valid;
+    bool m_movit;
+    QHash<QString, bool> m_files;
+    /** @brief Returns the directory used to resolve the relative paths of the project. */
+    QString rootPath(const QString &root) const;
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "projectserializer.h"
+
+#include <QIODevice>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <klocalizedstring.h>
+
+ProjectSerializer::ProjectSerializer(const QString &binPlaylistId)
+    : m_binPlaylistId(binPlaylistId)
+{
+}
+
+void ProjectSerializer::setCustomEffects(const QString &customEffects)
+{
+    m_customEffects = customEffects;
+}
+
+void ProjectSerializer::setReplacements(const QMap<QString, QString> &replacements)
+{
+    m_replacements = replacements;
+}
+
+const QString ProjectSerializer::errorString() const
+{
+    return m_errorString;
+}
+
+void ProjectSerializer::writeText(QXmlStreamWriter &writer, QString &text) const
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    if (!m_replacements.isEmpty() && !text.trimmed().isEmpty()) {
+        // Replacements were designed for the serialized document, where a text follows its opening tag
+        text.prepend(QLatin1Char('>'));
+        QMapIterator<QString, QString> i(m_replacements);
+        while (i.hasNext()) {
+            i.next();
+            text.replace(i.key(), i.value());
+        }
+        if (text.startsWith(QLatin1Char('>'))) {
+            text.remove(0, 1);
+        }
+    }
+    writer.writeCharacters(text);
+    text.clear();
+}
+
+void ProjectSerializer::writeProperty(QXmlStreamWriter &writer, const QString &name, const QString &value) const
+{
+    writer.writeStartElement(QStringLiteral("property"));
+    writer.writeAttribute(QStringLiteral("name"), name);
+    writer.writeCharacters(value);
+    writer.writeEndElement();
+}
+
+bool ProjectSerializer::write(QIODevice *source, QIODevice *destination)
+{
+    m_errorString.clear();
+    QXmlStreamReader reader(source);
+    QXmlStreamWriter writer(destination);
+    writer.setCodec("UTF-8");
+    // Text is buffered until the next tag since the reader may split it
+    QString text;
+    int depth = 0;
+    int mainTractorDepth = -1;
+    int binPlaylistDepth = -1;
+    bool binPlaylistDone = false;
+    bool hasTractor = false;
+    bool volumeReset = false;
+    bool hasContent = false;
+    while (!reader.atEnd()) {
+        QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::Characters && !reader.isCDATA()) {
+            text.append(reader.text());
+            continue;
+        }
+        writeText(writer, text);
+        switch (token) {
+        case QXmlStreamReader::StartDocument:
+            writer.writeStartDocument();
+            break;
+        case QXmlStreamReader::EndDocument:
+            writer.writeEndDocument();
+            break;
+        case QXmlStreamReader::DTD:
+            writer.writeDTD(reader.text().toString());
+            break;
+        case QXmlStreamReader::Comment:
+            writer.writeComment(reader.text().toString());
+            break;
+        case QXmlStreamReader::ProcessingInstruction:
+            writer.writeProcessingInstruction(reader.processingInstructionTarget().toString(), reader.processingInstructionData().toString());
+            break;
+        case QXmlStreamReader::EntityReference:
+            writer.writeEntityReference(reader.name().toString());
+            break;
+        case QXmlStreamReader::Characters:
+            writer.writeCDATA(reader.text().toString());
+            break;
+        case QXmlStreamReader::StartElement: {
+            const QStringRef name = reader.qualifiedName();
+            if (depth == 0 && name != QLatin1String("mlt")) {
+                reader.raiseError(i18n("Not an MLT document"));
+                break;
+            }
+            if (depth == 1) {
+                hasContent = true;
+            }
+            if (name == QLatin1String("property")) {
+                const QStringRef propertyName = reader.attributes().value(QStringLiteral("name"));
+                if (mainTractorDepth > -1 && !volumeReset && propertyName == QLatin1String("meta.volume")) {
+                    // Set playlist audio volume to 100%
+                    writeProperty(writer, QStringLiteral("meta.volume"), QStringLiteral("1"));
+                    reader.skipCurrentElement();
+                    volumeReset = true;
+                    break;
+                }
+                if (binPlaylistDepth == depth - 1 && !m_customEffects.isEmpty() && propertyName == QLatin1String("kdenlive:customeffects")) {
+                    // Replaced by the current custom effects
+                    reader.skipCurrentElement();
+                    break;
+                }
+            }
+            writer.writeStartElement(name.toString());
+            writer.writeAttributes(reader.attributes());
+            if (depth == 1 && name == QLatin1String("tractor") && !hasTractor) {
+                hasTractor = true;
+                mainTractorDepth = depth;
+            } else if (name == QLatin1String("playlist") && !binPlaylistDone && reader.attributes().value(QStringLiteral("id")) == m_binPlaylistId) {
+                binPlaylistDepth = depth;
+                binPlaylistDone = true;
+                if (!m_customEffects.isEmpty()) {
+                    // Embed the custom effects used in the project
+                    writeProperty(writer, QStringLiteral("kdenlive:customeffects"), m_customEffects);
+                }
+            }
+            depth++;
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            depth--;
+            if (depth == mainTractorDepth) {
+                mainTractorDepth = -1;
+            } else if (depth == binPlaylistDepth) {
+                binPlaylistDepth = -1;
+            }
+            writer.writeEndElement();
+            break;
+        default:
+            break;
+        }
+        if (writer.hasError()) {
+            m_errorString = i18n("Cannot write project data");
+            return false;
+        }
+    }
+    if (reader.hasError()) {
+        m_errorString = reader.errorString();
+        return false;
+    }
+    if (!hasContent) {
+        m_errorString = i18n("Scene list is empty");
+        return false;
+    }
+    return true;
+}
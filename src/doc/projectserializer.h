@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECTSERIALIZER_H
+#define PROJECTSERIALIZER_H
+
+#include <QMap>
+#include <QString>
+
+class QIODevice;
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+/**
+ * @class ProjectSerializer
+ * @brief Copies the MLT xml of a project to its destination, applying the Kdenlive changes on the way.
+ *
+ * The xml is streamed element by element, so that memory use only depends on the nesting depth
+ * of the document and not on its size.
+ */
+class ProjectSerializer
+{
+public:
+    explicit ProjectSerializer(const QString &binPlaylistId);
+    /** @brief Set the custom effects definitions (a customeffects xml document) to embed in the bin playlist. */
+    void setCustomEffects(const QString &customEffects);
+    /** @brief Set text replacements applied to element texts, a leading '>' matches the start of a text. */
+    void setReplacements(const QMap<QString, QString> &replacements);
+    /** @brief Copy the xml from @param source to @param destination, returns false if the source is not a valid MLT document. */
+    bool write(QIODevice *source, QIODevice *destination);
+    const QString errorString() const;
+
+private:
+    QString m_binPlaylistId;
+    QString m_customEffects;
+    QMap<QString, QString> m_replacements;
+    QString m_errorString;
+    /** @brief Write text pending in @param text, applying replacements */
+    void writeText(QXmlStreamWriter &writer, QString &text) const;
+    void writeProperty(QXmlStreamWriter &writer, const QString &name, const QString &value) const;
+};
+
+#endif
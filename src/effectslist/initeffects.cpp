@@ -24,10 +24,18 @@
 #include "mainwindow.h"
 
 #include "kdenlive_debug.h"
+#include <config-kdenlive.h>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QDir>
+#include <QRegExp>
+#include <QSaveFile>
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 #include <klocalizedstring.h>
 #include <locale>
@@ -35,6 +43,113 @@
 #include <xlocale.h>
 #endif
 
+// Version of the effect catalog cache file, increase when its content changes
+static const qint32 effectCatalogVersion = 1;
+
+static QDomDocument readXmlFile(const QString &path)
+{
+    QDomDocument doc;
+    QFile file(path);
+    doc.setContent(&file, false);
+    return doc;
+}
+
+static QStringList xmlFiles(const QStringList &folders)
+{
+    QStringList files;
+    for (const QString &folder : folders) {
+        QDir directory(folder);
+        const QStringList fileList = directory.entryList(QStringList() << QStringLiteral("*.xml"), QDir::Files);
+        for (const QString &file : fileList) {
+            files << directory.absoluteFilePath(file);
+        }
+    }
+    return files;
+}
+
+/** @brief The effects are parsed with different numeric locales, each one has its own catalog file. */
+static QString effectCatalogPath(const QString &locale)
+{
+    QString name = locale.isEmpty() ? QStringLiteral("default") : locale;
+    name.replace(QRegExp(QStringLiteral("[^A-Za-z0-9_-]")), QStringLiteral("_"));
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/effectcatalog-") + name;
+}
+
+/** @brief Identifies the MLT services, effect files and locale that the effect lists are built from. */
+static QByteArray effectCatalogKey(const QString &locale, const QList<QStringList> &services, const QStringList &files)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(KDENLIVE_VERSION);
+    hash.addData(mlt_version_get_string());
+    hash.addData(QStringLiteral("\n%1\n%2\n%3\n%4\n").arg(locale, QLocale().name(), QString(QLocale().decimalPoint()), KLocalizedString::languages().join(QLatin1Char(','))).toUtf8());
+    for (const QStringList &names : services) {
+        hash.addData(names.join(QLatin1Char(',')).toUtf8() + '\n');
+    }
+    for (const QString &file : files) {
+        QFileInfo info(file);
+        hash.addData(QStringLiteral("%1:%2:%3\n").arg(info.absoluteFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch()).toUtf8());
+    }
+    return hash.result();
+}
+
+static QList<EffectsList *> effectCatalogLists()
+{
+    return QList<EffectsList *>() << &MainWindow::transitions << &MainWindow::videoEffects << &MainWindow::audioEffects << &MainWindow::customEffects;
+}
+
+static bool loadEffectCatalog(const QString &locale, const QByteArray &key)
+{
+    QFile file(effectCatalogPath(locale));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+    qint32 version;
+    QByteArray storedKey;
+    in >> version >> storedKey;
+    if (in.status() != QDataStream::Ok || version != effectCatalogVersion || storedKey != key) {
+        return false;
+    }
+    const QList<EffectsList *> lists = effectCatalogLists();
+    QList<QDomDocument> docs;
+    for (int i = 0; i < lists.count(); ++i) {
+        QByteArray data;
+        in >> data;
+        QDomDocument doc;
+        if (in.status() != QDataStream::Ok || !doc.setContent(qUncompress(data), false)) {
+            return false;
+        }
+        docs << doc;
+    }
+    for (int i = 0; i < lists.count(); ++i) {
+        lists.at(i)->clearList();
+        QDomElement effect = docs.at(i).documentElement().firstChildElement();
+        while (!effect.isNull()) {
+            lists.at(i)->append(effect);
+            effect = effect.nextSiblingElement();
+        }
+    }
+    return true;
+}
+
+static void saveEffectCatalog(const QString &locale, const QByteArray &key)
+{
+    QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    QSaveFile file(effectCatalogPath(locale));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write effect catalog" << file.fileName();
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+    out << effectCatalogVersion << key;
+    for (EffectsList *list : effectCatalogLists()) {
+        out << qCompress(list->toByteArray(-1));
+    }
+    file.commit();
+}
+
 // static
 void initEffects::refreshLumas()
 {
@@ -131,10 +246,6 @@ QDomDocument initEffects::getUsedCustomEffects(const QMap<QString, QString> &eff
 bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository, const QString &locale)
 {
     bool movit = false;
-    QStringList::Iterator more;
-    QStringList::Iterator it;
-    QStringList fileList;
-    QString itemName;
 
     if (!repository) {
         //qCDebug(KDENLIVE_LOG) << "Repository didn't finish initialisation" ;
@@ -195,6 +306,27 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
     }
     delete transitions;
 
+    // Get list of installed luma files
+    refreshLumas();
+
+    // The lists only change with MLT, the effect files or the locale, reuse the previous ones
+    QElapsedTimer timer;
+    timer.start();
+    const QStringList transitionFiles = xmlFiles(QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("transitions"), QStandardPaths::LocateDirectory));
+    const QStringList effectFiles = xmlFiles(QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("effects"), QStandardPaths::LocateDirectory));
+    const QString transitionBlacklist = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("blacklisted_transitions.txt"));
+    const QString effectBlacklist = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("blacklisted_effects.txt"));
+    const QByteArray catalogKey = effectCatalogKey(locale, QList<QStringList>() << filtersList << producersList << transitionsItemList,
+                                                   QStringList() << transitionFiles << effectFiles << transitionBlacklist << effectBlacklist);
+    if (loadEffectCatalog(locale, catalogKey)) {
+        qCDebug(KDENLIVE_LOG) << "// Effect catalog loaded from cache in" << timer.elapsed() << "ms";
+        return movit;
+    }
+
+    // Parse the XML files in worker threads while MLT metadata is collected, MLT repository is only queried from this thread
+    QFuture<QDomDocument> transitionDocs = QtConcurrent::mapped(transitionFiles, readXmlFile);
+    QFuture<QDomDocument> effectDocs = QtConcurrent::mapped(effectFiles, readXmlFile);
+
     // Create structure holding all transitions descriptions so that if an XML file has no description, we take it from MLT
     QMap<QString, QString> transDescriptions;
     foreach (const QString &transname, transitionsItemList) {
@@ -210,25 +342,14 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
     }
     transitionsItemList.sort();
 
-    // Get list of installed luma files
-    refreshLumas();
-
     // Parse xml transition files
-    QStringList direc = QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("transitions"), QStandardPaths::LocateDirectory);
-    // Iterate through effects directories to parse all XML files.
-    for (more = direc.begin(); more != direc.end(); ++more) {
-        QDir directory(*more);
-        QStringList filter;
-        filter << QStringLiteral("*.xml");
-        fileList = directory.entryList(filter, QDir::Files);
-        for (it = fileList.begin(); it != fileList.end(); ++it) {
-            itemName = directory.absoluteFilePath(*it);
-            parseTransitionFile(&MainWindow::transitions, itemName, repository, transitionsItemList, transDescriptions);
-        }
+    transitionDocs.waitForFinished();
+    for (int i = 0; i < transitionFiles.count(); ++i) {
+        parseTransitionFile(&MainWindow::transitions, transitionFiles.at(i), repository, transitionsItemList, transDescriptions, transitionDocs.resultAt(i));
     }
 
     // Remove blacklisted transitions from the list.
-    QFile file(QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("blacklisted_transitions.txt")));
+    QFile file(transitionBlacklist);
     if (file.open(QIODevice::ReadOnly)) {
         QTextStream in(&file);
         while (!in.atEnd()) {
@@ -247,7 +368,7 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
     // Remove blacklisted effects from the filters list.
     QStringList mltFiltersList = filtersList;
     QStringList mltBlackList;
-    QFile file2(QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("blacklisted_effects.txt")));
+    QFile file2(effectBlacklist);
     if (file2.open(QIODevice::ReadOnly)) {
         QTextStream in(&file2);
         while (!in.atEnd()) {
@@ -327,21 +448,13 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
         }
     }
 
-    // Set the directories to look into for effects.
-    direc = QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("effects"), QStandardPaths::LocateDirectory);
-    // Iterate through effects directories to parse all XML files.
-    for (more = direc.begin(); more != direc.end(); ++more) {
-        QDir directory(*more);
-        QStringList filter;
-        filter << QStringLiteral("*.xml");
-        fileList = directory.entryList(filter, QDir::Files);
-        for (it = fileList.begin(); it != fileList.end(); ++it) {
-            itemName = directory.absoluteFilePath(*it);
-            parseEffectFile(&MainWindow::customEffects,
-                            &MainWindow::audioEffects,
-                            &MainWindow::videoEffects,
-                            itemName, filtersList, producersList, repository, effectDescriptions);
-        }
+    // Parse xml effect files
+    effectDocs.waitForFinished();
+    for (int i = 0; i < effectFiles.count(); ++i) {
+        parseEffectFile(&MainWindow::customEffects,
+                        &MainWindow::audioEffects,
+                        &MainWindow::videoEffects,
+                        effectFiles.at(i), filtersList, producersList, repository, effectDescriptions, effectDocs.resultAt(i));
     }
 
     // Create custom effects
@@ -382,6 +495,8 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
         MainWindow::videoEffects.append(effect);
     }
 
+    saveEffectCatalog(locale, catalogKey);
+    qCDebug(KDENLIVE_LOG) << "// Effect catalog built in" << timer.elapsed() << "ms";
     return movit;
 }
 
@@ -434,12 +549,11 @@ void initEffects::parseCustomEffectsFile()
 }
 
 // static
-void initEffects::parseEffectFile(EffectsList *customEffectList, EffectsList *audioEffectList, EffectsList *videoEffectList, const QString &name, const QStringList &filtersList, const QStringList &producersList, std::unique_ptr<Mlt::Repository> &repository, const QMap<QString, QString> &effectDescriptions)
+void initEffects::parseEffectFile(EffectsList *customEffectList, EffectsList *audioEffectList, EffectsList *videoEffectList, const QString &name, const QStringList &filtersList, const QStringList &producersList, std::unique_ptr<Mlt::Repository> &repository, const QMap<QString, QString> &effectDescriptions, QDomDocument doc)
 {
-    QDomDocument doc;
-    QFile file(name);
-    doc.setContent(&file, false);
-    file.close();
+    if (doc.isNull()) {
+        doc = readXmlFile(name);
+    }
     QDomElement documentElement;
     QDomNodeList effects;
     QDomElement base = doc.documentElement();
@@ -908,17 +1022,11 @@ QDomElement initEffects::quickParameterFill(QDomDocument &doc, const QString &na
 }
 
 // static
-void initEffects::parseTransitionFile(EffectsList *transitionList, const QString &name, std::unique_ptr<Mlt::Repository> &repository, const QStringList &installedTransitions, const QMap<QString, QString> &effectDescriptions)
+void initEffects::parseTransitionFile(EffectsList *transitionList, const QString &name, std::unique_ptr<Mlt::Repository> &repository, const QStringList &installedTransitions, const QMap<QString, QString> &effectDescriptions, QDomDocument doc)
 {
-    QFile file(name);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return;
+    if (doc.isNull()) {
+        doc = readXmlFile(name);
     }
-    QDomDocument doc;
-    QTextStream out(&file);
-    QString fileContent = out.readAll();
-    file.close();
-    doc.setContent(fileContent, false);
     QDomElement documentElement;
     QDomNodeList effects;
     QDomElement base = doc.documentElement();
@@ -41,7 +41,8 @@ public:
      *
      * It checks for all available effects and transitions, removes blacklisted
      * ones, calls fillTransitionsList() and parseEffectFile() to fill the lists
-     * (with sorted, unique items) and then fills the global lists. */
+     * (with sorted, unique items) and then fills the global lists. The lists are
+     * cached on disk and reused while MLT, the effect files and the locale do not change. */
     static bool parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository, const QString &locale = QString());
     static void refreshLumas();
     static QDomDocument createDescriptionFromMlt(std::unique_ptr<Mlt::Repository> &repository, const QString &type, const QString &name);
@@ -82,14 +83,17 @@ public:
      * @param name file name
      * @param filtersList list of filters in the MLT repository
      * @param producersList list of producers in the MLT repository
-     * @param repository MLT repository */
+     * @param repository MLT repository
+     * @param doc content of the file if it was already parsed */
     static void parseEffectFile(EffectsList *customEffectList,
                                 EffectsList *audioEffectList,
                                 EffectsList *videoEffectList,
                                 const QString &name, const QStringList &filtersList,
                                 const QStringList &producersList,
-                                std::unique_ptr<Mlt::Repository> &repository, const QMap<QString, QString> &effectDescriptions);
-    static void parseTransitionFile(EffectsList *transitionList, const QString &name, std::unique_ptr<Mlt::Repository> &repository, const QStringList &installedTransitions, const QMap<QString, QString> &effectDescriptions);
+                                std::unique_ptr<Mlt::Repository> &repository, const QMap<QString, QString> &effectDescriptions,
+                                QDomDocument doc = QDomDocument());
+    static void parseTransitionFile(EffectsList *transitionList, const QString &name, std::unique_ptr<Mlt::Repository> &repository, const QStringList &installedTransitions, const QMap<QString, QString> &effectDescriptions,
+                                    QDomDocument doc = QDomDocument());
 
     /** @brief Reloads information about custom effects. */
     static void parseCustomEffectsFile();
@@ -48,6 +48,8 @@
 CollapsibleEffect::CollapsibleEffect(const QDomElement &effect, const QDomElement &original_effect, const ItemInfo &info, EffectMetaInfo *metaInfo, bool canMoveUp, bool lastEffect, QWidget *parent) :
     AbstractCollapsibleWidget(parent),
     m_paramWidget(nullptr),
+    m_metaInfo(metaInfo),
+    m_position(0),
     m_effect(effect),
     m_itemInfo(info),
     m_original_effect(original_effect),
@@ -117,35 +119,7 @@ CollapsibleEffect::CollapsibleEffect(const QDomElement &effect, const QDomElemen
         //qCDebug(KDENLIVE_LOG)<<"// Could not create effect";
         return;
     }
-    QString effectname = namenode.text().isEmpty() ? QString() : i18n(namenode.text().toUtf8().data());
-    if (m_regionEffect) {
-        effectname.append(':' + QUrl(EffectsList::parameter(m_effect, QStringLiteral("resource"))).fileName());
-    }
-
-    // Create color thumb
-    QPixmap pix(iconSize);
-    QColor col(m_effect.attribute(QStringLiteral("effectcolor")));
-    QFont ft = font();
-    ft.setBold(true);
-    bool isAudio = m_effect.attribute(QStringLiteral("type")) == QLatin1String("audio");
-    if (isAudio) {
-        pix.fill(Qt::transparent);
-    } else {
-        pix.fill(col);
-    }
-    QPainter p(&pix);
-    if (isAudio) {
-        p.setPen(Qt::NoPen);
-        p.setBrush(col);
-        p.drawEllipse(pix.rect());
-        p.setPen(QPen());
-    }
-    p.setFont(ft);
-    p.drawText(pix.rect(), Qt::AlignCenter, effectname.at(0));
-    p.end();
-    m_iconPix = pix;
-    m_colorIcon->setPixmap(pix);
-    title->setText(effectname);
+    setupTitle();
 
     if (!m_regionEffect) {
         if (m_info.groupIndex == -1) {
@@ -170,18 +144,6 @@ CollapsibleEffect::CollapsibleEffect(const QDomElement &effect, const QDomElemen
     connect(buttonDown, &QAbstractButton::clicked, this, &CollapsibleEffect::slotEffectDown);
     connect(buttonDel, &QAbstractButton::clicked, this, &CollapsibleEffect::slotDeleteEffect);
 
-    Q_FOREACH (QSpinBox *sp, findChildren<QSpinBox *>()) {
-        sp->installEventFilter(this);
-        sp->setFocusPolicy(Qt::StrongFocus);
-    }
-    Q_FOREACH (KComboBox *cb, findChildren<KComboBox *>()) {
-        cb->installEventFilter(this);
-        cb->setFocusPolicy(Qt::StrongFocus);
-    }
-    Q_FOREACH (QProgressBar *cb, findChildren<QProgressBar *>()) {
-        cb->installEventFilter(this);
-        cb->setFocusPolicy(Qt::StrongFocus);
-    }
     m_animation = new QTimeLine(200, this); //duration matches to match kmessagewidget
     connect(m_animation, &QTimeLine::valueChanged, this, &CollapsibleEffect::setWidgetHeight);
     connect(m_animation, &QTimeLine::stateChanged, this, [this](QTimeLine::State state) {
@@ -200,6 +162,86 @@ CollapsibleEffect::~CollapsibleEffect()
     delete m_menu;
 }
 
+void CollapsibleEffect::setupTitle()
+{
+    QDomElement namenode = m_effect.firstChildElement(QStringLiteral("name"));
+    QString effectname = namenode.text().isEmpty() ? QString() : i18n(namenode.text().toUtf8().data());
+    if (m_regionEffect) {
+        effectname.append(':' + QUrl(EffectsList::parameter(m_effect, QStringLiteral("resource"))).fileName());
+    }
+
+    // Create color thumb
+    QPixmap pix(buttonUp->iconSize());
+    QColor col(m_effect.attribute(QStringLiteral("effectcolor")));
+    QFont ft = font();
+    ft.setBold(true);
+    bool isAudio = m_effect.attribute(QStringLiteral("type")) == QLatin1String("audio");
+    if (isAudio) {
+        pix.fill(Qt::transparent);
+    } else {
+        pix.fill(col);
+    }
+    QPainter p(&pix);
+    if (isAudio) {
+        p.setPen(Qt::NoPen);
+        p.setBrush(col);
+        p.drawEllipse(pix.rect());
+        p.setPen(QPen());
+    }
+    p.setFont(ft);
+    p.drawText(pix.rect(), Qt::AlignCenter, effectname.at(0));
+    p.end();
+    m_iconPix = pix;
+    m_colorIcon->setPixmap(pix);
+    title->setText(effectname);
+}
+
+void CollapsibleEffect::reuse(const QDomElement &effect, const QDomElement &original_effect, const ItemInfo &info, EffectMetaInfo *metaInfo, bool canMoveUp, bool lastEffect)
+{
+    m_animation->stop();
+    widgetFrame->setMinimumHeight(0);
+    widgetFrame->setMaximumHeight(QWIDGETSIZE_MAX);
+    m_original_effect = original_effect;
+    m_metaInfo = metaInfo;
+    m_info.fromString(effect.attribute(QStringLiteral("kdenlive_info")));
+    if (m_isMovable) {
+        buttonUp->setEnabled(canMoveUp);
+        buttonDown->setEnabled(!lastEffect);
+    }
+    if (m_paramWidget && m_paramWidget->updateValues(effect, info)) {
+        // Same parameters, the values were updated in place
+        m_effect = effect;
+        m_itemInfo = info;
+        connect(m_paramWidget, &ParameterContainer::disableCurrentFilter, this, &CollapsibleEffect::slotDisableEffect);
+        connect(m_paramWidget, &ParameterContainer::importKeyframes, this, &CollapsibleEffect::importKeyframes);
+        connectParamWidget();
+        if (collapseButton->isEnabled()) {
+            widgetFrame->setVisible(!m_info.isCollapsed);
+            collapseButton->setArrowType(m_info.isCollapsed ? Qt::RightArrow : Qt::DownArrow);
+        }
+    } else {
+        m_effect = effect;
+        setupWidget(info, metaInfo);
+    }
+    setupTitle();
+    bool disable = m_effect.attribute(QStringLiteral("disable")) == QLatin1String("1");
+    title->setEnabled(!disable);
+    m_enabledButton->setActive(disable);
+    widgetFrame->setEnabled(!disable || !KdenliveSettings::disable_effect_parameters());
+}
+
+void CollapsibleEffect::recycle()
+{
+    m_animation->stop();
+    setActive(false);
+    if (m_paramWidget) {
+        m_paramWidget->connectMonitor(false);
+        disconnect(m_paramWidget, nullptr, this, nullptr);
+    }
+    // Drop the connections made by the stack and to the parameter widget
+    disconnect(this, nullptr, nullptr, nullptr);
+}
+
 void CollapsibleEffect::setWidgetHeight(qreal value)
 {
     widgetFrame->setFixedHeight(m_paramWidget->contentHeight() * value);
@@ -285,10 +327,7 @@ QDomElement CollapsibleEffect::effectForSave() const
 {
     QDomElement effect = m_effect.cloneNode().toElement();
     effect.removeAttribute(QStringLiteral("kdenlive_ix"));
-    if (m_paramWidget) {
-        int in = m_paramWidget->range().x();
-        EffectsController::offsetKeyframes(in, effect);
-    }
+    EffectsController::offsetKeyframes(inPoint(), effect);
     return effect;
 }
 
@@ -306,6 +345,10 @@ void CollapsibleEffect::setActive(bool activate)
 {
     decoframe->setProperty("active", activate);
     decoframe->setStyleSheet(decoframe->styleSheet());
+    if (activate) {
+        // The selected effect may need an on monitor scene, so its parameters are always built
+        createParamWidget();
+    }
     if (m_paramWidget) {
         m_paramWidget->connectMonitor(activate);
     }
@@ -390,10 +433,7 @@ void CollapsibleEffect::slotSaveEffect()
     effect.removeAttribute(QStringLiteral("kdenlive_ix"));
     effect.setAttribute(QStringLiteral("id"), name);
     effect.setAttribute(QStringLiteral("type"), QStringLiteral("custom"));
-    if (m_paramWidget) {
-        int in = m_paramWidget->range().x();
-        EffectsController::offsetKeyframes(in, effect);
-    }
+    EffectsController::offsetKeyframes(inPoint(), effect);
     QDomElement effectname = effect.firstChildElement(QStringLiteral("name"));
     effect.removeChild(effectname);
     effectname = doc.createElement(QStringLiteral("name"));
@@ -421,6 +461,9 @@ void CollapsibleEffect::slotResetEffect()
 void CollapsibleEffect::slotSwitch()
 {
     bool expand = !widgetFrame->isVisible();
+    if (expand) {
+        createParamWidget();
+    }
     widgetFrame->setVisible(true);
     slotShow(expand);
     m_animation->setDirection(expand ? QTimeLine::Forward : QTimeLine::Backward);
@@ -531,6 +574,8 @@ void CollapsibleEffect::setupWidget(const ItemInfo &info, EffectMetaInfo *metaIn
     }
     delete m_paramWidget;
     m_paramWidget = nullptr;
+    m_itemInfo = info;
+    m_metaInfo = metaInfo;
 
     if (m_effect.attribute(QStringLiteral("tag")) == QLatin1String("region")) {
         m_regionEffect = true;
@@ -553,22 +598,39 @@ void CollapsibleEffect::setupWidget(const ItemInfo &info, EffectMetaInfo *metaIn
             vbox->addWidget(coll);
             //p = new ParameterContainer(effects.at(i).toElement(), info, isEffect, container);
         }
-    } else {
-        m_paramWidget = new ParameterContainer(m_effect, info, metaInfo, widgetFrame);
-        connect(m_paramWidget, &ParameterContainer::disableCurrentFilter, this, &CollapsibleEffect::slotDisableEffect);
-        connect(m_paramWidget, &ParameterContainer::importKeyframes, this, &CollapsibleEffect::importKeyframes);
-        if (m_effect.firstChildElement(QStringLiteral("parameter")).isNull()) {
-            // Effect has no parameter, don't allow expand
-            collapseButton->setEnabled(false);
-            collapseButton->setVisible(false);
-            widgetFrame->setVisible(false);
-        }
+        connectParamWidget();
+    } else if (m_effect.firstChildElement(QStringLiteral("parameter")).isNull()) {
+        // Effect has no parameter, don't allow expand
+        collapseButton->setEnabled(false);
+        collapseButton->setVisible(false);
+        widgetFrame->setVisible(false);
     }
     if (collapseButton->isEnabled() && m_info.isCollapsed) {
         widgetFrame->setVisible(false);
         collapseButton->setArrowType(Qt::RightArrow);
+    } else {
+        if (collapseButton->isEnabled()) {
+            widgetFrame->setVisible(true);
+            collapseButton->setArrowType(Qt::DownArrow);
+        }
+        createParamWidget();
+    }
+}
 
+void CollapsibleEffect::createParamWidget()
+{
+    if (m_paramWidget || m_effect.isNull()) {
+        return;
     }
+    m_paramWidget = new ParameterContainer(m_effect, m_itemInfo, m_metaInfo, widgetFrame);
+    connect(m_paramWidget, &ParameterContainer::disableCurrentFilter, this, &CollapsibleEffect::slotDisableEffect);
+    connect(m_paramWidget, &ParameterContainer::importKeyframes, this, &CollapsibleEffect::importKeyframes);
+    connectParamWidget();
+    emit syncEffectsPos(m_position);
+}
+
+void CollapsibleEffect::connectParamWidget()
+{
     connect(m_paramWidget, &ParameterContainer::parameterChanged, this, &CollapsibleEffect::parameterChanged);
 
     connect(m_paramWidget, &ParameterContainer::startFilterJob, this, &CollapsibleEffect::startFilterJob);
@@ -577,6 +639,27 @@ void CollapsibleEffect::setupWidget(const ItemInfo &info, EffectMetaInfo *metaIn
     connect(m_paramWidget, &ParameterContainer::checkMonitorPosition, this, &CollapsibleEffect::checkMonitorPosition);
     connect(m_paramWidget, &ParameterContainer::seekTimeline, this, &CollapsibleEffect::seekTimeline);
     connect(m_paramWidget, &ParameterContainer::importClipKeyframes, this, &CollapsibleEffect::prepareImportClipKeyframes);
+
+    Q_FOREACH (QSpinBox *sp, widgetFrame->findChildren<QSpinBox *>()) {
+        sp->installEventFilter(this);
+        sp->setFocusPolicy(Qt::StrongFocus);
+    }
+    Q_FOREACH (KComboBox *cb, widgetFrame->findChildren<KComboBox *>()) {
+        cb->installEventFilter(this);
+        cb->setFocusPolicy(Qt::StrongFocus);
+    }
+    Q_FOREACH (QProgressBar *cb, widgetFrame->findChildren<QProgressBar *>()) {
+        cb->installEventFilter(this);
+        cb->setFocusPolicy(Qt::StrongFocus);
+    }
+}
+
+int CollapsibleEffect::inPoint() const
+{
+    if (m_paramWidget) {
+        return m_paramWidget->range().x();
+    }
+    return m_itemInfo.cropStart.frames(KdenliveSettings::project_fps());
 }
 
 void CollapsibleEffect::slotDisableEffect(bool disable)
@@ -594,7 +677,9 @@ bool CollapsibleEffect::isGroup() const
 
 void CollapsibleEffect::updateTimecodeFormat()
 {
-    m_paramWidget->updateTimecodeFormat();
+    if (m_paramWidget) {
+        m_paramWidget->updateTimecodeFormat();
+    }
     if (!m_subParamWidgets.isEmpty()) {
         // we have a group
         for (int i = 0; i < m_subParamWidgets.count(); ++i) {
@@ -611,6 +696,7 @@ void CollapsibleEffect::slotUpdateRegionEffectParams(const QDomElement &/*old*/,
 
 void CollapsibleEffect::slotSyncEffectsPos(int pos)
 {
+    m_position = pos;
     emit syncEffectsPos(pos);
 }
 
@@ -620,9 +706,14 @@ void CollapsibleEffect::dragEnterEvent(QDragEnterEvent *event)
         frame->setProperty("target", true);
         frame->setStyleSheet(frame->styleSheet());
         event->acceptProposedAction();
-    } else if (m_paramWidget->doesAcceptDrops() && event->mimeData()->hasFormat(QStringLiteral("kdenlive/geometry")) && event->source()->objectName() != QStringLiteral("ParameterContainer")) {
-        event->setDropAction(Qt::CopyAction);
-        event->setAccepted(true);
+    } else if (event->mimeData()->hasFormat(QStringLiteral("kdenlive/geometry")) && event->source()->objectName() != QStringLiteral("ParameterContainer")) {
+        createParamWidget();
+        if (m_paramWidget->doesAcceptDrops()) {
+            event->setDropAction(Qt::CopyAction);
+            event->setAccepted(true);
+        } else {
+            QWidget::dragEnterEvent(event);
+        }
     } else {
         QWidget::dragEnterEvent(event);
     }
@@ -737,11 +828,16 @@ MonitorSceneType CollapsibleEffect::needsMonitorEffectScene() const
 
 void CollapsibleEffect::setRange(int inPoint, int outPoint)
 {
-    m_paramWidget->setRange(inPoint, outPoint);
+    m_itemInfo.cropStart = GenTime(inPoint, KdenliveSettings::project_fps());
+    m_itemInfo.cropDuration = GenTime(outPoint - inPoint, KdenliveSettings::project_fps());
+    if (m_paramWidget) {
+        m_paramWidget->setRange(inPoint, outPoint);
+    }
 }
 
 void CollapsibleEffect::setKeyframes(const QString &tag, const QString &keyframes)
 {
+    createParamWidget();
     m_paramWidget->setKeyframes(tag, keyframes);
 }
 
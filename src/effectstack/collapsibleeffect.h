@@ -47,6 +47,10 @@ public:
     QLabel *title;
 
     void setupWidget(const ItemInfo &info, EffectMetaInfo *metaInfo);
+    /** @brief Display another effect of the same type in this widget, keeping the parameter widgets when possible. */
+    void reuse(const QDomElement &effect, const QDomElement &original_effect, const ItemInfo &info, EffectMetaInfo *metaInfo, bool canMoveUp, bool lastEffect);
+    /** @brief Deactivate the widget and drop all its connections before it is kept for reuse. */
+    void recycle();
     void updateTimecodeFormat();
     void setActive(bool activate) Q_DECL_OVERRIDE;
     /** @brief Install event filter so that scrolling with mouse wheel does not change parameter value. */
@@ -112,7 +116,11 @@ private slots:
     void prepareImportClipKeyframes();
 
 private:
+    /** @brief The parameter widgets, only created when the effect is expanded or selected. */
     ParameterContainer *m_paramWidget;
+    EffectMetaInfo *m_metaInfo;
+    /** @brief Last timeline position, passed to the parameter widgets when they are created. */
+    int m_position;
     QList<CollapsibleEffect *> m_subParamWidgets;
     QDomElement m_effect;
     ItemInfo m_itemInfo;
@@ -132,6 +140,13 @@ private:
     QPixmap m_iconPix;
     /** @brief Check if collapsed state changed and inform MLT. */
     void updateCollapsedState();
+    /** @brief Set the effect name and color icon in the title bar. */
+    void setupTitle();
+    /** @brief Create the parameter widgets if they were not built yet. */
+    void createParamWidget();
+    void connectParamWidget();
+    /** @brief Returns the clip in point used to offset keyframes. */
+    int inPoint() const;
 
 protected:
     void mouseDoubleClickEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -42,6 +42,9 @@
 #include <QDrag>
 #include <QMimeData>
 
+// Maximum number of unused effect widgets kept for reuse
+static const int maxRecycledEffects = 20;
+
 EffectStackView2::EffectStackView2(Monitor *projectMonitor, QWidget *parent) :
     QWidget(parent),
     m_clipref(nullptr),
@@ -302,6 +305,7 @@ void EffectStackView2::setupListView()
     m_draggedEffect = nullptr;
     m_draggedGroup = nullptr;
     disconnect(m_effectMetaInfo.monitor, &Monitor::renderPosition, this, &EffectStackView2::slotRenderPos);
+    recycleEffects();
     QWidget *view = m_effect->container->takeWidget();
     if (view) {
         /*QList<CollapsibleEffect *> allChildren = view->findChildren<CollapsibleEffect *>();
@@ -400,8 +404,25 @@ void EffectStackView2::setupListView()
         if (i == 0 || m_currentEffectList.at(i - 1).attribute(QStringLiteral("id")) == QLatin1String("speed")) {
             canMoveUp = false;
         }
-        CollapsibleEffect *currentEffect = new CollapsibleEffect(d, m_currentEffectList.at(i), info, &m_effectMetaInfo, canMoveUp, i == effectsCount - 1, view);
+        CollapsibleEffect *currentEffect = nullptr;
+        if (d.attribute(QStringLiteral("tag")) != QLatin1String("region")) {
+            const QString effectId = d.attribute(QStringLiteral("id"));
+            for (int j = m_recycledEffects.count() - 1; j >= 0; --j) {
+                if (m_recycledEffects.at(j)->effect().attribute(QStringLiteral("id")) == effectId) {
+                    currentEffect = m_recycledEffects.takeAt(j);
+                    break;
+                }
+            }
+        }
+        if (currentEffect) {
+            currentEffect->setParent(view);
+            currentEffect->reuse(d, m_currentEffectList.at(i), info, &m_effectMetaInfo, canMoveUp, i == effectsCount - 1);
+        } else {
+            currentEffect = new CollapsibleEffect(d, m_currentEffectList.at(i), info, &m_effectMetaInfo, canMoveUp, i == effectsCount - 1, view);
+        }
         isSelected = currentEffect->effectIndex() == activeEffectIndex();
+        // Activating the effect builds its parameters, required to know its monitor scene
+        currentEffect->setActive(isSelected);
         if (isSelected) {
             m_monitorSceneWanted = currentEffect->needsMonitorEffectScene();
             selectedCollapsibleEffect = currentEffect;
@@ -410,13 +431,13 @@ void EffectStackView2::setupListView()
         }
         int position = (m_effectMetaInfo.monitor->position() - (m_status == TIMELINE_CLIP ? m_clipref->startPos() : GenTime())).frames(KdenliveSettings::project_fps());
         currentEffect->slotSyncEffectsPos(position);
-        currentEffect->setActive(isSelected);
         m_effects.append(currentEffect);
         if (group) {
             group->addGroupEffect(currentEffect);
         } else {
             vbox1->addWidget(currentEffect);
         }
+        currentEffect->show();
         connectEffect(currentEffect);
     }
 
@@ -438,10 +459,32 @@ void EffectStackView2::setupListView()
     vbox1->addStretch(10);
     slotUpdateCheckAllButton();
 
+    // Only keep a limited number of unused widgets, the least recently used are deleted
+    while (m_recycledEffects.count() > maxRecycledEffects) {
+        delete m_recycledEffects.takeFirst();
+    }
+
     // Wait a little bit for the new layout to be ready, then check if we have a scrollbar
     m_scrollTimer.start();
 }
 
+void EffectStackView2::recycleEffects()
+{
+    for (CollapsibleEffect *effect : m_effects) {
+        // Grouped and region effects have a custom layout, they are deleted with the view like broken effects
+        const QDomElement dom = effect->effect();
+        if (effect->groupIndex() != -1 || dom.attribute(QStringLiteral("tag")) == QLatin1String("region") || dom.firstChildElement(QStringLiteral("name")).isNull()) {
+            continue;
+        }
+        effect->removeEventFilter(this);
+        effect->recycle();
+        effect->setParent(this);
+        effect->hide();
+        m_recycledEffects.append(effect);
+    }
+    m_effects.clear();
+}
+
 int EffectStackView2::activeEffectIndex() const
 {
     int index = 0;
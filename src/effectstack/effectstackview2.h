@@ -132,6 +132,8 @@ private:
 
     QList<CollapsibleEffect *> m_effects;
     EffectsList m_currentEffectList;
+    /** @brief Unused effect widgets reused when displaying another stack, the most recently used last. */
+    QList<CollapsibleEffect *> m_recycledEffects;
 
     QVBoxLayout m_layout;
     EffectSettings *m_effect;
@@ -145,6 +147,8 @@ private:
 
     /** @brief Sets the list of effects according to the clip's effect list. */
     void setupListView();
+    /** @brief Keep the widgets of the displayed effects to reuse them in the next stack. */
+    void recycleEffects();
 
     /** @brief Build the drag info and start it. */
     void startDrag();
@@ -1193,6 +1193,77 @@ void ParameterContainer::updateParameter(const QString &key, const QString &valu
     m_effect.setAttribute(key, value);
 }
 
+bool ParameterContainer::updateValues(const QDomElement &effect, const ItemInfo &info)
+{
+    // Only effects made of simple value widgets can be updated, keyframe and custom widgets are rebuilt
+    if (m_keyframeEditor || m_geometryWidget || m_animationWidget || !m_conditionalWidgets.isEmpty() || m_conditionParameter || effect.hasAttribute(QStringLiteral("condition"))) {
+        return false;
+    }
+    if (effect.attribute(QStringLiteral("id")) != m_effect.attribute(QStringLiteral("id")) || effect.attribute(QStringLiteral("tag")) != m_effect.attribute(QStringLiteral("tag"))) {
+        return false;
+    }
+    if (effect.attribute(QStringLiteral("id")) == QLatin1String("movit.lift_gamma_gain") || effect.attribute(QStringLiteral("id")) == QLatin1String("lift_gamma_gain") || effect.attribute(QStringLiteral("id")) == QLatin1String("avfilter.selectivecolor")) {
+        return false;
+    }
+    QDomNodeList params = effect.elementsByTagName(QStringLiteral("parameter"));
+    QDomNodeList currentParams = m_effect.elementsByTagName(QStringLiteral("parameter"));
+    if (params.count() != currentParams.count()) {
+        return false;
+    }
+    static const QStringList simpleTypes = QStringList() << QStringLiteral("double") << QStringLiteral("constant") << QStringLiteral("list") << QStringLiteral("bool") << QStringLiteral("switch") << QStringLiteral("fixed");
+    for (int i = 0; i < params.count(); ++i) {
+        QDomElement pa = params.item(i).toElement();
+        QDomElement current = currentParams.item(i).toElement();
+        QString type = pa.attribute(QStringLiteral("type"));
+        if (!simpleTypes.contains(type) || type != current.attribute(QStringLiteral("type")) || pa.attribute(QStringLiteral("name")) != current.attribute(QStringLiteral("name"))) {
+            return false;
+        }
+        // Bounds and list items are set when building the widget
+        if (pa.attribute(QStringLiteral("min")) != current.attribute(QStringLiteral("min")) || pa.attribute(QStringLiteral("max")) != current.attribute(QStringLiteral("max"))
+            || pa.attribute(QStringLiteral("min")).contains(QLatin1Char('%')) || pa.attribute(QStringLiteral("max")).contains(QLatin1Char('%'))
+            || pa.attribute(QStringLiteral("paramlist")) != current.attribute(QStringLiteral("paramlist")) || pa.attribute(QStringLiteral("paramlist")) == QLatin1String("%lumaPaths")) {
+            return false;
+        }
+    }
+
+    QLocale locale;
+    locale.setNumberOptions(QLocale::OmitGroupSeparator);
+    m_effect = effect;
+    m_info = info;
+    m_in = info.cropStart.frames(KdenliveSettings::project_fps());
+    m_out = (info.cropStart + info.cropDuration).frames(KdenliveSettings::project_fps()) - 1;
+    bool disable = effect.attribute(QStringLiteral("disable")) == QLatin1String("1") && KdenliveSettings::disable_effect_parameters();
+    m_vbox->parentWidget()->setEnabled(!disable);
+    for (int i = 0; i < params.count(); ++i) {
+        QDomElement pa = params.item(i).toElement();
+        QString type = pa.attribute(QStringLiteral("type"));
+        QDomElement na = pa.firstChildElement(QStringLiteral("name"));
+        QString paramName = na.isNull() ? pa.attribute(QStringLiteral("name")) : i18n(na.text().toUtf8().data());
+        QWidget *widget = m_valueItems.value(paramName);
+        if (!widget) {
+            continue;
+        }
+        QString value = pa.attribute(QStringLiteral("value")).isNull() ?
+                        pa.attribute(QStringLiteral("default")) : pa.attribute(QStringLiteral("value"));
+        widget->blockSignals(true);
+        if (type == QLatin1String("double") || type == QLatin1String("constant")) {
+            static_cast<DoubleParameterWidget *>(widget)->setValue(locale.toDouble(value));
+        } else if (type == QLatin1String("list")) {
+            QStringList listitems = pa.attribute(QStringLiteral("paramlist")).split(QLatin1Char(';'));
+            if (listitems.count() == 1) {
+                listitems = pa.attribute(QStringLiteral("paramlist")).split(QLatin1Char(','));
+            }
+            static_cast<ListParamWidget *>(widget)->setCurrentIndex(value.isEmpty() ? 0 : qMax(0, listitems.indexOf(value)));
+        } else if (type == QLatin1String("bool")) {
+            static_cast<BoolParamWidget *>(widget)->setChecked(value.toInt() == 1);
+        } else if (type == QLatin1String("switch")) {
+            static_cast<BoolParamWidget *>(widget)->setChecked(value == pa.attribute(QStringLiteral("max")));
+        }
+        widget->blockSignals(false);
+    }
+    return true;
+}
+
 void ParameterContainer::slotStartFilterJobAction()
 {
     if (m_conditionParameter) {
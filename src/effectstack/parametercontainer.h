@@ -82,6 +82,9 @@ public:
     ~ParameterContainer();
     void updateTimecodeFormat();
     void updateParameter(const QString &key, const QString &value);
+    /** @brief Display the values of @param effect in the existing widgets.
+     * @return false if @param effect does not have the same parameters and the widgets have to be rebuilt */
+    bool updateValues(const QDomElement &effect, const ItemInfo &info);
     /** @brief Returns true of this effect requires an on monitor adjustable effect scene. */
     MonitorSceneType needsMonitorEffectScene() const;
     /** @brief Set keyframes for this param. */
@@ -55,3 +55,8 @@ bool BoolParamWidget::getValue()
 {
     return m_checkBox->isChecked();
 }
+
+void BoolParamWidget::setChecked(bool checked)
+{
+    m_checkBox->setChecked(checked);
+}
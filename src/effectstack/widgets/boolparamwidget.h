@@ -48,6 +48,10 @@ public:
      */
     bool getValue();
 
+    /** @brief Sets the state of the checkbox
+     */
+    void setChecked(bool checked);
+
 public slots:
     /** @brief Toggle the comments on or off    */
     void slotShowComment(bool) Q_DECL_OVERRIDE;
@@ -50,14 +50,23 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
 
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
 {
-    const int sizeMain = m_mainTrackEnvelope->envelopeSize();
-    const int sizeSub = envelope->envelopeSize();
+    AudioCorrelationInfo *info = correlateEnvelopes(m_mainTrackEnvelope->envelope(), m_mainTrackEnvelope->envelopeSize(),
+                                                    envelope->envelope(), envelope->envelopeSize());
 
+    m_children.append(envelope);
+    m_correlations.append(info);
+
+    Q_ASSERT(m_correlations.size() == m_children.size());
+    int index = m_children.indexOf(envelope);
+    int shift = getShift(index);
+    emit gotAudioAlignData(envelope->track(), envelope->startPos(), shift);
+}
+
+AudioCorrelationInfo *AudioCorrelation::correlateEnvelopes(const qint64 *envMain, int sizeMain,
+                                                           const qint64 *envSub, int sizeSub)
+{
     AudioCorrelationInfo *info = new AudioCorrelationInfo(sizeMain, sizeSub);
     qint64 *correlation = info->correlationVector();
-
-    const qint64 *envMain = m_mainTrackEnvelope->envelope();
-    const qint64 *envSub = envelope->envelope();
     qint64 max = 0;
 
     if (sizeSub > 200) {
@@ -71,14 +80,7 @@ void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
                   &max);
         info->setMax(max);
     }
-
-    m_children.append(envelope);
-    m_correlations.append(info);
-
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    emit gotAudioAlignData(envelope->track(), envelope->startPos(), shift);
+    return info;
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -47,6 +47,14 @@ public:
                           const qint64 *envSub, int sizeSub,
                           qint64 *correlation,
                           qint64 *out_max = nullptr);
+
+    /**
+      Correlates the (normalized) envelopes envMain and envSub, using the
+      FFT based correlation for long envelopes. The caller takes ownership
+      of the returned info; the shift is its maxIndex() minus sizeSub.
+      */
+    static AudioCorrelationInfo *correlateEnvelopes(const qint64 *envMain, int sizeMain,
+                                                    const qint64 *envSub, int sizeSub);
 private:
     AudioEnvelope *m_mainTrackEnvelope;
 
@@ -96,10 +96,7 @@ void AudioEnvelope::loadEnvelope()
 
         qint16 *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
 
-        qint64 sum = 0;
-        for (int k = 0; k < samples; ++k) {
-            sum += abs(data[k]);
-        }
+        qint64 sum = frameEnvelope(data, samples);
         m_envelope[i] = sum;
 
         m_envelopeMean += sum;
@@ -122,6 +119,15 @@ void AudioEnvelope::loadEnvelope()
                           << t.elapsed() << " ms.";
 }
 
+qint64 AudioEnvelope::frameEnvelope(const qint16 *data, int samples)
+{
+    qint64 sum = 0;
+    for (int k = 0; k < samples; ++k) {
+        sum += abs(data[k]);
+    }
+    return sum;
+}
+
 int AudioEnvelope::track() const
 {
     return m_track;
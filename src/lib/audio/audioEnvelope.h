@@ -48,6 +48,9 @@ public:
     int track() const;
     int startPos() const;
 
+    /// Sum of the absolute sample values, i.e. one envelope entry for one frame of audio.
+    static qint64 frameEnvelope(const qint16 *data, int samples);
+
 private:
     qint64 *m_envelope;
     Mlt::Producer *m_producer;
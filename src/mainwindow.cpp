@@ -111,6 +111,8 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QScreen>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 static const char version[] = KDENLIVE_VERSION;
 namespace Mlt
@@ -1851,6 +1853,13 @@ void MainWindow::setRenderingProgress(const QString &url, int progress)
     }
 }
 
+void MainWindow::setRenderingStats(const QString &url, const QString &stats)
+{
+    if (m_renderWidget) {
+        m_renderWidget->setRenderStats(url, QJsonDocument::fromJson(stats.toUtf8()).object());
+    }
+}
+
 void MainWindow::setRenderingFinished(const QString &url, int status, const QString &error)
 {
     emit setRenderProgress(100);
@@ -3430,7 +3439,10 @@ void MainWindow::slotPrepareRendering(bool scriptExport, bool zoneOnly, const QS
     } else {
         out = (int) GenTime(project->projectDuration()).frames(project->fps()) - 2;
     }
-    QString playlistContent = pCore->projectManager()->projectSceneList(project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
+    // Keep the timeline preview track so that its rendered chunks replace the unchanged parts of the timeline.
+    // Invalidated chunks are removed from the track, so only the modified zones are processed again.
+    bool usePreview = pCore->projectManager()->currentTimeline()->hasPreviewTrack() && m_renderWidget->previewRendering(project->getDocumentProperty(QStringLiteral("previewparameters")));
+    QString playlistContent = pCore->projectManager()->projectSceneList(project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile(), usePreview);
     if (!chapterFile.isEmpty()) {
         QDomDocument doc;
         QDomElement chapters = doc.createElement(QStringLiteral("chapters"));
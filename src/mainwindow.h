@@ -248,6 +248,8 @@ public slots:
     void slotGotProgressInfo(const QString &message, int progress, MessageType type = DefaultMessage);
     void slotReloadEffects();
     Q_SCRIPTABLE void setRenderingProgress(const QString &url, int progress);
+    /** @brief Receive the render speed and timings of a job, as a JSON object. */
+    Q_SCRIPTABLE void setRenderingStats(const QString &url, const QString &stats);
     Q_SCRIPTABLE void setRenderingFinished(const QString &url, int status, const QString &error);
     Q_SCRIPTABLE void addProjectClip(const QString &url);
     Q_SCRIPTABLE void addTimelineClip(const QString &url);
@@ -20,6 +20,7 @@
 #include "bincontroller.h"
 #include "clipcontroller.h"
 #include "kdenlivesettings.h"
+#include "project/sharedcache.h"
 #include "timeline/clip.h"
 
 static const char *kPlaylistTrackId = "main bin";
@@ -497,6 +498,10 @@ void BinController::checkThumbnails(const QDir &thumbFolder)
         bool foundFile = false;
         if (!ctrl->getClipHash().isEmpty()) {
             QImage img(thumbFolder.absoluteFilePath(ctrl->getClipHash() + QStringLiteral(".png")));
+            if (img.isNull() && SharedCache::isEnabled()) {
+                // Thumbnail created by another project
+                img = QImage(SharedCache::instance()->thumbnailPath(ctrl->getClipHash()));
+            }
             if (!img.isNull()) {
                 emit loadThumb(ctrl->clipId(), img, true);
                 foundFile = true;
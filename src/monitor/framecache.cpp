@@ -0,0 +1,151 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "framecache.h"
+#include "kdenlive_debug.h"
+
+#include <mlt++/MltFrame.h>
+
+FrameCache::FrameCache(int budget)
+    : m_hits(0)
+    , m_misses(0)
+    , m_generation(0)
+{
+    setBudget(budget);
+}
+
+void FrameCache::setBudget(int budget)
+{
+    QMutexLocker lock(&m_mutex);
+    m_frames.setMaxCost(qMax(0, budget) * 1024);
+}
+
+bool FrameCache::isEnabled() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frames.maxCost() > 0;
+}
+
+void FrameCache::insert(const SharedFrame &frame, int generation)
+{
+    if (!frame.is_valid() || frame.get_image_format() != mlt_image_yuv420p) {
+        return;
+    }
+    const int cost = qMax(1, mlt_image_format_size(mlt_image_yuv420p, frame.get_image_width(), frame.get_image_height(), nullptr) / 1024);
+    QMutexLocker lock(&m_mutex);
+    if (cost > m_frames.maxCost() || (generation >= 0 && generation != m_generation)) {
+        return;
+    }
+    const int position = frame.get_position();
+    if (m_frames.contains(position)) {
+        return;
+    }
+    // Keep our own copy of the image, so that the MLT frame and its producer references can be released
+    Mlt::Frame copy = frame.clone(false, true);
+    m_frames.insert(position, new SharedFrame(copy), cost);
+}
+
+SharedFrame FrameCache::frame(int position)
+{
+    QMutexLocker lock(&m_mutex);
+    SharedFrame *cached = m_frames.object(position);
+    if (cached == nullptr) {
+        m_misses++;
+        return SharedFrame();
+    }
+    m_hits++;
+    return *cached;
+}
+
+bool FrameCache::contains(int position) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frames.contains(position);
+}
+
+int FrameCache::generation() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_generation;
+}
+
+void FrameCache::invalidate()
+{
+    QMutexLocker lock(&m_mutex);
+    m_generation++;
+    if (m_frames.isEmpty()) {
+        return;
+    }
+    qCDebug(KDENLIVE_LOG) << "Monitor frame cache invalidated," << m_frames.count() << "frames, hit rate:" << (m_hits + m_misses > 0 ? 100 * m_hits / (m_hits + m_misses) : 0) << "%";
+    m_frames.clear();
+}
+
+void FrameCache::invalidate(int start, int end)
+{
+    QMutexLocker lock(&m_mutex);
+    m_generation++;
+    const QList<int> positions = m_frames.keys();
+    for (int position : positions) {
+        if (position >= start && position <= end) {
+            m_frames.remove(position);
+        }
+    }
+}
+
+int FrameCache::count() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frames.count();
+}
+
+qint64 FrameCache::usedMemory() const
+{
+    QMutexLocker lock(&m_mutex);
+    return (qint64) m_frames.totalCost() * 1024;
+}
+
+int FrameCache::hits() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_hits;
+}
+
+int FrameCache::misses() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_misses;
+}
+
+double FrameCache::hitRate() const
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_hits + m_misses == 0) {
+        return 0;
+    }
+    return (double) m_hits / (m_hits + m_misses);
+}
+
+void FrameCache::resetStatistics()
+{
+    QMutexLocker lock(&m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
@@ -0,0 +1,81 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include "scopes/sharedframe.h"
+
+#include <QCache>
+#include <QMutex>
+
+/**
+ * @class FrameCache
+ * @brief Memory budgeted cache of recently displayed monitor frames.
+ *
+ * Frames are stored with their image already converted for display and are
+ * keyed by their timeline position, so that scrubbing or stepping back over
+ * an already displayed zone does not require MLT to decode it again.
+ * The cache must be invalidated whenever the timeline content changes.
+ */
+class FrameCache
+{
+public:
+    /** @brief Create a cache using at most @param budget megabytes of memory */
+    explicit FrameCache(int budget = 0);
+
+    /** @brief Change the memory budget (in megabytes), 0 disables the cache */
+    void setBudget(int budget);
+    bool isEnabled() const;
+
+    /** @brief Store a copy of a displayed frame, its image must be available in yuv420p
+     *  @param generation if not -1, the frame is discarded if the cache was invalidated since generation() returned this value */
+    void insert(const SharedFrame &frame, int generation = -1);
+    /** @brief Returns the frame displayed at @param position, or an invalid frame if it is not cached */
+    SharedFrame frame(int position);
+    /** @brief Returns true if a frame is cached for @param position, without affecting the statistics */
+    bool contains(int position) const;
+    /** @brief Incremented on each invalidation, used to discard frames decoded from an outdated timeline */
+    int generation() const;
+    /** @brief Drop all cached frames */
+    void invalidate();
+    /** @brief Drop all cached frames in the [start, end] range */
+    void invalidate(int start, int end);
+
+    int count() const;
+    /** @brief Memory currently used by the cached images, in bytes */
+    qint64 usedMemory() const;
+    int hits() const;
+    int misses() const;
+    /** @brief Ratio of successful lookups, between 0 and 1 */
+    double hitRate() const;
+    void resetStatistics();
+
+private:
+    mutable QMutex m_mutex;
+    /** @brief Cached frames, the cost is the image size in kilobytes */
+    QCache<int, SharedFrame> m_frames;
+    int m_hits;
+    int m_misses;
+    int m_generation;
+};
+
+#endif
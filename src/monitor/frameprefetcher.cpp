@@ -0,0 +1,214 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "frameprefetcher.h"
+#include "framecache.h"
+#include "scopes/sharedframe.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <mlt++/Mlt.h>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+
+FramePrefetcher::FramePrefetcher(FrameCache *cache, Mlt::Profile *profile, QObject *parent)
+    : QObject(parent)
+    , m_cache(cache)
+    , m_profile(profile)
+    , m_producer(nullptr)
+    , m_abort(0)
+    , m_window(0)
+    , m_sceneValid(false)
+    , m_pendingPosition(-1)
+    , m_pendingTimeline(nullptr)
+{
+    connect(&m_watcher, &QFutureWatcherBase::finished, this, &FramePrefetcher::slotFinished);
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    m_abort = 1;
+    m_watcher.waitForFinished();
+    delete m_pendingTimeline;
+    delete m_producer;
+}
+
+void FramePrefetcher::setWindow(int frames)
+{
+    m_window = qMax(0, frames);
+}
+
+int FramePrefetcher::window() const
+{
+    return m_window;
+}
+
+bool FramePrefetcher::needsTimeline(int position) const
+{
+    if (!m_sceneValid) {
+        return true;
+    }
+    // Edits outside of the prefetched frames don't require a new copy
+    const int first = position - m_window / 2;
+    const int last = position + m_window;
+    for (const QPair<int, int> &range : m_dirtyRanges) {
+        if (range.first <= last && range.second >= first) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FramePrefetcher::start(int position, Mlt::Producer *timeline)
+{
+    if (m_window == 0 || (!m_sceneValid && timeline == nullptr)) {
+        delete timeline;
+        return;
+    }
+    if (m_watcher.isRunning()) {
+        // Wait for the previous job to stop before starting a new one
+        m_abort = 1;
+        m_pendingPosition = position;
+        if (timeline) {
+            delete m_pendingTimeline;
+            m_pendingTimeline = timeline;
+        }
+        return;
+    }
+    m_abort = 0;
+    m_pendingPosition = -1;
+    if (timeline) {
+        m_sceneValid = true;
+        m_dirtyRanges.clear();
+    }
+    // Use the same scaling as the monitor consumer
+    m_rescale = KdenliveSettings::mltinterpolation();
+    m_deinterlace = KdenliveSettings::mltdeinterlacer();
+    m_watcher.setFuture(QtConcurrent::run(this, &FramePrefetcher::prefetch, position, timeline, m_cache->generation()));
+}
+
+void FramePrefetcher::cancel()
+{
+    m_abort = 1;
+    m_pendingPosition = -1;
+}
+
+void FramePrefetcher::invalidate(int start, int end)
+{
+    cancel();
+    if (start < 0) {
+        m_sceneValid = false;
+        m_dirtyRanges.clear();
+    } else if (m_sceneValid) {
+        m_dirtyRanges << qMakePair(start, end);
+    }
+}
+
+void FramePrefetcher::waitForFinished()
+{
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+void FramePrefetcher::slotFinished()
+{
+    if (m_pendingPosition >= 0) {
+        int position = m_pendingPosition;
+        m_pendingPosition = -1;
+        Mlt::Producer *timeline = m_pendingTimeline;
+        m_pendingTimeline = nullptr;
+        start(position, timeline);
+    }
+}
+
+void FramePrefetcher::prefetch(int position, Mlt::Producer *timeline, int generation)
+{
+    QThread::currentThread()->setPriority(QThread::IdlePriority);
+    if (timeline) {
+        delete m_producer;
+        m_producer = nullptr;
+        Mlt::Consumer xmlConsumer(*m_profile, "xml:kdenlive_prefetch");
+        xmlConsumer.set("terminate_on_pause", 1);
+        xmlConsumer.set("store", "kdenlive");
+        xmlConsumer.connect(*timeline);
+        // Timeline edits lock the service too, so they wait until the graph is written
+        timeline->lock();
+        xmlConsumer.run();
+        timeline->unlock();
+        delete timeline;
+        // Build the copy even if this job was cancelled, the next requests rely on it
+        m_producer = new Mlt::Producer(*m_profile, "xml-string", xmlConsumer.get("kdenlive_prefetch"));
+        if (!m_producer->is_valid()) {
+            qCDebug(KDENLIVE_LOG) << "Cannot create timeline copy for frame prefetching";
+            delete m_producer;
+            m_producer = nullptr;
+        }
+    }
+    if (m_producer == nullptr) {
+        QThread::currentThread()->setPriority(QThread::NormalPriority);
+        return;
+    }
+    // Decode the frames after the playhead first since they are needed to start playback,
+    // then the frames before it. Both ranges are decoded in order to avoid seeking.
+    const int length = m_producer->get_length();
+    QList<int> positions;
+    for (int i = position + 1; i <= qMin(position + m_window, length - 1); ++i) {
+        positions << i;
+    }
+    for (int i = qMax(0, position - m_window / 2); i < position; ++i) {
+        positions << i;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    int decoded = 0;
+    int current = -1;
+    for (int pos : positions) {
+        if (m_abort.load() == 1 || m_cache->generation() != generation) {
+            break;
+        }
+        if (m_cache->contains(pos)) {
+            continue;
+        }
+        if (pos != current) {
+            m_producer->seek(pos);
+        }
+        Mlt::Frame *frame = m_producer->get_frame();
+        if (frame == nullptr) {
+            break;
+        }
+        frame->set("rescale.interp", m_rescale.toUtf8().constData());
+        frame->set("deinterlace_method", m_deinterlace.toUtf8().constData());
+        frame->set("consumer_deinterlace", 1);
+        mlt_image_format format = mlt_image_yuv420p;
+        int width = m_profile->width();
+        int height = m_profile->height();
+        frame->get_image(format, width, height);
+        m_cache->insert(SharedFrame(*frame), generation);
+        delete frame;
+        current = pos + 1;
+        decoded++;
+    }
+    if (decoded > 0) {
+        qCDebug(KDENLIVE_LOG) << "Prefetched" << decoded << "monitor frames in" << timer.elapsed() << "ms";
+    }
+    QThread::currentThread()->setPriority(QThread::NormalPriority);
+}
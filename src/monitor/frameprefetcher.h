@@ -0,0 +1,93 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+
+class FrameCache;
+
+namespace Mlt
+{
+class Producer;
+class Profile;
+}
+
+/**
+ * @class FramePrefetcher
+ * @brief Decodes frames around the paused playhead into the monitor FrameCache.
+ *
+ * Frames are decoded at idle priority from a private copy of the timeline,
+ * so that the monitor producer is never touched outside of the consumer.
+ * The copy is built in the prefetch thread and only rebuilt when an edited
+ * range reaches the frames around the playhead.
+ */
+class FramePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FramePrefetcher(FrameCache *cache, Mlt::Profile *profile, QObject *parent = nullptr);
+    ~FramePrefetcher();
+
+    /** @brief Number of frames decoded after the playhead, half as many are decoded before it. 0 disables prefetching */
+    void setWindow(int frames);
+    int window() const;
+    /** @brief Returns true if the timeline copy is missing or outdated around @param position, start() then needs the timeline */
+    bool needsTimeline(int position) const;
+    /** @brief Start decoding around @param position.
+     *  @param timeline a new reference to the timeline producer, used to rebuild our copy. The prefetcher takes ownership of it */
+    void start(int position, Mlt::Producer *timeline = nullptr);
+    /** @brief Stop the current decoding as soon as possible, for example when playback starts */
+    void cancel();
+    /** @brief The timeline was edited in the [start, end] range, or everywhere if start is -1: stop decoding and mark the copy outdated there */
+    void invalidate(int start = -1, int end = -1);
+    /** @brief Stop decoding and wait until the prefetch thread is idle */
+    void waitForFinished();
+
+private:
+    FrameCache *m_cache;
+    Mlt::Profile *m_profile;
+    /** @brief Our copy of the timeline, only used by the prefetch thread */
+    Mlt::Producer *m_producer;
+    QFutureWatcher<void> m_watcher;
+    QAtomicInt m_abort;
+    int m_window;
+    bool m_sceneValid;
+    /** @brief Ranges edited since our copy of the timeline was built */
+    QList<QPair<int, int> > m_dirtyRanges;
+    /** @brief Request received while a previous prefetch was still stopping */
+    int m_pendingPosition;
+    Mlt::Producer *m_pendingTimeline;
+    QString m_rescale;
+    QString m_deinterlace;
+    void prefetch(int position, Mlt::Producer *timeline, int generation);
+
+private slots:
+    void slotFinished();
+};
+
+#endif
@@ -20,6 +20,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_2_Core>
 #include <QQuickItem>
 #include <QApplication>
@@ -27,6 +28,7 @@
 
 #include <mlt++/Mlt.h>
 #include "glwidget.h"
+#include "framecache.h"
 #include "core.h"
 #include "qml/qmlaudiothumb.h"
 #include "kdenlivesettings.h"
@@ -50,9 +52,17 @@
 #define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
 #endif
 
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+
 #ifndef Q_OS_WIN
 typedef GLenum(*ClientWaitSync_fp)(GLsync sync, GLbitfield flags, GLuint64 timeout);
 static ClientWaitSync_fp ClientWaitSync = nullptr;
+typedef GLsync(*FenceSync_fp)(GLenum condition, GLbitfield flags);
+static FenceSync_fp FenceSync = nullptr;
+typedef void (*DeleteSync_fp)(GLsync sync);
+static DeleteSync_fp DeleteSync = nullptr;
 #endif
 
 using namespace Mlt;
@@ -61,6 +71,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     : QQuickView((QWindow *) parent)
     , sendFrameForAnalysis(false)
     , m_id(id)
+    , m_previewScale(1)
     , m_shader(nullptr)
     , m_glslManager(nullptr)
     , m_consumer(nullptr)
@@ -74,6 +85,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_threadJoinEvent(nullptr)
     , m_displayEvent(nullptr)
     , m_frameRenderer(nullptr)
+    , m_frameCache(nullptr)
     , m_projectionLocation(0)
     , m_modelViewLocation(0)
     , m_vertexLocation(0)
@@ -102,6 +114,9 @@ GLWidget::GLWidget(int id, QObject *parent)
 
     if (KdenliveSettings::gpu_accel()) {
         m_glslManager = new Mlt::Filter(*m_monitorProfile, "glsl.manager");
+    } else if (m_id == Kdenlive::ProjectMonitor) {
+        // Movit frames only hold a GPU texture, so caching is only possible without GPU processing
+        m_frameCache = new FrameCache(KdenliveSettings::monitorframecache());
     }
     if ((m_glslManager && !m_glslManager->is_valid())) {
         delete m_glslManager;
@@ -137,6 +152,7 @@ GLWidget::~GLWidget()
     delete m_shareContext;
     delete m_shader;
     delete m_monitorProfile;
+    delete m_frameCache;
 }
 
 void GLWidget::updateAudioForAnalysis()
@@ -203,6 +219,7 @@ void GLWidget::initializeGL()
     }
     m_frameRenderer = new FrameRenderer(openglContext(), m_offscreenSurface);
     m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio();
+    m_frameRenderer->frameCache = m_frameCache;
     openglContext()->makeCurrent(this);
     //openglContext()->blockSignals(false);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::frameDisplayed, Qt::QueuedConnection);
@@ -321,22 +338,9 @@ void GLWidget::createShader()
     m_texCoordLocation = m_shader->attributeLocation("texCoord");
 }
 
-static void uploadTextures(QOpenGLContext *context, const SharedFrame &frame, GLuint texture[])
+static void createTexture(QOpenGLFunctions *f, GLuint texture, int width, int height)
 {
-    int width = frame.get_image_width();
-    int height = frame.get_image_height();
-    const uint8_t *image = frame.get_image();
-    QOpenGLFunctions *f = context->functions();
-
-    // Upload each plane of YUV to a texture.
-    if (texture[0]) {
-        f->glDeleteTextures(3, texture);
-    }
-    check_error(f);
-    f->glGenTextures(3, texture);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[0]);
+    f->glBindTexture(GL_TEXTURE_2D, texture);
     check_error(f);
     f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     check_error(f);
@@ -347,36 +351,70 @@ static void uploadTextures(QOpenGLContext *context, const SharedFrame &frame, GL
     f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     check_error(f);
     f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width, height, 0,
-                    GL_LUMINANCE, GL_UNSIGNED_BYTE, image);
+                    GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
     check_error(f);
+}
 
-    f->glBindTexture(GL_TEXTURE_2D, texture[1]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width / 2, height / 2, 0,
-                    GL_LUMINANCE, GL_UNSIGNED_BYTE, image + width * height);
-    check_error(f);
+/** Upload the YUV planes of frame to texture. The textures are only (re)allocated when
+ *  the frame size changes, otherwise their content is replaced. If pbo is set, the image
+ *  is first copied to the pixel buffer so that the texture transfer does not block. */
+static void uploadTextures(QOpenGLContext *context, const SharedFrame &frame, GLuint texture[], QSize &textureSize, QOpenGLBuffer *pbo = nullptr)
+{
+    int width = frame.get_image_width();
+    int height = frame.get_image_height();
+    const uint8_t *image = frame.get_image();
+    QOpenGLFunctions *f = context->functions();
 
-    f->glBindTexture(GL_TEXTURE_2D, texture[2]);
+    if (!texture[0] || textureSize != QSize(width, height)) {
+        if (texture[0]) {
+            f->glDeleteTextures(3, texture);
+        }
+        check_error(f);
+        f->glGenTextures(3, texture);
+        check_error(f);
+        createTexture(f, texture[0], width, height);
+        createTexture(f, texture[1], width / 2, height / 2);
+        createTexture(f, texture[2], width / 2, height / 2);
+        textureSize = QSize(width, height);
+    }
+
+    const uint8_t *data = image;
+    if (pbo) {
+        const int size = width * height + 2 * (width / 2 * height / 2);
+        pbo->bind();
+        // Orphan the previous storage so that we don't wait for a pending transfer
+        pbo->allocate(size);
+        void *buffer = pbo->map(QOpenGLBuffer::WriteOnly);
+        if (buffer) {
+            memcpy(buffer, image, size);
+            pbo->unmap();
+            // Offsets are now relative to the bound pixel buffer
+            data = nullptr;
+        } else {
+            pbo->release();
+            pbo = nullptr;
+        }
+    }
+
+    // Upload each plane of YUV to a texture.
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    f->glBindTexture(GL_TEXTURE_2D, texture[0]);
     check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
     check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    f->glBindTexture(GL_TEXTURE_2D, texture[1]);
     check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width / 2, height / 2, GL_LUMINANCE, GL_UNSIGNED_BYTE, data + width * height);
     check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    f->glBindTexture(GL_TEXTURE_2D, texture[2]);
     check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width / 2, height / 2, 0,
-                    GL_LUMINANCE, GL_UNSIGNED_BYTE, image + width * height + width / 2 * height / 2);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width / 2, height / 2, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                       data + width * height + width / 2 * height / 2);
     check_error(f);
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (pbo) {
+        pbo->release();
+    }
 }
 
 void GLWidget::clear()
@@ -415,10 +453,15 @@ void GLWidget::paintGL()
             m_mutex.unlock();
             return;
         }
-        uploadTextures(openglContext(), m_sharedFrame, m_texture);
+        uploadTextures(openglContext(), m_sharedFrame, m_texture, m_textureSize);
         m_mutex.unlock();
     }
 
+    if (m_frameRenderer && !m_glslManager) {
+        // Make sure the texture upload of the frame renderer is complete
+        m_frameRenderer->waitForTexture();
+    }
+
     // Bind textures.
     for (int i = 0; i < 3; ++i) {
         if (m_texture[i]) {
@@ -785,6 +828,47 @@ void GLWidget::resetDrops()
     }
 }
 
+bool GLWidget::setPreviewScale(int scale)
+{
+    // GPU processing renders to textures at the profile size
+    if (scale == m_previewScale || !m_consumer || m_glslManager) {
+        return false;
+    }
+    m_previewScale = scale;
+    if (m_frameRenderer) {
+        m_frameRenderer->previewScale = scale;
+    }
+    // Keep an even size for the yuv420p chroma planes
+    int width = m_monitorProfile->width() / scale;
+    int height = m_monitorProfile->height() / scale;
+    m_consumer->set("width", width - width % 2);
+    m_consumer->set("height", height - height % 2);
+    return true;
+}
+
+int GLWidget::previewScale() const
+{
+    return m_previewScale;
+}
+
+FrameCache *GLWidget::frameCache() const
+{
+    return m_frameCache;
+}
+
+bool GLWidget::showCachedFrame(int position)
+{
+    if (!m_frameCache || !m_frameRenderer || m_glslManager) {
+        return false;
+    }
+    SharedFrame frame = m_frameCache->frame(position);
+    if (!frame.is_valid()) {
+        return false;
+    }
+    QMetaObject::invokeMethod(m_frameRenderer, "showCachedFrame", Qt::QueuedConnection, Q_ARG(SharedFrame, frame));
+    return true;
+}
+
 void GLWidget::createAudioOverlay(bool isAudio)
 {
     if (!m_consumer) {
@@ -951,11 +1035,17 @@ int GLWidget::reconfigureMulti(const QString &params, const QString &path, Mlt::
 int GLWidget::reconfigure(Mlt::Profile *profile)
 {
     int error = 0;
+    if (m_frameCache) {
+        m_frameCache->invalidate();
+        m_frameCache->setBudget(KdenliveSettings::monitorframecache());
+    }
     // use SDL for audio, OpenGL for video
     QString serviceName = property("mlt_service").toString();
     if (profile) {
         reloadProfile(*profile);
     }
+    // Restart at full resolution, the consumer might be replaced below
+    setPreviewScale(1);
     if (!m_consumer || !m_consumer->is_valid() || strcmp(m_consumer->get("mlt_service"), "multi") == 0) {
         if (m_consumer) {
             m_consumer->purge();
@@ -1318,18 +1408,34 @@ FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface)
     , m_semaphore(3)
     , m_context(nullptr)
     , m_surface(surface)
+    , m_pboIndex(0)
+    , m_usePbo(false)
+    , m_useFence(-1)
+    , m_textureFence(nullptr)
     , m_gl32(nullptr)
     , sendAudioForAnalysis(false)
+    , frameCache(nullptr)
+    , previewScale(1)
 {
     Q_ASSERT(shareContext);
     m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
     m_displayTexture[0] = m_displayTexture[1] = m_displayTexture[2] = 0;
+    for (int i = 0; i < PBO_COUNT; ++i) {
+        m_pbo[i] = nullptr;
+    }
     if (KdenliveSettings::gpu_accel() || shareContext->supportsThreadedOpenGL()) {
         m_context = new QOpenGLContext;
         m_context->setFormat(shareContext->format());
         m_context->setShareContext(shareContext);
         m_context->create();
         m_context->moveToThread(this);
+        // Pixel buffer objects are core since OpenGL 2.1 and OpenGL ES 3.0
+        const QSurfaceFormat format = m_context->format();
+        if (m_context->isOpenGLES()) {
+            m_usePbo = format.majorVersion() >= 3;
+        } else {
+            m_usePbo = format.version() >= qMakePair(2, 1) || m_context->hasExtension(QByteArrayLiteral("GL_ARB_pixel_buffer_object"));
+        }
     }
     setObjectName(QStringLiteral("FrameRenderer"));
     moveToThread(this);
@@ -1350,26 +1456,126 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
     frame.get_image(format, width, height);
     // Save this frame for future use and to keep a reference to the GL Texture.
     m_displayFrame = SharedFrame(frame);
+    if (frameCache && previewScale == 1) {
+        frameCache->insert(m_displayFrame);
+    }
+    displayFrame();
+    m_semaphore.release();
+}
+
+void FrameRenderer::showCachedFrame(const SharedFrame &frame)
+{
+    m_displayFrame = frame;
+    displayFrame();
+}
 
+void FrameRenderer::displayFrame()
+{
     if (m_context && m_context->isValid()) {
         m_context->makeCurrent(m_surface);
         // Upload each plane of YUV to a texture.
         QOpenGLFunctions *f = m_context->functions();
-        uploadTextures(m_context, m_displayFrame, m_renderTexture);
+        QOpenGLBuffer *pbo = nullptr;
+        if (m_usePbo) {
+            // Cycle through the pixel buffers, so that filling one does not wait for the transfer of the previous frame
+            m_pboIndex = (m_pboIndex + 1) % PBO_COUNT;
+            if (!m_pbo[m_pboIndex]) {
+                m_pbo[m_pboIndex] = new QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer);
+                m_pbo[m_pboIndex]->setUsagePattern(QOpenGLBuffer::StreamDraw);
+                m_pbo[m_pboIndex]->create();
+            }
+            pbo = m_pbo[m_pboIndex];
+        }
+        uploadTextures(m_context, m_displayFrame, m_renderTexture, m_renderTextureSize, pbo);
         f->glBindTexture(GL_TEXTURE_2D, 0);
         check_error(f);
-        f->glFinish();
+        if (!pbo || !createTextureFence()) {
+            f->glFinish();
+        }
 
         for (int i = 0; i < 3; ++i) {
             std::swap(m_renderTexture[i], m_displayTexture[i]);
         }
+        std::swap(m_renderTextureSize, m_displayTextureSize);
         emit textureReady(m_displayTexture[0], m_displayTexture[1], m_displayTexture[2]);
         m_context->doneCurrent();
     }
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
-    m_semaphore.release();
+}
+
+bool FrameRenderer::resolveSyncFunctions()
+{
+    if (m_useFence < 0) {
+#ifdef Q_OS_WIN
+        if (!m_gl32) {
+            m_gl32 = m_context->versionFunctions<QOpenGLFunctions_3_2_Core>();
+            if (m_gl32) {
+                m_gl32->initializeOpenGLFunctions();
+            }
+        }
+        m_useFence = m_gl32 != nullptr;
+#else
+        if (m_context->format().version() >= qMakePair(3, 2) || m_context->hasExtension(QByteArrayLiteral("GL_ARB_sync"))) {
+            if (!ClientWaitSync) {
+                ClientWaitSync = (ClientWaitSync_fp) m_context->getProcAddress("glClientWaitSync");
+            }
+            FenceSync = (FenceSync_fp) m_context->getProcAddress("glFenceSync");
+            DeleteSync = (DeleteSync_fp) m_context->getProcAddress("glDeleteSync");
+        }
+        m_useFence = ClientWaitSync && FenceSync && DeleteSync;
+#endif
+    }
+    return m_useFence == 1;
+}
+
+void FrameRenderer::deleteFence(GLsync sync)
+{
+#ifdef Q_OS_WIN
+    m_gl32->glDeleteSync(sync);
+#else
+    DeleteSync(sync);
+#endif
+}
+
+bool FrameRenderer::createTextureFence()
+{
+    if (!resolveSyncFunctions()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    GLsync sync = m_gl32->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#else
+    GLsync sync = FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+    if (!sync) {
+        return false;
+    }
+    // Submit the transfer so that the widget context can wait for it
+    m_context->functions()->glFlush();
+    QMutexLocker lock(&m_fenceMutex);
+    if (m_textureFence) {
+        // The previous frame was never painted
+        deleteFence(m_textureFence);
+    }
+    m_textureFence = sync;
+    return true;
+}
+
+void FrameRenderer::waitForTexture()
+{
+    QMutexLocker lock(&m_fenceMutex);
+    if (!m_textureFence) {
+        return;
+    }
+#ifdef Q_OS_WIN
+    m_gl32->glClientWaitSync(m_textureFence, 0, GL_TIMEOUT_IGNORED);
+#else
+    ClientWaitSync(m_textureFence, 0, GL_TIMEOUT_IGNORED);
+#endif
+    deleteFence(m_textureFence);
+    m_textureFence = nullptr;
 }
 
 void FrameRenderer::showGLFrame(Mlt::Frame frame)
@@ -1456,9 +1662,20 @@ void FrameRenderer::cleanup()
         if (m_displayTexture[0] && m_displayTexture[1] && m_displayTexture[2]) {
             m_context->functions()->glDeleteTextures(3, m_displayTexture);
         }
+        for (int i = 0; i < PBO_COUNT; ++i) {
+            delete m_pbo[i];
+            m_pbo[i] = nullptr;
+        }
+        m_fenceMutex.lock();
+        if (m_textureFence) {
+            deleteFence(m_textureFence);
+            m_textureFence = nullptr;
+        }
+        m_fenceMutex.unlock();
         m_context->doneCurrent();
         m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
         m_displayTexture[0] = m_displayTexture[1] = m_displayTexture[2] = 0;
+        m_renderTextureSize = m_displayTextureSize = QSize();
     }
 }
 
@@ -34,6 +34,7 @@
 #include "definitions.h"
 
 class QOpenGLFunctions_3_2_Core;
+class QOpenGLBuffer;
 //class QmlFilter;
 //class QmlMetadata;
 
@@ -44,6 +45,7 @@ class Filter;
 
 class RenderThread;
 class FrameRenderer;
+class FrameCache;
 
 typedef void *(*thread_function_t)(void *);
 
@@ -113,6 +115,13 @@ public:
     void setAudioThumb(int channels = 0, const QVariantList &audioCache = QList<QVariant>());
     int droppedFrames() const;
     void resetDrops();
+    /** @brief Divide the consumer processing resolution by @param scale (1, 2 or 4). Returns true if the scale changed */
+    bool setPreviewScale(int scale);
+    int previewScale() const;
+    /** @brief Returns the cache of displayed frames, nullptr if this monitor does not cache frames */
+    FrameCache *frameCache() const;
+    /** @brief Display the cached frame for this position. Returns false if it is not in cache */
+    bool showCachedFrame(int position);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -156,6 +165,10 @@ private:
     QRect m_rect;
     QRect m_effectRect;
     GLuint m_texture[3];
+    /** @brief Size of m_texture when it is uploaded by paintGL */
+    QSize m_textureSize;
+    /** @brief Divider applied to the profile size for playback */
+    int m_previewScale;
     QOpenGLShaderProgram *m_shader;
     QPoint m_panStart;
     QPoint m_dragStart;
@@ -172,6 +185,7 @@ private:
     Mlt::Event *m_displayEvent;
     Mlt::Profile *m_monitorProfile;
     FrameRenderer *m_frameRenderer;
+    FrameCache *m_frameCache;
     int m_projectionLocation;
     int m_modelViewLocation;
     int m_vertexLocation;
@@ -245,6 +259,9 @@ public:
     Q_INVOKABLE void showFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLNoSyncFrame(Mlt::Frame frame);
+    Q_INVOKABLE void showCachedFrame(const SharedFrame &frame);
+    /** @brief Wait until the last frame uploaded through a pixel buffer is in the textures, called before painting them */
+    void waitForTexture();
 
 public slots:
     void cleanup();
@@ -260,12 +277,33 @@ private:
     SharedFrame m_displayFrame;
     QOpenGLContext *m_context;
     QSurface *m_surface;
+    /** @brief Number of pixel buffers used in turn to upload the frames */
+    static const int PBO_COUNT = 2;
+    QOpenGLBuffer *m_pbo[PBO_COUNT];
+    int m_pboIndex;
+    bool m_usePbo;
+    /** @brief 1 if sync objects are available, -1 until checked */
+    int m_useFence;
+    /** @brief Fence set after uploading the display textures, waited for by the widget before painting */
+    GLsync m_textureFence;
+    QMutex m_fenceMutex;
+    /** @brief Upload m_displayFrame to the display textures */
+    void displayFrame();
+    bool resolveSyncFunctions();
+    /** @brief Set m_textureFence after an upload, returns false if sync objects are not available */
+    bool createTextureFence();
+    void deleteFence(GLsync sync);
 
 public:
     GLuint m_renderTexture[3];
     GLuint m_displayTexture[3];
+    QSize m_renderTextureSize;
+    QSize m_displayTextureSize;
     QOpenGLFunctions_3_2_Core *m_gl32;
     bool sendAudioForAnalysis;
+    FrameCache *frameCache;
+    /** @brief Frames are only cached when rendered at full resolution */
+    int previewScale;
 };
 
 #endif
@@ -504,6 +504,11 @@ void Monitor::setupMenu(QMenu *goMenu, QMenu *overlayMenu, QAction *playZone, QA
     connect(overlayAudio, &QAction::toggled, m_glMonitor, &GLWidget::slotSwitchAudioOverlay);
     overlayAudio->setChecked(KdenliveSettings::displayAudioOverlay());
 
+    QAction *autoScale = m_configMenu->addAction(i18n("Lower Resolution When Dropping Frames"));
+    autoScale->setCheckable(true);
+    autoScale->setChecked(KdenliveSettings::monitor_autoscale());
+    connect(autoScale, &QAction::toggled, this, &Monitor::slotSwitchAutoScale);
+
     QAction *switchAudioMonitor = m_configMenu->addAction(i18n("Show Audio Levels"), this, SLOT(slotSwitchAudioMonitor()));
     switchAudioMonitor->setCheckable(true);
     switchAudioMonitor->setChecked(KdenliveSettings::monitoraudio() & m_id);
@@ -1750,6 +1755,7 @@ void Monitor::checkDrops(int dropped)
         if (m_droppedTimer.hasExpired(1000)) {
             m_droppedTimer.invalidate();
             double fps = m_monitorManager->timecode().fps();
+            updatePreviewScale(dropped);
             if (dropped == 0) {
                 // No dropped frames since last check
                 m_qmlManager->setProperty(QStringLiteral("dropped"), false);
@@ -1766,6 +1772,28 @@ void Monitor::checkDrops(int dropped)
         // Start m_dropTimer
         m_glMonitor->resetDrops();
         m_droppedTimer.start();
+    } else if (m_glMonitor->previewScale() > 1) {
+        updatePreviewScale(0);
+    }
+}
+
+void Monitor::updatePreviewScale(int dropped)
+{
+    if (!KdenliveSettings::monitor_autoscale() || !m_playAction->isActive()) {
+        return;
+    }
+    int scale = m_glMonitor->previewScale();
+    if (dropped > 0) {
+        m_stableTimer.start();
+        // Lower the resolution when more than 10% of the frames were dropped
+        if (dropped * 10 > m_monitorManager->timecode().fps() && scale < 4) {
+            render->setPreviewScale(scale * 2);
+            m_glMonitor->resetDrops();
+        }
+    } else if (scale > 1 && (!m_stableTimer.isValid() || m_stableTimer.hasExpired(5000))) {
+        // Playback kept up for a while, try a higher resolution
+        render->setPreviewScale(scale / 2);
+        m_stableTimer.start();
     }
 }
 
@@ -2149,6 +2177,14 @@ void Monitor::slotUpdateQmlTimecode(const QString &tc)
     m_glMonitor->rootObject()->setProperty("timecode", tc);
 }
 
+void Monitor::slotSwitchAutoScale(bool enable)
+{
+    KdenliveSettings::setMonitor_autoscale(enable);
+    if (!enable && render) {
+        render->setPreviewScale(1);
+    }
+}
+
 void Monitor::slotSwitchAudioMonitor()
 {
     if (!m_audioMeterWidget->isValid) {
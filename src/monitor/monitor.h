@@ -227,6 +227,8 @@ private:
     MonitorSceneType m_lastMonitorSceneType;
     MonitorAudioLevel *m_audioMeterWidget;
     QElapsedTimer m_droppedTimer;
+    /** @brief Time since the last dropped frames, used to restore the playback resolution */
+    QElapsedTimer m_stableTimer;
     double m_displayedFps;
     void adjustScrollBars(float horizontal, float vertical);
     void loadQmlScene(MonitorSceneType type);
@@ -235,6 +237,8 @@ private:
     void connectQmlToolbar(QQuickItem *root);
     /** @brief Check and display dropped frames */
     void checkDrops(int dropped);
+    /** @brief Lower or restore the playback resolution depending on the frames dropped in the last second */
+    void updatePreviewScale(int dropped);
     /** @brief Create temporary Mlt::Tractor holding a clip and it's effectless clone */
     void buildSplitEffect(Mlt::Producer *original, int pos);
 
@@ -327,6 +331,7 @@ public slots:
     void slotGetCurrentImage(bool request);
     /** @brief Enable/disable display of monitor's audio levels widget */
     void slotSwitchAudioMonitor();
+    void slotSwitchAutoScale(bool enable);
 
 signals:
     void renderPosition(int);
@@ -0,0 +1,289 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "archivecopier.h"
+#include "kdenlive_debug.h"
+
+#include <KLocalizedString>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <QtConcurrent>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#endif
+
+static const qint64 copyChunkSize = 4 * 1024 * 1024;
+
+ArchiveCopier::ArchiveCopier(const QString &destinationFolder, QObject *parent)
+    : QObject(parent)
+    , m_journalPath(QDir(destinationFolder).absoluteFilePath(QStringLiteral(".kdenlive-archive")))
+    , m_useHardLinks(false)
+    , m_next(0)
+    , m_cancel(0)
+    , m_copied(0)
+    , m_total(0)
+    , m_percent(-1)
+{
+    // Copying is mostly I/O bound, a few parallel copies are enough to keep the disks busy
+    m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+}
+
+ArchiveCopier::~ArchiveCopier()
+{
+    cancel();
+    m_future.waitForFinished();
+}
+
+void ArchiveCopier::addFile(const QString &source, const QString &destination)
+{
+    Task task;
+    task.source = source;
+    task.destination = destination;
+    task.size = QFileInfo(source).size();
+    m_total += task.size;
+    m_tasks << task;
+}
+
+void ArchiveCopier::setUseHardLinks(bool useHardLinks)
+{
+    m_useHardLinks = useHardLinks;
+}
+
+void ArchiveCopier::cancel()
+{
+    m_cancel.store(1);
+}
+
+void ArchiveCopier::start()
+{
+    // Load the files copied by an interrupted archiving to the same folder
+    QFile journal(m_journalPath);
+    if (journal.open(QIODevice::ReadOnly)) {
+        QTextStream stream(&journal);
+        stream.setCodec("UTF-8");
+        while (!stream.atEnd()) {
+            const QString line = stream.readLine();
+            int sep = line.lastIndexOf(QLatin1Char('\t'));
+            if (sep > 0) {
+                m_journal.insert(line.left(sep), line.mid(sep + 1));
+            }
+        }
+        journal.close();
+    }
+    m_future = QtConcurrent::run(this, &ArchiveCopier::run);
+}
+
+void ArchiveCopier::run()
+{
+    QList<QFuture<void> > workers;
+    for (int i = 0; i < m_pool.maxThreadCount(); ++i) {
+        workers << QtConcurrent::run(&m_pool, this, &ArchiveCopier::work);
+    }
+    for (QFuture<void> &worker : workers) {
+        worker.waitForFinished();
+    }
+    // An I/O error also stops the workers through m_cancel, report it before checking for an abort
+    if (!m_error.isEmpty()) {
+        emit finished(false, m_error);
+        return;
+    }
+    if (m_cancel.load() != 0) {
+        emit finished(false, QString());
+        return;
+    }
+    // Archive is complete, nothing to resume
+    QFile::remove(m_journalPath);
+    emit finished(true, QString());
+}
+
+void ArchiveCopier::work()
+{
+    int ix = m_next.fetchAndAddOrdered(1);
+    while (ix < m_tasks.count() && m_cancel.load() == 0) {
+        const Task &task = m_tasks.at(ix);
+        const QString sourceSignature = signature(task.source);
+        bool done = m_journal.value(task.destination) == sourceSignature && QFileInfo(task.destination).size() == task.size;
+        if (done) {
+            addProgress(task.size);
+        } else {
+            QString error;
+            if (copyFile(task, error)) {
+                recordDone(task);
+            } else if (m_cancel.load() == 0) {
+                QMutexLocker lock(&m_mutex);
+                if (m_error.isEmpty()) {
+                    m_error = error;
+                }
+                // Stop other workers, the archive is not usable anyway
+                m_cancel.store(2);
+            }
+        }
+        ix = m_next.fetchAndAddOrdered(1);
+    }
+}
+
+bool ArchiveCopier::copyFile(const Task &task, QString &error)
+{
+    QDir().mkpath(QFileInfo(task.destination).absolutePath());
+    if (QFile::exists(task.destination)) {
+        QFile::remove(task.destination);
+    }
+    if (cloneFile(task)) {
+        addProgress(task.size);
+        return true;
+    }
+    return streamFile(task, error);
+}
+
+bool ArchiveCopier::cloneFile(const Task &task)
+{
+#ifdef Q_OS_UNIX
+    const QByteArray source = QFile::encodeName(task.source);
+    const QByteArray destination = QFile::encodeName(task.destination);
+#ifdef FICLONE
+    // Copy on write filesystems (btrfs, xfs) can share the file extents
+    int in = ::open(source.constData(), O_RDONLY);
+    if (in >= 0) {
+        int out = ::open(destination.constData(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (out >= 0) {
+            bool cloned = ::ioctl(out, FICLONE, in) == 0;
+            ::close(out);
+            if (!cloned) {
+                ::unlink(destination.constData());
+            }
+            ::close(in);
+            if (cloned) {
+                return true;
+            }
+        } else {
+            ::close(in);
+        }
+    }
+#endif
+    if (m_useHardLinks) {
+        struct stat sourceInfo;
+        struct stat folderInfo;
+        if (::stat(source.constData(), &sourceInfo) == 0 && ::stat(QFile::encodeName(QFileInfo(task.destination).absolutePath()).constData(), &folderInfo) == 0
+            && sourceInfo.st_dev == folderInfo.st_dev) {
+            return ::link(source.constData(), destination.constData()) == 0;
+        }
+    }
+#else
+    Q_UNUSED(task)
+#endif
+    return false;
+}
+
+bool ArchiveCopier::streamFile(const Task &task, QString &error)
+{
+    QFile in(task.source);
+    if (!in.open(QIODevice::ReadOnly)) {
+        error = i18n("Cannot read file %1", task.source);
+        return false;
+    }
+    const QString partName = task.destination + QStringLiteral(".part");
+    QFile out(partName);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = i18n("Cannot write to file %1", partName);
+        return false;
+    }
+    QCryptographicHash sourceHash(QCryptographicHash::Md5);
+    QByteArray buffer;
+    while (!in.atEnd()) {
+        if (m_cancel.load() != 0) {
+            out.remove();
+            return false;
+        }
+        buffer = in.read(copyChunkSize);
+        if (buffer.isEmpty() && in.error() != QFileDevice::NoError) {
+            error = i18n("Cannot read file %1", task.source);
+            out.remove();
+            return false;
+        }
+        sourceHash.addData(buffer);
+        if (out.write(buffer) != buffer.size()) {
+            error = i18n("Cannot write to file %1", partName);
+            out.remove();
+            return false;
+        }
+        addProgress(buffer.size());
+    }
+    in.close();
+    if (!out.flush()) {
+        error = i18n("Cannot write to file %1", partName);
+        out.remove();
+        return false;
+    }
+    out.close();
+    // Read back the copy to detect write errors
+    QCryptographicHash copyHash(QCryptographicHash::Md5);
+    if (!out.open(QIODevice::ReadOnly) || !copyHash.addData(&out) || copyHash.result() != sourceHash.result()) {
+        error = i18n("Copy of %1 is corrupted", task.source);
+        out.remove();
+        return false;
+    }
+    out.close();
+    if (!out.rename(task.destination)) {
+        error = i18n("Cannot write to file %1", task.destination);
+        out.remove();
+        return false;
+    }
+    return true;
+}
+
+void ArchiveCopier::addProgress(qint64 bytes)
+{
+    qint64 copied = m_copied.fetchAndAddRelaxed(bytes) + bytes;
+    int percent = m_total > 0 ? (int)(100 * copied / m_total) : 100;
+    int previous = m_percent.load();
+    if (percent != previous && m_percent.testAndSetRelaxed(previous, percent)) {
+        emit progress(percent);
+    }
+}
+
+void ArchiveCopier::recordDone(const Task &task)
+{
+    QMutexLocker lock(&m_mutex);
+    QFile journal(m_journalPath);
+    if (journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        journal.write(task.destination.toUtf8() + '\t' + signature(task.source).toUtf8() + '\n');
+    }
+}
+
+QString ArchiveCopier::signature(const QString &source)
+{
+    QFileInfo info(source);
+    return QString::number(info.size()) + QLatin1Char(':') + QString::number(info.lastModified().toMSecsSinceEpoch());
+}
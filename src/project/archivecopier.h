@@ -0,0 +1,93 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARCHIVECOPIER_H
+#define ARCHIVECOPIER_H
+
+#include <QAtomicInteger>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+
+/**
+ * @class ArchiveCopier
+ * @brief Copies the files of an archived project, several at a time.
+ *
+ * Files on the same filesystem as their destination are cloned (reflink) when the
+ * filesystem supports it, or hard linked if requested. Other files are copied to a
+ * temporary name and read back to check their content before being renamed. Copied
+ * files are recorded in a journal in the destination folder, so that an interrupted
+ * archive can be resumed without copying them again.
+ */
+class ArchiveCopier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ArchiveCopier(const QString &destinationFolder, QObject *parent = nullptr);
+    ~ArchiveCopier();
+    void addFile(const QString &source, const QString &destination);
+    /** @brief Allow hard links for files on the same filesystem as the destination. */
+    void setUseHardLinks(bool useHardLinks);
+    /** @brief Start copying in worker threads. */
+    void start();
+
+public slots:
+    void cancel();
+
+private:
+    struct Task {
+        QString source;
+        QString destination;
+        qint64 size;
+    };
+    QString m_journalPath;
+    bool m_useHardLinks;
+    QList<Task> m_tasks;
+    QThreadPool m_pool;
+    QFuture<void> m_future;
+    QAtomicInt m_next;
+    QAtomicInt m_cancel;
+    QAtomicInteger<qint64> m_copied;
+    qint64 m_total;
+    QAtomicInt m_percent;
+    QMutex m_mutex;
+    QString m_error;
+    /** @brief Source signature of the files copied by a previous run, by destination */
+    QHash<QString, QString> m_journal;
+    void run();
+    void work();
+    bool copyFile(const Task &task, QString &error);
+    bool cloneFile(const Task &task);
+    bool streamFile(const Task &task, QString &error);
+    void addProgress(qint64 bytes);
+    void recordDone(const Task &task);
+    static QString signature(const QString &source);
+
+signals:
+    void progress(int percent);
+    void finished(bool success, const QString &errorMessage);
+};
+
+#endif
@@ -0,0 +1,259 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cacheledger.h"
+#include "kdenlive_debug.h"
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace {
+const QString ledgerName = QStringLiteral(".usage");
+const QByteArray ledgerHeader = QByteArrayLiteral("kdenlive-cache-usage 1");
+// Reusing a file only updates its ledger entry after this delay, to keep the ledger small
+const qint64 useGranularity = 3600;
+}
+
+class CacheLedgerCreator
+{
+public:
+    CacheLedger object;
+};
+
+Q_GLOBAL_STATIC(CacheLedgerCreator, creator)
+
+CacheLedger::CacheLedger()
+{
+}
+
+CacheLedger *CacheLedger::instance()
+{
+    return &creator->object;
+}
+
+CacheLedger::Ledger &CacheLedger::ledger(const QDir &folder)
+{
+    const QString key = folder.absolutePath();
+    const QString path = folder.absoluteFilePath(ledgerName);
+    QHash<QString, Ledger>::iterator it = m_ledgers.find(key);
+    if (it != m_ledgers.end()) {
+        if (QFile::exists(path)) {
+            return it.value();
+        }
+        // The folder was deleted or cleared
+        m_ledgers.erase(it);
+    }
+    Ledger result;
+    result.total = 0;
+    QFile file(path);
+    bool valid = false;
+    int lines = 0;
+    if (file.open(QIODevice::ReadOnly)) {
+        valid = file.readLine().trimmed() == ledgerHeader;
+        while (valid && !file.atEnd()) {
+            const QStringList fields = QString::fromUtf8(file.readLine()).remove(QLatin1Char('\n')).split(QLatin1Char('\t'));
+            lines++;
+            if (fields.count() == 4 && fields.at(0) == QLatin1String("+")) {
+                Entry entry;
+                entry.size = fields.at(1).toLongLong();
+                entry.used = fields.at(2).toLongLong();
+                result.total += entry.size - result.entries.value(fields.at(3), {0, 0}).size;
+                result.entries.insert(fields.at(3), entry);
+            } else if (fields.count() == 2 && fields.at(0) == QLatin1String("-")) {
+                result.total -= result.entries.take(fields.at(1)).size;
+            }
+        }
+        file.close();
+    }
+    if (!valid) {
+        // No complete ledger for this folder yet
+        result = scan(folder);
+        write(folder, result);
+    } else if (lines > 2 * result.entries.count() + 1000) {
+        write(folder, result);
+    }
+    return m_ledgers.insert(key, result).value();
+}
+
+//static
+CacheLedger::Ledger CacheLedger::scan(const QDir &folder)
+{
+    Ledger result;
+    result.total = 0;
+    QDirIterator it(folder.absolutePath(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.fileName() == ledgerName) {
+            continue;
+        }
+        Entry entry;
+        entry.size = info.size();
+        entry.used = info.lastModified().toMSecsSinceEpoch() / 1000;
+        result.entries.insert(folder.relativeFilePath(info.absoluteFilePath()), entry);
+        result.total += entry.size;
+    }
+    return result;
+}
+
+//static
+void CacheLedger::write(const QDir &folder, const Ledger &ledger)
+{
+    if (!folder.exists()) {
+        return;
+    }
+    QFile file(folder.absoluteFilePath(ledgerName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write cache ledger" << file.fileName();
+        return;
+    }
+    QByteArray data = ledgerHeader + '\n';
+    QHash<QString, Entry>::const_iterator it = ledger.entries.constBegin();
+    for (; it != ledger.entries.constEnd(); ++it) {
+        data.append(QStringLiteral("+\t%1\t%2\t%3\n").arg(it.value().size).arg(it.value().used).arg(it.key()).toUtf8());
+    }
+    file.write(data);
+}
+
+//static
+void CacheLedger::append(const QDir &folder, const QString &line)
+{
+    QFile file(folder.absoluteFilePath(ledgerName));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        file.write(line.toUtf8());
+    }
+}
+
+void CacheLedger::setEntry(const QDir &folder, Ledger &ledger, const QString &name, const Entry &entry)
+{
+    ledger.total += entry.size - ledger.entries.value(name, {0, 0}).size;
+    ledger.entries.insert(name, entry);
+    append(folder, QStringLiteral("+\t%1\t%2\t%3\n").arg(entry.size).arg(entry.used).arg(name));
+}
+
+void CacheLedger::removeEntry(const QDir &folder, Ledger &ledger, const QString &name)
+{
+    if (ledger.entries.contains(name)) {
+        ledger.total -= ledger.entries.take(name).size;
+        append(folder, QStringLiteral("-\t%1\n").arg(name));
+    }
+}
+
+void CacheLedger::addFile(const QDir &folder, const QString &path)
+{
+    const QFileInfo info(folder.absoluteFilePath(path));
+    const QString name = folder.relativeFilePath(info.absoluteFilePath());
+    QMutexLocker lock(&m_mutex);
+    Ledger &current = ledger(folder);
+    if (!info.isFile()) {
+        removeEntry(folder, current, name);
+        return;
+    }
+    Entry entry;
+    entry.size = info.size();
+    entry.used = QDateTime::currentMSecsSinceEpoch() / 1000;
+    QHash<QString, Entry>::const_iterator it = current.entries.constFind(name);
+    if (it != current.entries.constEnd() && it.value().size == entry.size && entry.used - it.value().used < useGranularity) {
+        return;
+    }
+    setEntry(folder, current, name, entry);
+}
+
+void CacheLedger::removeFile(const QDir &folder, const QString &path)
+{
+    const QString name = folder.relativeFilePath(folder.absoluteFilePath(path));
+    QMutexLocker lock(&m_mutex);
+    removeEntry(folder, ledger(folder), name);
+}
+
+void CacheLedger::removeFolder(const QDir &folder, const QString &subFolder)
+{
+    const QString prefix = folder.relativeFilePath(folder.absoluteFilePath(subFolder)) + QLatin1Char('/');
+    QMutexLocker lock(&m_mutex);
+    Ledger &current = ledger(folder);
+    bool changed = false;
+    QHash<QString, Entry>::iterator it = current.entries.begin();
+    while (it != current.entries.end()) {
+        if (it.key().startsWith(prefix)) {
+            current.total -= it.value().size;
+            it = current.entries.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (changed) {
+        write(folder, current);
+    }
+}
+
+qint64 CacheLedger::usage(const QDir &folder, const QStringList &prefixes)
+{
+    QMutexLocker lock(&m_mutex);
+    const Ledger &current = ledger(folder);
+    if (prefixes.isEmpty()) {
+        return current.total;
+    }
+    qint64 total = 0;
+    QHash<QString, Entry>::const_iterator it = current.entries.constBegin();
+    for (; it != current.entries.constEnd(); ++it) {
+        for (const QString &prefix : prefixes) {
+            if (it.key().startsWith(prefix)) {
+                total += it.value().size;
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+void CacheLedger::trim(const QDir &folder, qint64 maxSize)
+{
+    QMutexLocker lock(&m_mutex);
+    Ledger &current = ledger(folder);
+    if (maxSize <= 0 || current.total <= maxSize) {
+        return;
+    }
+    QList<QPair<qint64, QString> > files;
+    files.reserve(current.entries.count());
+    QHash<QString, Entry>::const_iterator it = current.entries.constBegin();
+    for (; it != current.entries.constEnd(); ++it) {
+        files.append(qMakePair(it.value().used, it.key()));
+    }
+    std::sort(files.begin(), files.end());
+    int removed = 0;
+    for (const QPair<qint64, QString> &file : files) {
+        if (current.total <= maxSize) {
+            break;
+        }
+        const QString path = folder.absoluteFilePath(file.second);
+        if (QFile::remove(path) || !QFile::exists(path)) {
+            current.total -= current.entries.take(file.second).size;
+            removed++;
+        }
+    }
+    qCDebug(KDENLIVE_LOG) << "// Removed" << removed << "least recently used files from" << folder.absolutePath();
+    write(folder, current);
+}
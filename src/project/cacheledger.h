@@ -0,0 +1,77 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CACHELEDGER_H
+#define CACHELEDGER_H
+
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+
+/**
+ * @class CacheLedger
+ * @brief Keeps track of the files stored in the project cache folders and of their size.
+ *
+ * Cache writers record the files they create, use or delete, so that the size of a cache
+ * folder is known without walking it. Each folder keeps its ledger in a hidden file. A
+ * folder without ledger, for example created by an older version, is scanned once.
+ */
+class CacheLedger
+{
+public:
+    static CacheLedger *instance();
+    /** @brief Record a file created in a cache folder, or used again. Can be called from any thread.
+     *  @param path the file path, absolute or relative to the folder */
+    void addFile(const QDir &folder, const QString &path);
+    /** @brief Record that a file of a cache folder was deleted. */
+    void removeFile(const QDir &folder, const QString &path);
+    /** @brief Forget the files below a subfolder that was deleted. */
+    void removeFolder(const QDir &folder, const QString &subFolder);
+    /** @brief Returns the size of the files in a cache folder.
+     *  @param prefixes if not empty, only count the files whose name starts with one of them */
+    qint64 usage(const QDir &folder, const QStringList &prefixes = QStringList());
+    /** @brief Delete the least recently used files until the folder is not larger than maxSize. */
+    void trim(const QDir &folder, qint64 maxSize);
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 used;
+    };
+    struct Ledger {
+        QHash<QString, Entry> entries;
+        qint64 total;
+    };
+    CacheLedger();
+    friend class CacheLedgerCreator;
+    QMutex m_mutex;
+    QHash<QString, Ledger> m_ledgers;
+    /** @brief Returns the ledger of a folder, reading or rebuilding it if needed. */
+    Ledger &ledger(const QDir &folder);
+    void setEntry(const QDir &folder, Ledger &ledger, const QString &name, const Entry &entry);
+    void removeEntry(const QDir &folder, Ledger &ledger, const QString &name);
+    static Ledger scan(const QDir &folder);
+    static void write(const QDir &folder, const Ledger &ledger);
+    static void append(const QDir &folder, const QString &line);
+};
+
+#endif
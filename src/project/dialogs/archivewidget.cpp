@@ -19,6 +19,8 @@
 
 #include "archivewidget.h"
 #include "projectsettings.h"
+#include "project/archivecopier.h"
+#include "project/parallelgzipdevice.h"
 #include "titler/titlewidget.h"
 #include "mltcontroller/clipcontroller.h"
 
@@ -37,7 +39,7 @@
 ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc, const QList<ClipController *> &list, const QStringList &luma_list, QWidget *parent) :
     QDialog(parent)
     , m_requestedSize(0)
-    , m_copyJob(nullptr)
+    , m_copier(nullptr)
     , m_name(projectName.section(QLatin1Char('.'), 0, -2))
     , m_doc(doc)
     , m_temp(nullptr)
@@ -55,6 +57,8 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc
     connect(this, SIGNAL(archivingFinished(bool)), this, SLOT(slotArchivingFinished(bool)));
     connect(this, SIGNAL(archiveProgress(int)), this, SLOT(slotArchivingProgress(int)));
     connect(proxy_only, &QCheckBox::stateChanged, this, &ArchiveWidget::slotProxyOnly);
+    // Files cannot be linked into a compressed archive
+    connect(compressed_archive, &QCheckBox::toggled, link_files, &QWidget::setDisabled);
 
     // Setup categories
     QTreeWidgetItem *videos = new QTreeWidgetItem(files_list, QStringList() << i18n("Video clips"));
@@ -161,7 +165,7 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc
 
     m_infoMessage = new KMessageWidget(this);
     QVBoxLayout *s =  static_cast <QVBoxLayout *>(layout());
-    s->insertWidget(5, m_infoMessage);
+    s->insertWidget(6, m_infoMessage);
     m_infoMessage->setCloseButtonVisible(false);
     m_infoMessage->setWordWrap(true);
     m_infoMessage->hide();
@@ -211,7 +215,7 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QDomDocument &doc
 ArchiveWidget::ArchiveWidget(const QUrl &url, QWidget *parent):
     QDialog(parent),
     m_requestedSize(0),
-    m_copyJob(nullptr),
+    m_copier(nullptr),
     m_temp(nullptr),
     m_abortArchive(false),
     m_extractMode(true),
@@ -232,6 +236,7 @@ ArchiveWidget::ArchiveWidget(const QUrl &url, QWidget *parent):
 
     compressed_archive->setHidden(true);
     proxy_only->setHidden(true);
+    link_files->setHidden(true);
     project_files->setHidden(true);
     files_list->setHidden(true);
     label->setText(i18n("Extract to"));
@@ -318,9 +323,11 @@ bool ArchiveWidget::closeAccepted()
         if (KMessageBox::warningContinueCancel(this, i18n("Archiving in progress, do you want to stop it?"), i18n("Stop Archiving"), KGuiItem(i18n("Stop Archiving"))) != KMessageBox::Continue) {
             return false;
         }
-        if (m_copyJob) {
-            m_copyJob->kill();
+        m_abortArchive = true;
+        if (m_copier) {
+            m_copier->cancel();
         }
+        m_archiveThread.waitForFinished();
     }
     return true;
 }
@@ -500,190 +507,102 @@ void ArchiveWidget::slotCheckSpace()
     }
 }
 
-bool ArchiveWidget::slotStartArchiving(bool firstPass)
+void ArchiveWidget::slotStartArchiving()
 {
-    if (firstPass && (m_copyJob || m_archiveThread.isRunning())) {
+    if (m_copier || m_archiveThread.isRunning()) {
         // archiving in progress, abort
-        if (m_copyJob) {
-            m_copyJob->kill(KJob::EmitResult);
-        }
         m_abortArchive = true;
-        return true;
+        if (m_copier) {
+            m_copier->cancel();
+        }
+        return;
     }
     bool isArchive = compressed_archive->isChecked();
-    if (!firstPass) {
-        m_copyJob = nullptr;
-    } else {
-        //starting archiving
-        m_abortArchive = false;
-        m_duplicateFiles.clear();
-        m_replacementList.clear();
-        m_foldersList.clear();
-        m_filesList.clear();
-        slotDisplayMessage(QStringLiteral("system-run"), i18n("Archiving..."));
-        repaint();
-        archive_url->setEnabled(false);
-        proxy_only->setEnabled(false);
-        compressed_archive->setEnabled(false);
-    }
-    QList<QUrl> files;
-    QUrl destUrl;
-    QString destPath;
-    QTreeWidgetItem *parentItem;
-    bool isSlideshow = false;
-    int items = 0;
-
-    // We parse all files going into one folder, then start the copy job
+    m_abortArchive = false;
+    m_replacementList.clear();
+    m_foldersList.clear();
+    m_filesList.clear();
+    slotDisplayMessage(QStringLiteral("system-run"), i18n("Archiving..."));
+    repaint();
+    archive_url->setEnabled(false);
+    proxy_only->setEnabled(false);
+    compressed_archive->setEnabled(false);
+    link_files->setEnabled(false);
+
+    // Collect all files with their destination, relative to the archive folder
     for (int i = 0; i < files_list->topLevelItemCount(); ++i) {
-        parentItem = files_list->topLevelItem(i);
-        if (parentItem->isDisabled()) {
-            parentItem->setExpanded(false);
+        QTreeWidgetItem *parentItem = files_list->topLevelItem(i);
+        if (parentItem->childCount() == 0) {
             continue;
         }
-        if (parentItem->childCount() > 0) {
-            if (parentItem->data(0, Qt::UserRole).toString() == QLatin1String("slideshows")) {
-                QUrl slideFolder = QUrl::fromLocalFile(archive_url->url().toLocalFile() + QStringLiteral("/slideshows"));
-                if (isArchive) {
-                    m_foldersList.append(QStringLiteral("slideshows"));
-                } else {
-                    QDir dir(slideFolder.toLocalFile());
-                    if (!dir.mkpath(QStringLiteral("."))) {
-                        KMessageBox::sorry(this, i18n("Cannot create directory %1", slideFolder.toLocalFile()));
-                    }
-                }
-                isSlideshow = true;
-            } else {
-                isSlideshow = false;
+        bool isSlideshow = parentItem->data(0, Qt::UserRole).toString() == QLatin1String("slideshows");
+        const QString destPath = parentItem->data(0, Qt::UserRole).toString() + QLatin1Char('/');
+        m_foldersList.append(destPath);
+        for (int j = 0; j < parentItem->childCount(); ++j) {
+            QTreeWidgetItem *item = parentItem->child(j);
+            if (item->isDisabled() || item->data(0, Qt::UserRole + 3).toLongLong() <= 0) {
+                // Clip replaced by its proxy, or missing
+                continue;
             }
-            files_list->setCurrentItem(parentItem);
-            parentItem->setExpanded(true);
-            destPath = parentItem->data(0, Qt::UserRole).toString() + QLatin1Char('/');
-            destUrl = QUrl::fromLocalFile(archive_url->url().toLocalFile() + QLatin1Char('/') + destPath);
-            QTreeWidgetItem *item;
-            for (int j = 0; j < parentItem->childCount(); ++j) {
-                item = parentItem->child(j);
-                if (item->isDisabled()) {
-                    continue;
-                }
-                // Special case: slideshows
-                items++;
-                if (isSlideshow) {
-                    destPath += item->data(0, Qt::UserRole).toString() + QLatin1Char('/');
-                    destUrl = QUrl::fromLocalFile(archive_url->url().toLocalFile() + QDir::separator() + destPath);
-                    QStringList srcFiles = item->data(0, Qt::UserRole + 1).toStringList();
-                    for (int k = 0; k < srcFiles.count(); ++k) {
-                        files << QUrl::fromLocalFile(srcFiles.at(k));
-                    }
-                    item->setDisabled(true);
-                    if (parentItem->indexOfChild(item) == parentItem->childCount() - 1) {
-                        // We have processed all slideshows
-                        parentItem->setDisabled(true);
-                    }
-                    break;
-                } else if (item->data(0, Qt::UserRole).isNull()) {
-                    files << QUrl::fromLocalFile(item->text(0));
-                } else {
-                    // We must rename the destination file, since another file with same name exists
-                    //TODO: monitor progress
-                    if (isArchive) {
-                        m_filesList.insert(item->text(0), destPath + item->data(0, Qt::UserRole).toString());
-                    } else {
-                        m_duplicateFiles.insert(QUrl::fromLocalFile(item->text(0)), QUrl::fromLocalFile(destUrl.toLocalFile() + QLatin1Char('/') + item->data(0, Qt::UserRole).toString()));
-                    }
+            if (isSlideshow) {
+                // Each slideshow goes in its own subfolder
+                const QString slidePath = destPath + item->data(0, Qt::UserRole).toString() + QLatin1Char('/');
+                m_foldersList.append(slidePath);
+                const QStringList srcFiles = item->data(0, Qt::UserRole + 1).toStringList();
+                for (const QString &src : srcFiles) {
+                    m_filesList.insert(src, slidePath + QFileInfo(src).fileName());
                 }
+            } else if (item->data(0, Qt::UserRole).isNull()) {
+                m_filesList.insert(item->text(0), destPath + QFileInfo(item->text(0)).fileName());
+            } else {
+                // We must rename the destination file, since another file with same name exists
+                m_filesList.insert(item->text(0), destPath + item->data(0, Qt::UserRole).toString());
             }
-            if (!isSlideshow) {
-                parentItem->setDisabled(true);
-            }
-            break;
-        }
-    }
-
-    if (items == 0) {
-        // No clips to archive
-        slotArchivingFinished(nullptr, true);
-        return true;
-    }
-
-    if (destPath.isEmpty()) {
-        if (m_duplicateFiles.isEmpty()) {
-            return false;
         }
-        QMapIterator<QUrl, QUrl> i(m_duplicateFiles);
-        if (i.hasNext()) {
-            i.next();
-            QUrl startJobSrc = i.key();
-            QUrl startJobDst = i.value();
-            m_duplicateFiles.remove(startJobSrc);
-            KIO::CopyJob *job = KIO::copyAs(startJobSrc, startJobDst, KIO::HideProgressInfo);
-            connect(job, SIGNAL(result(KJob *)), this, SLOT(slotArchivingFinished(KJob *)));
-            connect(job, SIGNAL(processedSize(KJob *, KIO::filesize_t)), this, SLOT(slotArchivingProgress(KJob *, KIO::filesize_t)));
-        }
-        return true;
     }
-
+    progressBar->setValue(0);
+    buttonBox->button(QDialogButtonBox::Apply)->setText(i18n("Abort"));
     if (isArchive) {
-        m_foldersList.append(destPath);
-        for (int i = 0; i < files.count(); ++i) {
-            m_filesList.insert(files.at(i).toLocalFile(), destPath + files.at(i).fileName());
+        // The archive is written in a thread once the project file is ready
+        if (!processProjectFile()) {
+            slotArchivingFinished(false);
         }
-        slotArchivingFinished();
-    } else if (files.isEmpty()) {
-        slotStartArchiving(false);
-    } else {
-        QDir dir(destUrl.toLocalFile());
-        if (!dir.mkpath(QStringLiteral("."))) {
-            KMessageBox::sorry(this, i18n("Cannot create directory %1", destUrl.toLocalFile()));
-        }
-        m_copyJob = KIO::copy(files, destUrl, KIO::HideProgressInfo);
-        connect(m_copyJob, SIGNAL(result(KJob *)), this, SLOT(slotArchivingFinished(KJob *)));
-        connect(m_copyJob, SIGNAL(processedSize(KJob *, KIO::filesize_t)), this, SLOT(slotArchivingProgress(KJob *, KIO::filesize_t)));
+        return;
     }
-    if (firstPass) {
-        progressBar->setValue(0);
-        buttonBox->button(QDialogButtonBox::Apply)->setText(i18n("Abort"));
+    const QString destFolder = archive_url->url().toLocalFile() + QLatin1Char('/');
+    m_copier = new ArchiveCopier(destFolder, this);
+    m_copier->setUseHardLinks(link_files->isChecked());
+    QMapIterator<QString, QString> i(m_filesList);
+    while (i.hasNext()) {
+        i.next();
+        m_copier->addFile(i.key(), destFolder + i.value());
     }
-    return true;
+    connect(m_copier, &ArchiveCopier::progress, progressBar, &QProgressBar::setValue);
+    connect(m_copier, &ArchiveCopier::finished, this, &ArchiveWidget::slotCopyFinished);
+    m_copier->start();
 }
 
-void ArchiveWidget::slotArchivingFinished(KJob *job, bool finished)
+void ArchiveWidget::slotCopyFinished(bool success, const QString &errorMessage)
 {
-    if (job == nullptr || job->error() == 0) {
-        if (!finished && slotStartArchiving(false)) {
-            // We still have files to archive
-            return;
-        } else if (!compressed_archive->isChecked()) {
-            // Archiving finished
-            progressBar->setValue(100);
-            if (processProjectFile()) {
-                slotJobResult(true, i18n("Project was successfully archived."));
-            } else {
-                slotJobResult(false, i18n("There was an error processing project file"));
-            }
+    m_copier->deleteLater();
+    m_copier = nullptr;
+    if (success) {
+        progressBar->setValue(100);
+        if (processProjectFile()) {
+            slotJobResult(true, i18n("Project was successfully archived."));
         } else {
-            processProjectFile();
+            slotJobResult(false, i18n("There was an error processing project file"));
         }
+    } else if (errorMessage.isEmpty()) {
+        slotJobResult(false, i18n("Archiving was aborted, archive again to the same folder to resume it."));
     } else {
-        m_copyJob = nullptr;
-        slotJobResult(false, i18n("There was an error while copying the files: %1", job->errorString()));
+        slotJobResult(false, i18n("There was an error while copying the files: %1", errorMessage));
     }
-    if (!compressed_archive->isChecked()) {
-        buttonBox->button(QDialogButtonBox::Apply)->setText(i18n("Archive"));
-        archive_url->setEnabled(true);
-        proxy_only->setEnabled(true);
-        compressed_archive->setEnabled(true);
-        for (int i = 0; i < files_list->topLevelItemCount(); ++i) {
-            files_list->topLevelItem(i)->setDisabled(false);
-            for (int j = 0; j < files_list->topLevelItem(i)->childCount(); ++j) {
-                files_list->topLevelItem(i)->child(j)->setDisabled(false);
-            }
-        }
-    }
-}
-
-void ArchiveWidget::slotArchivingProgress(KJob *, KIO::filesize_t size)
-{
-    progressBar->setValue(static_cast<int>(100 * size / m_requestedSize));
+    buttonBox->button(QDialogButtonBox::Apply)->setText(i18n("Archive"));
+    archive_url->setEnabled(true);
+    proxy_only->setEnabled(true);
+    compressed_archive->setEnabled(true);
+    link_files->setEnabled(true);
 }
 
 bool ArchiveWidget::processProjectFile()
@@ -835,9 +754,16 @@ bool ArchiveWidget::processProjectFile()
     }
 
     if (isArchive) {
+        QString archiveName(archive_url->url().toLocalFile() + QDir::separator() + m_name + QStringLiteral(".tar.gz"));
+        if (QFile::exists(archiveName) && KMessageBox::questionYesNo(this, i18n("File %1 already exists.\nDo you want to overwrite it?", archiveName)) == KMessageBox::No) {
+            return false;
+        }
         m_temp = new QTemporaryFile;
         if (!m_temp->open()) {
             KMessageBox::error(this, i18n("Cannot create temporary file"));
+            delete m_temp;
+            m_temp = nullptr;
+            return false;
         }
         m_temp->write(playList.toUtf8());
         m_temp->close();
@@ -869,37 +795,45 @@ bool ArchiveWidget::processProjectFile()
 void ArchiveWidget::createArchive()
 {
     QString archiveName(archive_url->url().toLocalFile() + QDir::separator() + m_name + QStringLiteral(".tar.gz"));
-    if (QFile::exists(archiveName) && KMessageBox::questionYesNo(this, i18n("File %1 already exists.\nDo you want to overwrite it?", archiveName)) == KMessageBox::No) {
-        return;
-    }
     QFileInfo dirInfo(archive_url->url().toLocalFile());
     QString user = dirInfo.owner();
     QString group = dirInfo.group();
-    KTar archive(archiveName, QStringLiteral("application/x-gzip"));
-    archive.open(QIODevice::WriteOnly);
+    // Compress blocks of the archive in parallel
+    ParallelGzipDevice device(archiveName);
+    KTar archive(&device);
+    bool result = archive.open(QIODevice::WriteOnly);
 
     // Create folders
     foreach (const QString &path, m_foldersList) {
+        if (!result) {
+            break;
+        }
         archive.writeDir(path, user, group);
     }
 
     // Add files
     int ix = 0;
     QMapIterator<QString, QString> i(m_filesList);
-    while (i.hasNext()) {
+    while (result && i.hasNext() && !m_abortArchive) {
         i.next();
-        archive.addLocalFile(i.key(), i.value());
+        if (!archive.addLocalFile(i.key(), i.value())) {
+            result = false;
+        }
         emit archiveProgress((int) 100 * ix / m_filesList.count());
         ix++;
     }
 
     // Add project file
-    bool result = false;
-    if (m_temp) {
-        archive.addLocalFile(m_temp->fileName(), m_name + QStringLiteral(".kdenlive"));
-        result = archive.close();
-        delete m_temp;
-        m_temp = nullptr;
+    if (result && !m_abortArchive) {
+        result = archive.addLocalFile(m_temp->fileName(), m_name + QStringLiteral(".kdenlive"));
+    }
+    result = archive.close() && result && !m_abortArchive;
+    device.close();
+    result = result && !device.failed();
+    delete m_temp;
+    m_temp = nullptr;
+    if (!result) {
+        QFile::remove(archiveName);
     }
     emit archivingFinished(result);
 }
@@ -909,6 +843,8 @@ void ArchiveWidget::slotArchivingFinished(bool result)
     if (result) {
         slotJobResult(true, i18n("Project was successfully archived."));
         buttonBox->button(QDialogButtonBox::Apply)->setEnabled(false);
+    } else if (m_abortArchive) {
+        slotJobResult(false, i18n("Archiving was aborted."));
     } else {
         slotJobResult(false, i18n("There was an error processing project file"));
     }
@@ -917,12 +853,7 @@ void ArchiveWidget::slotArchivingFinished(bool result)
     archive_url->setEnabled(true);
     proxy_only->setEnabled(true);
     compressed_archive->setEnabled(true);
-    for (int i = 0; i < files_list->topLevelItemCount(); ++i) {
-        files_list->topLevelItem(i)->setDisabled(false);
-        for (int j = 0; j < files_list->topLevelItem(i)->childCount(); ++j) {
-            files_list->topLevelItem(i)->child(j)->setDisabled(false);
-        }
-    }
+    link_files->setEnabled(!compressed_archive->isChecked());
 }
 
 void ArchiveWidget::slotArchivingProgress(int p)
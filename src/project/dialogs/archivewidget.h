@@ -23,7 +23,6 @@
 #include "ui_archivewidget_ui.h"
 
 #include <kio/global.h>
-#include <KIO/CopyJob>
 #include <QTemporaryFile>
 
 #include <QDialog>
@@ -33,6 +32,7 @@
 
 class KJob;
 class KArchive;
+class ArchiveCopier;
 class ClipController;
 
 /**
@@ -57,9 +57,8 @@ public:
 
 private slots:
     void slotCheckSpace();
-    bool slotStartArchiving(bool firstPass = true);
-    void slotArchivingFinished(KJob *job = nullptr, bool finished = false);
-    void slotArchivingProgress(KJob *, KIO::filesize_t);
+    void slotStartArchiving();
+    void slotCopyFinished(bool success, const QString &errorMessage);
     void done(int r) Q_DECL_OVERRIDE;
     bool closeAccepted();
     void createArchive();
@@ -80,8 +79,7 @@ protected:
 
 private:
     KIO::filesize_t m_requestedSize;
-    KIO::CopyJob *m_copyJob;
-    QMap<QUrl, QUrl> m_duplicateFiles;
+    ArchiveCopier *m_copier;
     QMap<QUrl, QUrl> m_replacementList;
     QString m_name;
     QDomDocument m_doc;
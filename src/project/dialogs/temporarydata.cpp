@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "temporarydata.h"
 #include "doc/kdenlivedoc.h"
+#include "project/cacheledger.h"
 #include "utils/KoIconUtils.h"
 
 #include <KLocalizedString>
@@ -218,45 +219,35 @@ void TemporaryData::updateDataInfo()
         m_currentPage->setEnabled(false);
         return;
     }
+    // Cache writers keep the size of each folder in a ledger
     preview = m_doc->getCacheDir(CachePreview, &ok);
     if (ok) {
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotPreviewSize);
+        gotPreviewSize(static_cast<KIO::filesize_t>(CacheLedger::instance()->usage(preview)));
     }
 
     preview = m_doc->getCacheDir(CacheProxy, &ok);
     if (ok) {
-        preview.setNameFilters(m_proxies);
-        const QFileInfoList fList = preview.entryInfoList();
-        KIO::filesize_t size = 0;
-        for (const QFileInfo &info : fList) {
-            size += info.size();
-        }
-        gotProxySize(size);
+        // The proxy folder is shared by all projects, only count the proxies of this project
+        QStringList prefixes = m_proxies;
+        prefixes.replaceInStrings(QStringLiteral("*"), QString());
+        gotProxySize(prefixes.isEmpty() ? 0 : static_cast<KIO::filesize_t>(CacheLedger::instance()->usage(preview, prefixes)));
     }
 
     preview = m_doc->getCacheDir(CacheAudio, &ok);
     if (ok) {
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotAudioSize);
+        gotAudioSize(static_cast<KIO::filesize_t>(CacheLedger::instance()->usage(preview)));
     }
     preview = m_doc->getCacheDir(CacheThumbs, &ok);
     if (ok) {
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotThumbSize);
+        gotThumbSize(static_cast<KIO::filesize_t>(CacheLedger::instance()->usage(preview)));
     }
     if (m_globalPage) {
         updateGlobalInfo();
     }
 }
 
-void TemporaryData::gotPreviewSize(KJob *job)
+void TemporaryData::gotPreviewSize(KIO::filesize_t total)
 {
-    KIO::DirectorySizeJob *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     QLayoutItem *button = m_grid->itemAtPosition(0, 4);
     if (button && button->widget()) {
         button->widget()->setEnabled(total > 0);
@@ -279,13 +270,8 @@ void TemporaryData::gotProxySize(KIO::filesize_t total)
     updateTotal();
 }
 
-void TemporaryData::gotAudioSize(KJob *job)
+void TemporaryData::gotAudioSize(KIO::filesize_t total)
 {
-    KIO::DirectorySizeJob *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     QLayoutItem *button = m_grid->itemAtPosition(2, 4);
     if (button && button->widget()) {
         button->widget()->setEnabled(total > 0);
@@ -296,13 +282,8 @@ void TemporaryData::gotAudioSize(KJob *job)
     updateTotal();
 }
 
-void TemporaryData::gotThumbSize(KJob *job)
+void TemporaryData::gotThumbSize(KIO::filesize_t total)
 {
-    KIO::DirectorySizeJob *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     QLayoutItem *button = m_grid->itemAtPosition(3, 4);
     if (button && button->widget()) {
         button->widget()->setEnabled(total > 0);
@@ -363,6 +344,7 @@ void TemporaryData::deleteProxy()
     }
     foreach (const QString &file, files) {
         dir.remove(file);
+        CacheLedger::instance()->removeFile(dir, file);
     }
     emit disableProxies();
     updateDataInfo();
@@ -505,17 +487,36 @@ void TemporaryData::processglobalDirectories()
         return;
     }
     m_processingDirectory = m_globalDirectories.takeFirst();
+    bool isProject = false;
+    m_processingDirectory.toLongLong(&isProject, 10);
+    if (isProject) {
+        // Project cache folders have a usage ledger for each kind of data
+        QDir dir(m_globalDir.absoluteFilePath(m_processingDirectory));
+        KIO::filesize_t total = 0;
+        for (const QString &folder : {QStringLiteral("preview"), QStringLiteral("audiothumbs"), QStringLiteral("videothumbs")}) {
+            if (dir.exists(folder)) {
+                total += static_cast<KIO::filesize_t>(CacheLedger::instance()->usage(QDir(dir.absoluteFilePath(folder))));
+            }
+        }
+        gotFolderSize(total);
+        return;
+    }
     KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(m_globalDir.absoluteFilePath(m_processingDirectory)));
-    connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotFolderSize);
+    connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotFolderJobSize);
 }
 
-void TemporaryData::gotFolderSize(KJob *job)
+void TemporaryData::gotFolderJobSize(KJob *job)
 {
     KIO::DirectorySizeJob *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
     KIO::filesize_t total = sourceJob->totalSize();
     if (sourceJob->totalFiles() == 0) {
         total = 0;
     }
+    gotFolderSize(total);
+}
+
+void TemporaryData::gotFolderSize(KIO::filesize_t total)
+{
     m_totalGlobal += total;
     TreeWidgetItem *item = new TreeWidgetItem(m_listWidget);
     // Check last save path for this cache folder
@@ -122,11 +122,12 @@ private:
     void processglobalDirectories();
 
 private slots:
-    void gotPreviewSize(KJob *job);
+    void gotPreviewSize(KIO::filesize_t total);
     void gotProxySize(KIO::filesize_t total);
-    void gotAudioSize(KJob *job);
-    void gotThumbSize(KJob *job);
-    void gotFolderSize(KJob *job);
+    void gotAudioSize(KIO::filesize_t total);
+    void gotThumbSize(KIO::filesize_t total);
+    void gotFolderJobSize(KJob *job);
+    void gotFolderSize(KIO::filesize_t total);
     void refreshGlobalPie();
     void deletePreview();
     void deleteProxy();
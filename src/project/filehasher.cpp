@@ -0,0 +1,346 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "filehasher.h"
+#include "kdenlive_debug.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+namespace {
+// xxHash64, see https://github.com/Cyan4973/xxHash
+const quint64 prime1 = 11400714785074694791ULL;
+const quint64 prime2 = 14029467366897019727ULL;
+const quint64 prime3 = 1609587929392839161ULL;
+const quint64 prime4 = 9650029242287828579ULL;
+const quint64 prime5 = 2870177450012600261ULL;
+
+inline quint64 rotl(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 read64(const char *data)
+{
+    return qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(data));
+}
+
+inline quint32 read32(const char *data)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+inline quint64 xxhRound(quint64 acc, quint64 input)
+{
+    acc += input * prime2;
+    return rotl(acc, 31) * prime1;
+}
+
+inline quint64 xxhMerge(quint64 acc, quint64 value)
+{
+    acc ^= xxhRound(0, value);
+    return acc * prime1 + prime4;
+}
+
+quint64 xxh64(const char *data, int length, quint64 seed)
+{
+    const char *end = data + length;
+    quint64 h;
+    if (length >= 32) {
+        const char *limit = end - 32;
+        quint64 v1 = seed + prime1 + prime2;
+        quint64 v2 = seed + prime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - prime1;
+        do {
+            v1 = xxhRound(v1, read64(data));
+            v2 = xxhRound(v2, read64(data + 8));
+            v3 = xxhRound(v3, read64(data + 16));
+            v4 = xxhRound(v4, read64(data + 24));
+            data += 32;
+        } while (data <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = xxhMerge(h, v1);
+        h = xxhMerge(h, v2);
+        h = xxhMerge(h, v3);
+        h = xxhMerge(h, v4);
+    } else {
+        h = seed + prime5;
+    }
+    h += (quint64) length;
+    while (data + 8 <= end) {
+        h ^= xxhRound(0, read64(data));
+        h = rotl(h, 27) * prime1 + prime4;
+        data += 8;
+    }
+    if (data + 4 <= end) {
+        h ^= (quint64) read32(data) * prime1;
+        h = rotl(h, 23) * prime2 + prime3;
+        data += 4;
+    }
+    while (data < end) {
+        h ^= (quint64)(uchar) *data * prime5;
+        h = rotl(h, 11) * prime1;
+        data++;
+    }
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+}
+
+class FileHasherCreator
+{
+public:
+    FileHasher object;
+};
+
+Q_GLOBAL_STATIC(FileHasherCreator, creator)
+
+FileHasher::FileHasher()
+    : m_loaded(false)
+{
+}
+
+FileHasher *FileHasher::instance()
+{
+    return &creator->object;
+}
+
+//static
+QString FileHasher::fileKey(const QString &path)
+{
+#ifdef Q_OS_WIN
+    QFileInfo info(path);
+    if (!info.isFile()) {
+        return QString();
+    }
+    return QStringLiteral("%1|%2|%3").arg(info.absoluteFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+#else
+    struct stat info;
+    if (::stat(QFile::encodeName(path).constData(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return QString();
+    }
+#ifdef Q_OS_LINUX
+    const qint64 modified = (qint64) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#else
+    const qint64 modified = (qint64) info.st_mtime;
+#endif
+    return QStringLiteral("%1:%2:%3:%4").arg((quint64) info.st_dev).arg((quint64) info.st_ino).arg((qint64) info.st_size).arg(modified);
+#endif
+}
+
+//static
+QByteArray FileHasher::readHeadAndTail(QFile &file)
+{
+    QByteArray data;
+    if (file.size() > 2000000) {
+        data = file.read(1000000);
+        if (file.seek(file.size() - 1000000)) {
+            data.append(file.readAll());
+        }
+    } else {
+        data = file.readAll();
+    }
+    return data;
+}
+
+//static
+QString FileHasher::fileIdentity(const QString &key)
+{
+    // Drop the size and modification time
+#ifdef Q_OS_WIN
+    return key.section(QLatin1Char('|'), 0, -3);
+#else
+    return key.section(QLatin1Char(':'), 0, -3);
+#endif
+}
+
+void FileHasher::load()
+{
+    m_loaded = true;
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    dir.mkpath(QStringLiteral("."));
+    m_store.setFileName(dir.absoluteFilePath(QStringLiteral("filehashes")));
+    // Entries are appended, so the last lines are the most recently used ones
+    QStringList keys;
+    int lines = 0;
+    if (m_store.open(QIODevice::ReadOnly)) {
+        while (!m_store.atEnd()) {
+            const QString line = QString::fromUtf8(m_store.readLine()).trimmed();
+            const int separator = line.lastIndexOf(QLatin1Char('\t'));
+            if (separator > 0) {
+                const QString key = line.left(separator);
+                const QString previous = m_versions.value(fileIdentity(key));
+                if (!previous.isEmpty() && previous != key) {
+                    // The file changed, forget its older version
+                    m_hashes.remove(previous);
+                }
+                m_versions.insert(fileIdentity(key), key);
+                m_hashes.insert(key, line.mid(separator + 1));
+                keys << key;
+                lines++;
+            }
+        }
+        m_store.close();
+    }
+    const int maxEntries = 20000;
+    const bool prune = m_hashes.count() > maxEntries;
+    if (prune) {
+        // Keep the most recently used files
+        QSet<QString> kept;
+        for (int i = keys.count() - 1; i >= 0 && kept.count() < maxEntries; --i) {
+            if (m_hashes.contains(keys.at(i))) {
+                kept.insert(keys.at(i));
+            }
+        }
+        QHash<QString, QString>::iterator it = m_hashes.begin();
+        while (it != m_hashes.end()) {
+            if (kept.contains(it.key())) {
+                ++it;
+            } else {
+                m_versions.remove(fileIdentity(it.key()));
+                it = m_hashes.erase(it);
+            }
+        }
+    }
+    if (prune || lines > m_hashes.count() + 1000) {
+        // Drop duplicate lines and the entries of files that changed, in usage order
+        if (m_store.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QHash<QString, int> lastLine;
+            for (int i = 0; i < keys.count(); ++i) {
+                lastLine.insert(keys.at(i), i);
+            }
+            for (int i = 0; i < keys.count(); ++i) {
+                const QString &key = keys.at(i);
+                if (lastLine.value(key) == i && m_hashes.contains(key)) {
+                    m_store.write(QString(key + QLatin1Char('\t') + m_hashes.value(key) + QLatin1Char('\n')).toUtf8());
+                }
+            }
+            m_store.close();
+        }
+    }
+    if (!m_store.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write file hash cache" << m_store.fileName();
+    }
+}
+
+void FileHasher::store(const QString &key, const QString &hash)
+{
+    const QString previous = m_versions.value(fileIdentity(key));
+    if (!previous.isEmpty() && previous != key) {
+        m_hashes.remove(previous);
+    }
+    m_versions.insert(fileIdentity(key), key);
+    m_hashes.insert(key, hash);
+    m_used.insert(key);
+    if (m_store.isOpen()) {
+        m_store.write(QString(key + QLatin1Char('\t') + hash + QLatin1Char('\n')).toUtf8());
+        m_store.flush();
+    }
+}
+
+void FileHasher::touch(const QString &key)
+{
+    if (!m_used.contains(key)) {
+        // Append the entry again, it moves to the most recently used ones when pruning
+        store(key, m_hashes.value(key));
+    }
+}
+
+QString FileHasher::cachedHash(const QString &path)
+{
+    const QString key = fileKey(path);
+    if (key.isEmpty()) {
+        return QString();
+    }
+    QMutexLocker lock(&m_mutex);
+    if (!m_loaded) {
+        load();
+    }
+    if (!m_hashes.contains(key)) {
+        return QString();
+    }
+    touch(key);
+    return m_hashes.value(key);
+}
+
+QString FileHasher::hash(const QString &path)
+{
+    const QString key = fileKey(path);
+    if (key.isEmpty()) {
+        return QString();
+    }
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_loaded) {
+            load();
+        }
+        if (m_hashes.contains(key)) {
+            touch(key);
+            return m_hashes.value(key);
+        }
+    }
+    // Read the file without holding the lock, other files can be hashed meanwhile
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    const QByteArray data = readHeadAndTail(file);
+    const quint64 value = xxh64(data.constData(), data.size(), (quint64) file.size());
+    const QString result = QString::number(value, 16).rightJustified(16, QLatin1Char('0'));
+    QMutexLocker lock(&m_mutex);
+    store(key, result);
+    return result;
+}
+
+QFuture<QString> FileHasher::hashAsync(const QString &path)
+{
+    return QtConcurrent::run(this, &FileHasher::hash, path);
+}
+
+//static
+QString FileHasher::legacyHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(readHeadAndTail(file), QCryptographicHash::Md5).toHex());
+}
+
+//static
+bool FileHasher::isLegacyHash(const QString &hash)
+{
+    // MD5 hashes have 32 hexadecimal digits, the fast hash has 16
+    return hash.length() == 32;
+}
@@ -0,0 +1,78 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FILEHASHER_H
+#define FILEHASHER_H
+
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+/**
+ * @class FileHasher
+ * @brief Computes the content hash that identifies a clip file (kdenlive:file_hash).
+ *
+ * The hash covers the first and last megabyte of the file with a fast 64 bit hash. Results
+ * are stored on disk with the file's identity (device, inode, size and modification time),
+ * so that a file is only read again when it changes. Only the latest version of each file
+ * is kept, and the least recently used entries are dropped when the cache grows too large.
+ */
+class FileHasher
+{
+public:
+    static FileHasher *instance();
+    /** @brief Returns the hash of a file, empty if it cannot be read. Can be called from any thread. */
+    QString hash(const QString &path);
+    /** @brief Returns the stored hash of a file if it did not change, without reading the file. */
+    QString cachedHash(const QString &path);
+    /** @brief Hash a file in a worker thread. */
+    QFuture<QString> hashAsync(const QString &path);
+    /** @brief Returns the MD5 based hash that Kdenlive used before, to match older projects. */
+    static QString legacyHash(const QString &path);
+    /** @brief Returns true if the hash was computed by legacyHash. */
+    static bool isLegacyHash(const QString &hash);
+
+private:
+    FileHasher();
+    friend class FileHasherCreator;
+    QMutex m_mutex;
+    bool m_loaded;
+    QHash<QString, QString> m_hashes;
+    /** @brief Key of the latest version of each file, by file identity */
+    QHash<QString, QString> m_versions;
+    /** @brief Keys already written to the cache file in this session */
+    QSet<QString> m_used;
+    QFile m_store;
+    /** @brief Returns a key identifying the file and its version, empty if it does not exist. */
+    static QString fileKey(const QString &path);
+    /** @brief Returns the part of a file key that does not change with the file content. */
+    static QString fileIdentity(const QString &key);
+    /** @brief Record that a cached entry was used, so that it is kept when the cache is pruned. */
+    void touch(const QString &key);
+    static QByteArray readHeadAndTail(QFile &file);
+    void load();
+    void store(const QString &key, const QString &hash);
+};
+
+#endif
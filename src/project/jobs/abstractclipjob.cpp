@@ -22,15 +22,19 @@
 #include "kdenlivesettings.h"
 #include "doc/kdenlivedoc.h"
 
+#include <QThread>
+
 AbstractClipJob::AbstractClipJob(JOBTYPE type, ClipType cType, const QString &id, QObject *parent) :
     QObject(parent),
     clipType(cType),
     jobType(type),
     replaceClip(false),
+    priority(0),
     m_jobStatus(NoJob),
     m_clipId(id),
     m_addClipToProject(-100),
-    m_jobProcess(nullptr)
+    m_jobProcess(nullptr),
+    m_threadLimit(0)
 {
 }
 
@@ -101,3 +105,47 @@ bool AbstractClipJob::isExclusive()
     return true;
 }
 
+AbstractClipJob::JOBRESOURCE AbstractClipJob::resourceClass() const
+{
+    return CPURESOURCE;
+}
+
+int AbstractClipJob::threadCount() const
+{
+    return 1;
+}
+
+void AbstractClipJob::setThreadLimit(int threads)
+{
+    m_threadLimit = threads;
+}
+
+int AbstractClipJob::allowedThreads() const
+{
+    const int threads = qMax(1, threadCount());
+    return m_threadLimit > 0 ? qMin(threads, m_threadLimit) : threads;
+}
+
+//static
+void AbstractClipJob::setFfmpegThreads(QStringList &args, int threads)
+{
+    int ix = args.indexOf(QStringLiteral("-threads"));
+    if (ix > -1 && ix + 1 < args.count()) {
+        args[ix + 1] = QString::number(threads);
+    } else {
+        args << QStringLiteral("-threads") << QString::number(threads);
+    }
+}
+
+//static
+int AbstractClipJob::ffmpegThreads(const QString &params)
+{
+    const QStringList args = params.simplified().split(QLatin1Char(' '));
+    int ix = args.indexOf(QStringLiteral("-threads"));
+    int threads = 0;
+    if (ix > -1 && ix + 1 < args.count()) {
+        threads = args.at(ix + 1).toInt();
+    }
+    // FFmpeg uses all cores by default
+    return threads > 0 ? threads : qMax(1, QThread::idealThreadCount());
+}
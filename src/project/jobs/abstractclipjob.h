@@ -47,12 +47,20 @@ public:
         THUMBJOB = 5,
         ANALYSECLIPJOB = 6
     };
+    /** @brief The resource a job mostly depends on, each class has its own concurrency limit. */
+    enum JOBRESOURCE {
+        DISKRESOURCE = 0,
+        CPURESOURCE = 1,
+        ANALYSISRESOURCE = 2
+    };
     AbstractClipJob(JOBTYPE type, ClipType cType, const QString &id, QObject *parent = nullptr);
     virtual ~ AbstractClipJob();
     ClipType clipType;
     JOBTYPE jobType;
     QString description;
     bool replaceClip;
+    /** @brief Waiting jobs with a higher priority are started first. */
+    int priority;
     const QString clipId() const;
     const QString errorMessage() const;
     const QString logDetails() const;
@@ -65,6 +73,14 @@ public:
     virtual const QString statusMessage();
     /** @brief Returns true if only one instance of this job can be run on a clip. */
     virtual bool isExclusive();
+    /** @brief Returns the resource class used to schedule this job. */
+    virtual JOBRESOURCE resourceClass() const;
+    /** @brief Returns the number of threads this job keeps busy, so that running jobs do not oversubscribe the CPU. */
+    virtual int threadCount() const;
+    /** @brief Set by the job manager before starting the job: the maximum number of threads the job may use. */
+    void setThreadLimit(int threads);
+    /** @brief Returns threadCount() capped by the limit given by the job manager. */
+    int allowedThreads() const;
     int addClipToProject() const;
     void setAddClipToProject(int add);
 
@@ -75,6 +91,12 @@ protected:
     QString m_logDetails;
     int m_addClipToProject;
     QProcess *m_jobProcess;
+    /** @brief Maximum number of threads given by the job manager, 0 if there is no limit. */
+    int m_threadLimit;
+    /** @brief Returns the number of threads used by an FFmpeg command with these parameters. */
+    static int ffmpegThreads(const QString &params);
+    /** @brief Set the -threads option of FFmpeg output arguments to @param threads, appending it if needed. */
+    static void setFfmpegThreads(QStringList &args, int threads);
 
 signals:
     void jobProgress(const QString &, int, int);
@@ -101,6 +101,9 @@ void CutClipJob::startJob()
                 }
             }
 
+            if (resourceClass() == CPURESOURCE) {
+                setFfmpegThreads(parameters, allowedThreads());
+            }
             // Make sure we don't block when proxy file already exists
             parameters << QStringLiteral("-y");
             parameters << m_dest;
@@ -254,6 +257,34 @@ bool CutClipJob::isExclusive()
     return false;
 }
 
+AbstractClipJob::JOBRESOURCE CutClipJob::resourceClass() const
+{
+    if (jobType == AbstractClipJob::ANALYSECLIPJOB) {
+        return ANALYSISRESOURCE;
+    }
+    const QStringList args = m_cutExtraParams.simplified().split(QLatin1Char(' '));
+    auto isCopy = [&args](const QStringList &options) {
+        for (const QString &option : options) {
+            int ix = args.indexOf(option);
+            if (ix > -1 && ix + 1 < args.count() && args.at(ix + 1) == QLatin1String("copy")) {
+                return true;
+            }
+        }
+        return false;
+    };
+    const bool videoCopy = args.contains(QStringLiteral("-vn")) || isCopy(QStringList() << QStringLiteral("-vcodec") << QStringLiteral("-c:v") << QStringLiteral("-codec") << QStringLiteral("-c"));
+    const bool audioCopy = args.contains(QStringLiteral("-an")) || isCopy(QStringList() << QStringLiteral("-acodec") << QStringLiteral("-c:a") << QStringLiteral("-codec") << QStringLiteral("-c"));
+    return (videoCopy && audioCopy) ? DISKRESOURCE : CPURESOURCE;
+}
+
+int CutClipJob::threadCount() const
+{
+    if (resourceClass() != CPURESOURCE) {
+        return 1;
+    }
+    return ffmpegThreads(m_cutExtraParams);
+}
+
 // static
 QList<ProjectClip *> CutClipJob::filterClips(const QList<ProjectClip *> &clips, const QStringList &params)
 {
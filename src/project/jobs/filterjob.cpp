@@ -20,6 +20,7 @@
 
 #include "filterjob.h"
 #include "meltjob.h"
+#include "scenecutjob.h"
 #include "kdenlivesettings.h"
 #include "doc/kdenlivedoc.h"
 #include "bin/projectclip.h"
@@ -124,37 +125,12 @@ QHash<ProjectClip *, AbstractClipJob *> FilterJob::prepareJob(const QList<Projec
             delete d;
             return jobs;
         }
-        // Autosplit filter
-        QMap<QString, QString> producerParams = QMap<QString, QString> ();
-        QMap<QString, QString> filterParams = QMap<QString, QString> ();
-        QMap<QString, QString> consumerParams = QMap<QString, QString> ();
-
-        // Producer params
-        // None
-
-        // Filter params, use a smaller region of the image to speed up operation
-        // In fact, it's faster to rescale whole image than using part of it (bounding=\"25%x25%:15%x15\")
-        filterParams.insert(QStringLiteral("filter"), filterName);
-        filterParams.insert(QStringLiteral("shot_change_list"), QStringLiteral("0"));
-        filterParams.insert(QStringLiteral("denoise"), QStringLiteral("0"));
-
-        // Consumer
-        consumerParams.insert(QStringLiteral("consumer"), QStringLiteral("null"));
-        consumerParams.insert(QStringLiteral("all"), QStringLiteral("1"));
-        consumerParams.insert(QStringLiteral("terminate_on_pause"), QStringLiteral("1"));
-        consumerParams.insert(QStringLiteral("real_time"), QStringLiteral("-1"));
-        // We just want to find scene change, set all mathods to the fastests
-        consumerParams.insert(QStringLiteral("rescale"), QStringLiteral("nearest"));
-        consumerParams.insert(QStringLiteral("deinterlace_method"), QStringLiteral("onefield"));
-        consumerParams.insert(QStringLiteral("top_field_first"), QStringLiteral("-1"));
-
-        // Extra
+        // Autosplit, analysed by SceneCutJob which reports its results like the motion_est filter
         QMap<QString, QString> extraParams;
         extraParams.insert(QStringLiteral("key"), QStringLiteral("shot_change_list"));
         extraParams.insert(QStringLiteral("projecttreefilter"), QStringLiteral("1"));
         QString keyword(QStringLiteral("%count"));
         extraParams.insert(QStringLiteral("resultmessage"), i18n("Found %1 scenes.", keyword));
-        extraParams.insert(QStringLiteral("resize_profile"), QStringLiteral("160"));
         if (ui.store_data->isChecked()) {
             // We want to save result as clip metadata
             extraParams.insert(QStringLiteral("storedata"), QStringLiteral("1"));
@@ -187,14 +163,7 @@ QHash<ProjectClip *, AbstractClipJob *> FilterJob::prepareJob(const QList<Projec
                 in = zone.x();
                 out = zone.y();
             }
-            producerParams.insert(QStringLiteral("in"), QString::number(in));
-            producerParams.insert(QStringLiteral("out"), QString::number(out));
-            producerParams.insert(QStringLiteral("producer"), sources.at(i));
-
-            // Destination
-            // Since this job is only doing analysis, we have a null consumer and no destination
-            MeltJob *job = new MeltJob(clip->clipType(), clip->clipId(), producerParams, filterParams, consumerParams, extraParams);
-            job->description = i18n("Auto split");
+            SceneCutJob *job = new SceneCutJob(clip->clipType(), clip->clipId(), sources.at(i), in, out, extraParams);
             jobs.insert(clip, job);
         }
         return jobs;
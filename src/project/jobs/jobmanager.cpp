@@ -34,7 +34,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "kdenlive_debug.h"
 #include <QAction>
+#include <QSet>
+#include <QThread>
 #include <QtConcurrent>
+#include <algorithm>
 
 #include <KMessageWidget>
 #include <klocalizedstring.h>
@@ -83,15 +86,17 @@ QStringList JobManager::getPendingJobs(const QString &id)
 
 void JobManager::discardJobs(const QString &id, AbstractClipJob::JOBTYPE type)
 {
-    QMutexLocker lock(&m_jobMutex);
+    m_jobMutex.lock();
     for (int i = 0; i < m_jobList.count(); ++i) {
         if (m_jobList.at(i)->clipId() == id && (type == AbstractClipJob::NOJOBTYPE || m_jobList.at(i)->jobType == type)) {
             // discard this job
             m_jobList.at(i)->setStatus(JobAborted);
         }
     }
+    m_jobMutex.unlock();
     emit updateJobStatus(id, type, JobAborted);
-    updateJobCount();
+    // Aborted jobs do not use a slot anymore, start the next ones
+    slotCheckJobProcess();
 }
 
 bool JobManager::hasPendingJob(const QString &clipId, AbstractClipJob::JOBTYPE type)
@@ -109,18 +114,25 @@ bool JobManager::hasPendingJob(const QString &clipId, AbstractClipJob::JOBTYPE t
     return false;
 }
 
-void JobManager::slotCheckJobProcess()
+void JobManager::pruneJobThreads()
 {
-    if (!m_jobThreads.futures().isEmpty()) {
-        // Remove inactive threads
-        QList<QFuture<void> > futures = m_jobThreads.futures();
-        m_jobThreads.clearFutures();
-        for (int i = 0; i < futures.count(); ++i)
-            if (!futures.at(i).isFinished()) {
-                m_jobThreads.addFuture(futures.at(i));
-            }
+    if (m_jobThreads.futures().isEmpty()) {
+        return;
     }
+    // Remove inactive threads
+    const QList<QFuture<void> > futures = m_jobThreads.futures();
+    m_jobThreads.clearFutures();
+    for (const QFuture<void> &future : futures) {
+        if (!future.isFinished()) {
+            m_jobThreads.addFuture(future);
+        }
+    }
+}
+
+void JobManager::slotCheckJobProcess()
+{
     if (m_jobList.isEmpty()) {
+        pruneJobThreads();
         return;
     }
 
@@ -129,7 +141,7 @@ void JobManager::slotCheckJobProcess()
     for (int i = 0; i < m_jobList.count(); ++i) {
         if (m_jobList.at(i)->status() == JobWorking || m_jobList.at(i)->status() == JobWaiting) {
             count ++;
-        } else {
+        } else if (!m_runningJobs.contains(m_jobList.at(i))) {
             // remove finished jobs
             AbstractClipJob *job = m_jobList.takeAt(i);
             job->deleteLater();
@@ -138,9 +150,7 @@ void JobManager::slotCheckJobProcess()
     }
     m_jobMutex.unlock();
     emit jobCount(count);
-    if (m_jobThreads.futures().isEmpty() || m_jobThreads.futures().count() < KdenliveSettings::proxythreads()) {
-        m_jobThreads.addFuture(QtConcurrent::run(this, &JobManager::slotProcessJobs));
-    }
+    slotProcessJobs();
 }
 
 void JobManager::updateJobCount()
@@ -155,82 +165,157 @@ void JobManager::updateJobCount()
     emit jobCount(count);
 }
 
+int JobManager::jobLimit(AbstractClipJob::JOBRESOURCE resource) const
+{
+    switch (resource) {
+    case AbstractClipJob::DISKRESOURCE:
+        return qMax(1, KdenliveSettings::diskjobs());
+    case AbstractClipJob::ANALYSISRESOURCE:
+        return qMax(1, KdenliveSettings::analysisjobs());
+    case AbstractClipJob::CPURESOURCE:
+    default:
+        return qMax(1, KdenliveSettings::proxythreads());
+    }
+}
+
+int JobManager::threadBudget() const
+{
+    if (KdenliveSettings::jobthreadbudget() > 0) {
+        return KdenliveSettings::jobthreadbudget();
+    }
+    return qMax(1, QThread::idealThreadCount());
+}
+
 void JobManager::slotProcessJobs()
 {
-    bool firstPass = true;
-    while (!m_jobList.isEmpty() && !m_abortAllJobs) {
-        AbstractClipJob *job = nullptr;
-        m_jobMutex.lock();
-        for (int i = 0; i < m_jobList.count(); ++i) {
-            if (m_jobList.at(i)->status() == JobWaiting) {
-                job = m_jobList.at(i);
-                job->setStatus(JobWorking);
-                break;
-            }
-        }
-        if (!firstPass) {
-            updateJobCount();
+    // The job that triggered this check may still be returning, so prune before every start
+    pruneJobThreads();
+    if (m_abortAllJobs) {
+        return;
+    }
+    QMutexLocker lock(&m_jobMutex);
+    const int budget = threadBudget();
+    QMap<AbstractClipJob::JOBRESOURCE, int> running;
+    QSet<int> activeClasses;
+    int usedThreads = 0;
+    QList<AbstractClipJob *> waiting;
+    for (AbstractClipJob *job : m_jobList) {
+        if (job->status() == JobWorking) {
+            running[job->resourceClass()]++;
+            usedThreads += job->allowedThreads();
+            activeClasses.insert(job->resourceClass());
+        } else if (job->status() == JobWaiting) {
+            waiting << job;
+            activeClasses.insert(job->resourceClass());
         }
-        m_jobMutex.unlock();
-
-        if (job == nullptr) {
-            break;
+    }
+    if (waiting.isEmpty()) {
+        return;
+    }
+    // Share the budget between the classes that have jobs, and between the jobs of a class,
+    // so that a job using all cores does not prevent the others from running
+    const int classBudget = qMax(1, budget / qMax(1, activeClasses.count()));
+    auto jobThreads = [this, classBudget](AbstractClipJob *job) {
+        return qBound(1, job->threadCount(), qMax(1, classBudget / jobLimit(job->resourceClass())));
+    };
+    // Jobs on clips used in the timeline first, then by priority, keeping the queue order
+    QHash<AbstractClipJob *, int> rank;
+    for (AbstractClipJob *job : waiting) {
+        ProjectClip *clip = m_bin->getBinClip(job->clipId());
+        rank.insert(job, (clip != nullptr && clip->refCount() > 0) ? 1 : 0);
+    }
+    std::stable_sort(waiting.begin(), waiting.end(), [&rank](AbstractClipJob *a, AbstractClipJob *b) {
+        if (rank.value(a) != rank.value(b)) {
+            return rank.value(a) > rank.value(b);
         }
-        firstPass = false;
-        QString destination = job->destination();
-        // Check if the clip is still here
-        ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
-        if (currentClip == nullptr) {
-            job->setStatus(JobDone);
+        return a->priority > b->priority;
+    });
+    for (AbstractClipJob *job : waiting) {
+        const AbstractClipJob::JOBRESOURCE resource = job->resourceClass();
+        if (running.value(resource) >= jobLimit(resource)) {
             continue;
         }
-        // Set clip status to started
-        currentClip->setJobStatus(job->jobType, job->status());
-
-        // Make sure destination path is writable
-        if (!destination.isEmpty()) {
-            QFileInfo file(destination);
-            bool writable = false;
-            if (file.exists()) {
-                if (file.isWritable()) {
-                    writable = true;
-                }
-            } else {
-                QDir dir = file.absoluteDir();
-                if (!dir.exists()) {
-                    writable = dir.mkpath(QStringLiteral("."));
-                } else {
-                    QFileInfo dinfo(dir.absolutePath());
-                    writable = dinfo.isWritable();
-                }
+        const int threads = jobThreads(job);
+        if (usedThreads > 0 && usedThreads + threads > budget) {
+            // Wait for running jobs to free their threads, so that lower priority jobs do not overtake this one
+            break;
+        }
+        running[resource]++;
+        usedThreads += threads;
+        job->setThreadLimit(threads);
+        job->setStatus(JobWorking);
+        m_runningJobs << job;
+        m_jobThreads.addFuture(QtConcurrent::run(this, &JobManager::processJob, job));
+    }
+}
+
+void JobManager::processJob(AbstractClipJob *job)
+{
+    runJob(job);
+    m_jobMutex.lock();
+    m_runningJobs.removeAll(job);
+    m_jobMutex.unlock();
+    // Thread finished, cleanup & start the next jobs
+    emit checkJobProcess();
+}
+
+void JobManager::runJob(AbstractClipJob *job)
+{
+    QString destination = job->destination();
+    // Check if the clip is still here
+    ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
+    if (currentClip == nullptr) {
+        job->setStatus(JobDone);
+        return;
+    }
+    // Set clip status to started
+    currentClip->setJobStatus(job->jobType, job->status());
+
+    // Make sure destination path is writable
+    if (!destination.isEmpty()) {
+        QFileInfo file(destination);
+        bool writable = false;
+        if (file.exists()) {
+            if (file.isWritable()) {
+                writable = true;
             }
-            if (!writable) {
-                emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
-                job->setStatus(JobCrashed);
-                continue;
+        } else {
+            QDir dir = file.absoluteDir();
+            if (!dir.exists()) {
+                writable = dir.mkpath(QStringLiteral("."));
+            } else {
+                QFileInfo dinfo(dir.absolutePath());
+                writable = dinfo.isWritable();
             }
         }
-        connect(job, SIGNAL(jobProgress(QString, int, int)), this, SIGNAL(processLog(QString, int, int)));
-        connect(job, &AbstractClipJob::cancelRunningJob, m_bin, &Bin::slotCancelRunningJob);
-
-        if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
-            connect(job, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)), this, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)));
+        if (!writable) {
+            emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
+            job->setStatus(JobCrashed);
+            return;
         }
-        job->startJob();
-        if (job->status() == JobDone) {
-            emit updateJobStatus(job->clipId(), job->jobType, JobDone);
-            //TODO: replace with more generic clip replacement framework
-            if (job->jobType == AbstractClipJob::PROXYJOB) {
-                m_bin->gotProxy(job->clipId(), destination);
-            } else if (job->addClipToProject() > -100) {
-                emit addClip(destination, job->addClipToProject());
-            }
-        } else if (job->status() == JobCrashed || job->status() == JobAborted) {
-            emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
+    }
+    connect(job, SIGNAL(jobProgress(QString, int, int)), this, SIGNAL(processLog(QString, int, int)));
+    connect(job, &AbstractClipJob::cancelRunningJob, m_bin, &Bin::slotCancelRunningJob);
+
+    if (job->jobType == AbstractClipJob::PROXYJOB) {
+        connect(static_cast<ProxyJob *>(job), &ProxyJob::proxySegmentsReady, m_bin, &Bin::gotProxy);
+        connect(static_cast<ProxyJob *>(job), &ProxyJob::proxySegmentsFinished, m_bin, &Bin::releaseProxySegments);
+    }
+    if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
+        connect(job, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)), this, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)));
+    }
+    job->startJob();
+    if (job->status() == JobDone) {
+        emit updateJobStatus(job->clipId(), job->jobType, JobDone);
+        //TODO: replace with more generic clip replacement framework
+        if (job->jobType == AbstractClipJob::PROXYJOB) {
+            m_bin->gotProxy(job->clipId(), destination);
+        } else if (job->addClipToProject() > -100) {
+            emit addClip(destination, job->addClipToProject());
         }
+    } else if (job->status() == JobCrashed || job->status() == JobAborted) {
+        emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
     }
-    // Thread finished, cleanup & update count
-    QTimer::singleShot(200, this, &JobManager::checkJobProcess);
 }
 
 QList<ProjectClip *> JobManager::filterClips(const QList<ProjectClip *> &clips, AbstractClipJob::JOBTYPE jobType, const QStringList &params)
@@ -250,6 +335,8 @@ void JobManager::prepareJobFromTimeline(ProjectClip *clip, const QMap<QString, Q
 {
     MeltJob *job = new MeltJob(clip->clipType(), clip->clipId(), producerParams, filterParams, consumerParams, extraParams);
     job->description = i18n("Filter %1", extraParams.value(QStringLiteral("finalfilter")));
+    // Requested from the timeline, the user is waiting for the result
+    job->priority = 1;
     launchJob(clip, job);
 }
 
@@ -273,7 +360,7 @@ void JobManager::prepareJobs(const QList<ProjectClip *> &clips, double fps, Abst
     } else if (jobType == AbstractClipJob::FILTERCLIPJOB) {
         jobs = FilterJob::prepareJob(matching, params);
     } else if (jobType == AbstractClipJob::PROXYJOB) {
-        jobs = ProxyJob::prepareJob(m_bin, matching);
+        jobs = ProxyJob::prepareJob(m_bin, fps, matching);
     }
     if (!jobs.isEmpty()) {
         QHashIterator<ProjectClip *, AbstractClipJob *> i(jobs);
@@ -335,6 +422,7 @@ void JobManager::slotCancelJobs()
     }
     m_jobThreads.waitForFinished();
     m_jobThreads.clearFutures();
+    m_runningJobs.clear();
 
     //TODO: undo job cancelation ? not sure it's necessary
     /*QUndoCommand *command = new QUndoCommand();
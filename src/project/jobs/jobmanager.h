@@ -37,6 +37,9 @@ class ProjectClip;
  * @class JobManager
  * @brief This class is responsible for clip jobs management.
  *
+ * Waiting jobs are started by resource class (disk, cpu, analysis), each class having
+ * its own concurrency limit, while the threads declared by the running jobs stay within
+ * a global budget. Jobs on clips used in the timeline are started first.
  */
 
 class JobManager : public QObject
@@ -94,7 +97,9 @@ public:
     QStringList getPendingJobs(const QString &id);
 
 private slots:
+    /** @brief Remove finished jobs and start waiting jobs in the free slots. */
     void slotCheckJobProcess();
+    /** @brief Start the waiting jobs allowed by the class limits and thread budget. */
     void slotProcessJobs();
     void slotProcessLog(const QString &id, int progress, int type, const QString &message);
 
@@ -115,12 +120,23 @@ private:
     QList<AbstractClipJob *> m_jobList;
     /** @brief Holds the threads running a job. */
     QFutureSynchronizer<void> m_jobThreads;
+    /** @brief Jobs whose thread did not return yet, they cannot be deleted. Aborted jobs stay here until their process is stopped. */
+    QList<AbstractClipJob *> m_runningJobs;
     /** @brief Set to true to trigger abortion of all jobs. */
     bool m_abortAllJobs;
     /** @brief Create a proxy for a clip. */
     void createProxy(const QString &id);
     /** @brief Update job count in info widget. */
     void updateJobCount();
+    /** @brief Process a job in a worker thread, then free its slot. */
+    void processJob(AbstractClipJob *job);
+    void runJob(AbstractClipJob *job);
+    /** @brief Returns the number of jobs of a resource class that can run at the same time. */
+    int jobLimit(AbstractClipJob::JOBRESOURCE resource) const;
+    /** @brief Returns the number of threads that running jobs can use. */
+    int threadBudget() const;
+    /** @brief Remove the finished job threads from m_jobThreads. */
+    void pruneJobThreads();
 
 signals:
     void addClip(const QString &, int folderId);
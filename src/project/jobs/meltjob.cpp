@@ -166,7 +166,7 @@ void MeltJob::startJob()
         return;
     }
     if (!m_consumerParams.contains(QStringLiteral("real_time"))) {
-        m_consumer->set("real_time", -KdenliveSettings::mltthreads());
+        m_consumer->set("real_time", -allowedThreads());
     }
     // Process consumer params
     QMapIterator<QString, QString> j(m_consumerParams);
@@ -279,6 +279,19 @@ void MeltJob::emitFrameNumber(int pos)
     }
 }
 
+AbstractClipJob::JOBRESOURCE MeltJob::resourceClass() const
+{
+    return ANALYSISRESOURCE;
+}
+
+int MeltJob::threadCount() const
+{
+    if (m_consumerParams.contains(QStringLiteral("real_time"))) {
+        return qMax(1, qAbs(m_consumerParams.value(QStringLiteral("real_time")).toInt()));
+    }
+    return KdenliveSettings::mltthreads();
+}
+
 void MeltJob::setStatus(ClipJobStatus status)
 {
     m_jobStatus = status;
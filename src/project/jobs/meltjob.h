@@ -67,6 +67,10 @@ public:
     const QString statusMessage() Q_DECL_OVERRIDE;
     /** @brief Sets the status for this job (can be used by the JobManager to abort the job). */
     void setStatus(ClipJobStatus status) Q_DECL_OVERRIDE;
+    /** @brief Filter analysis (stabilization, motion tracking) is processed sequentially. */
+    JOBRESOURCE resourceClass() const Q_DECL_OVERRIDE;
+    /** @brief The number of MLT rendering threads requested through real_time. */
+    int threadCount() const Q_DECL_OVERRIDE;
     /** @brief Here we will send the current progress info to anyone interested. */
     void emitFrameNumber(int pos);
 
@@ -24,15 +24,29 @@
 #include "doc/kdenlivedoc.h"
 #include "bin/projectclip.h"
 #include "bin/bin.h"
+#include "project/cacheledger.h"
+#include "project/sharedcache.h"
+#include <QDomDocument>
 #include <QProcess>
 #include <QTemporaryFile>
+#include <QVector>
 
 #include <klocalizedstring.h>
 
+static void recordProxyFile(const QString &path)
+{
+    // Shared proxies are accounted by the shared cache index
+    if (!SharedCache::instance()->contains(path)) {
+        CacheLedger::instance()->addFile(QFileInfo(path).absoluteDir(), path);
+    }
+}
+
 ProxyJob::ProxyJob(ClipType cType, const QString &id, const QStringList &parameters, QTemporaryFile *playlist)
     : AbstractClipJob(PROXYJOB, cType, id),
       m_jobDuration(0),
-      m_isFfmpegJob(true)
+      m_isFfmpegJob(true),
+      m_frames(0),
+      m_fps(0)
 {
     m_jobStatus = JobWaiting;
     description = i18n("proxy");
@@ -43,11 +57,36 @@ ProxyJob::ProxyJob(ClipType cType, const QString &id, const QStringList &paramet
     m_renderWidth = parameters.at(4).toInt();
     m_renderHeight = parameters.at(5).toInt();
     m_playlist = playlist;
+    if (parameters.count() > 7) {
+        m_frames = parameters.at(6).toInt();
+        m_fps = parameters.at(7).toDouble();
+    }
     replaceClip = true;
 }
 
+int ProxyJob::threadCount() const
+{
+    if (clipType == Playlist || clipType == SlideShow) {
+        return KdenliveSettings::mltthreads();
+    } else if (clipType == Image) {
+        return 1;
+    }
+    return ffmpegThreads(m_proxyParams);
+}
+
 void ProxyJob::startJob()
 {
+    // Encode to a temporary file next to the proxy, other projects use the proxy as soon as it exists
+    const QFileInfo destInfo(m_dest);
+    QTemporaryFile output(destInfo.absolutePath() + QStringLiteral("/.XXXXXX.") + destInfo.suffix());
+    output.setAutoRemove(false);
+    if (!output.open()) {
+        m_errorMessage.append(i18n("Cannot write to %1.", destInfo.absolutePath()));
+        setStatus(JobCrashed);
+        return;
+    }
+    m_output = output.fileName();
+    output.close();
     // Special case: playlist clips (.mlt or .kdenlive project files)
     m_jobDuration = 0;
     if (clipType == Playlist || clipType == SlideShow) {
@@ -55,7 +94,7 @@ void ProxyJob::startJob()
         m_isFfmpegJob = false;
         QStringList mltParameters;
         mltParameters << m_src;
-        mltParameters << QStringLiteral("-consumer") << QStringLiteral("avformat:") + m_dest;
+        mltParameters << QStringLiteral("-consumer") << QStringLiteral("avformat:") + m_output;
         QStringList params = m_proxyParams.split(QLatin1Char('-'), QString::SkipEmptyParts);
         double display_ratio;
         if (m_src.startsWith(QLatin1String("consumer:"))) {
@@ -97,7 +136,7 @@ void ProxyJob::startJob()
             mltParameters << t;
         }
 
-        mltParameters.append(QStringLiteral("real_time=-%1").arg(KdenliveSettings::mltthreads()));
+        mltParameters.append(QStringLiteral("real_time=-%1").arg(allowedThreads()));
 
         //TODO: currently, when rendering an xml file through melt, the display ration is lost, so we enforce it manualy
         mltParameters << QStringLiteral("aspect=") + QLocale().toString(display_ratio);
@@ -115,6 +154,7 @@ void ProxyJob::startJob()
         QImage i(m_src);
         if (i.isNull()) {
             m_errorMessage.append(i18n("Cannot load image %1.", m_src));
+            QFile::remove(m_output);
             setStatus(JobCrashed);
             return;
         }
@@ -158,20 +198,30 @@ void ProxyJob::startJob()
                 break;
             }
             processed = proxy.transformed(matrix);
-            processed.save(m_dest);
+            processed.save(m_output);
         } else {
-            proxy.save(m_dest);
+            proxy.save(m_output);
+        }
+        if (commitOutput()) {
+            recordProxyFile(m_dest);
+            setStatus(JobDone);
+        } else {
+            setStatus(JobCrashed);
         }
-        setStatus(JobDone);
         return;
     } else {
         m_isFfmpegJob = true;
         if (KdenliveSettings::ffmpegpath().isEmpty()) {
             //FFmpeg not detected, cannot process the Job
             m_errorMessage.prepend(i18n("Failed to create proxy. FFmpeg not found, please set path in Kdenlive's settings Environment"));
+            QFile::remove(m_output);
             setStatus(JobCrashed);
             return;
         }
+        if (segmentCount() > 1) {
+            startSegmentedJob();
+            return;
+        }
         QStringList parameters;
         if (m_proxyParams.contains(QStringLiteral("-noautorotate"))) {
             // The noautorotate flag must be passed before input source
@@ -193,9 +243,10 @@ void ProxyJob::startJob()
             }
         }
 
+        setFfmpegThreads(parameters, allowedThreads());
         // Make sure we don't block when proxy file already exists
         parameters << QStringLiteral("-y");
-        parameters << m_dest;
+        parameters << m_output;
         m_jobProcess = new QProcess;
         m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
@@ -207,7 +258,7 @@ void ProxyJob::startJob()
             emit cancelRunningJob(m_clipId, cancelProperties());
             m_jobProcess->close();
             m_jobProcess->waitForFinished();
-            QFile::remove(m_dest);
+            QFile::remove(m_output);
         }
         m_jobProcess->waitForFinished(400);
     }
@@ -216,23 +267,259 @@ void ProxyJob::startJob()
     if (m_jobStatus != JobAborted) {
         int result = m_jobProcess->exitStatus();
         if (result == QProcess::NormalExit) {
-            if (QFileInfo(m_dest).size() == 0) {
+            if (QFileInfo(m_output).size() == 0) {
                 // File was not created
                 processLogInfo();
+                QFile::remove(m_output);
                 m_errorMessage.append(i18n("Failed to create proxy clip."));
                 setStatus(JobCrashed);
-            } else {
+            } else if (commitOutput()) {
+                recordProxyFile(m_dest);
                 setStatus(JobDone);
+            } else {
+                setStatus(JobCrashed);
             }
         } else if (result == QProcess::CrashExit) {
             // Proxy process crashed
-            QFile::remove(m_dest);
+            QFile::remove(m_output);
             setStatus(JobCrashed);
         }
     }
     delete m_jobProcess;
 }
 
+int ProxyJob::segmentCount() const
+{
+    if ((clipType != AV && clipType != Video) || KdenliveSettings::proxysegments() < 2 || m_frames <= 0 || m_fps <= 0 || m_proxyParams.contains(QLatin1String("-i "))) {
+        return 1;
+    }
+    // Segments are at least as long as the configured length
+    const int length = qMax(1, qRound(qMax(60, KdenliveSettings::proxysegmentlength()) * m_fps));
+    return qMax(1, m_frames / length);
+}
+
+void ProxyJob::startSegmentedJob()
+{
+    const int count = segmentCount();
+    const int parallel = qMin(count, KdenliveSettings::proxysegments());
+    // Share the threads of a single encoder between the segments
+    const int threads = qMax(1, allowedThreads() / parallel);
+    const QString extension = QFileInfo(m_dest).suffix();
+    const QString playlistPath = m_output + QStringLiteral(".segments.mlt");
+    QList<QPair<int, int> > ranges;
+    QStringList files;
+    for (int i = 0; i < count; ++i) {
+        ranges << qMakePair((int)((qint64) m_frames * i / count), (int)((qint64) m_frames * (i + 1) / count) - 1);
+        files << QStringLiteral("%1.part%2.%3").arg(m_output).arg(i).arg(extension);
+    }
+    QStringList params;
+    for (const QString &s : m_proxyParams.split(QLatin1Char(' '), QString::SkipEmptyParts)) {
+        if (s != QLatin1String("-noautorotate")) {
+            params << s;
+        }
+    }
+    setFfmpegThreads(params, threads);
+
+    QVector<QProcess *> processes(count, nullptr);
+    QVector<bool> done(count, false);
+    QVector<double> encoded(count, 0);
+    QStringList logs;
+    for (int i = 0; i < count; ++i) {
+        logs << QString();
+    }
+    int next = 0;
+    int running = 0;
+    int finished = 0;
+    bool temporaryProxy = false;
+    m_jobProcess = nullptr;
+    while (finished < count && m_jobStatus == JobWorking) {
+        while (running < parallel && next < count) {
+            QStringList parameters;
+            if (m_proxyParams.contains(QStringLiteral("-noautorotate"))) {
+                parameters << QStringLiteral("-noautorotate");
+            }
+            // Seek before the input, the segment is decoded from the closest key frame
+            parameters << QStringLiteral("-ss") << QString::number(ranges.at(next).first / m_fps, 'f', 3) << QStringLiteral("-i") << m_src;
+            if (next < count - 1) {
+                parameters << QStringLiteral("-t") << QString::number((ranges.at(next).second - ranges.at(next).first + 1) / m_fps, 'f', 3);
+            }
+            parameters << params << QStringLiteral("-y") << files.at(next);
+            QProcess *process = new QProcess;
+            process->setProcessChannelMode(QProcess::MergedChannels);
+            process->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+            process->waitForStarted();
+            processes[next] = process;
+            running++;
+            next++;
+        }
+        for (int i = 0; i < count; ++i) {
+            QProcess *process = processes.at(i);
+            if (process == nullptr) {
+                continue;
+            }
+            process->waitForFinished(400 / running);
+            const QString log = QString::fromUtf8(process->readAll());
+            logs[i].append(log);
+            if (log.contains(QLatin1String("time="))) {
+                const QString time = log.section(QStringLiteral("time="), -1).simplified().section(QLatin1Char(' '), 0, 0);
+                const QStringList numbers = time.split(QLatin1Char(':'));
+                encoded[i] = numbers.count() == 3 ? numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toDouble() : time.toDouble();
+            }
+            if (process->state() != QProcess::NotRunning) {
+                continue;
+            }
+            if (process->exitStatus() == QProcess::NormalExit && process->exitCode() == 0 && QFileInfo(files.at(i)).size() > 0) {
+                done[i] = true;
+                finished++;
+                // Make the encoded parts usable while the other ones are processed
+                if (finished < count && writeSegmentPlaylist(playlistPath, ranges, done, files)) {
+                    emit proxySegmentsReady(m_clipId, playlistPath);
+                    temporaryProxy = true;
+                }
+            } else if (m_jobStatus == JobWorking) {
+                m_logDetails.append(logs.at(i));
+                m_errorMessage.append(i18n("Failed to create proxy clip segment %1.", i + 1));
+                setStatus(JobCrashed);
+            }
+            delete process;
+            processes[i] = nullptr;
+            running--;
+        }
+        double total = 0;
+        for (int i = 0; i < count; ++i) {
+            total += done.at(i) ? (ranges.at(i).second - ranges.at(i).first + 1) / m_fps : encoded.at(i);
+        }
+        emit jobProgress(m_clipId, qMin(99, (int)(100.0 * total * m_fps / m_frames)), jobType);
+    }
+
+    bool success = finished == count && m_jobStatus == JobWorking;
+    if (m_jobStatus == JobAborted) {
+        emit cancelRunningJob(m_clipId, cancelProperties());
+    }
+    for (QProcess *process : processes) {
+        if (process) {
+            process->close();
+            process->waitForFinished();
+            delete process;
+        }
+    }
+    if (success) {
+        // Join the segments without re-encoding
+        const QString listPath = m_output + QStringLiteral(".segments.txt");
+        QFile list(listPath);
+        if (list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream out(&list);
+            for (const QString &file : files) {
+                QString escaped = file;
+                out << "file '" << escaped.replace(QLatin1Char('\''), QLatin1String("'\\''")) << "'\n";
+            }
+            list.close();
+            QStringList parameters;
+            parameters << QStringLiteral("-f") << QStringLiteral("concat") << QStringLiteral("-safe") << QStringLiteral("0") << QStringLiteral("-i") << listPath << QStringLiteral("-c") << QStringLiteral("copy") << QStringLiteral("-y") << m_output;
+            m_jobProcess = new QProcess;
+            m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
+            m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+            m_jobProcess->waitForStarted();
+            while (m_jobProcess->state() != QProcess::NotRunning) {
+                if (m_jobStatus == JobAborted) {
+                    emit cancelRunningJob(m_clipId, cancelProperties());
+                    m_jobProcess->close();
+                }
+                m_jobProcess->waitForFinished(400);
+            }
+            m_logDetails.append(QString::fromUtf8(m_jobProcess->readAll()));
+            success = m_jobStatus == JobWorking && m_jobProcess->exitStatus() == QProcess::NormalExit && m_jobProcess->exitCode() == 0 && QFileInfo(m_output).size() > 0;
+            delete m_jobProcess;
+            m_jobProcess = nullptr;
+            QFile::remove(listPath);
+        } else {
+            success = false;
+        }
+        if (!success && m_jobStatus == JobWorking) {
+            m_errorMessage.append(i18n("Failed to join the proxy clip segments."));
+            setStatus(JobCrashed);
+        }
+    }
+    if (temporaryProxy) {
+        // The clip still uses the segments, the bin deletes them when the proxy is replaced
+        emit proxySegmentsFinished(m_clipId, QStringList(files) << playlistPath);
+    } else {
+        for (const QString &file : files) {
+            QFile::remove(file);
+        }
+        QFile::remove(playlistPath);
+    }
+    if (!success) {
+        QFile::remove(m_output);
+    } else if (commitOutput()) {
+        recordProxyFile(m_dest);
+        setStatus(JobDone);
+    } else {
+        setStatus(JobCrashed);
+    }
+}
+
+bool ProxyJob::commitOutput()
+{
+    if (QFileInfo(m_dest).size() == 0) {
+        // Remove an empty file left by an interrupted job
+        QFile::remove(m_dest);
+    }
+    if (!QFile::rename(m_output, m_dest)) {
+        QFile::remove(m_output);
+        if (QFileInfo(m_dest).size() > 0) {
+            // Another project created the same proxy in the meantime
+            return true;
+        }
+        m_errorMessage.append(i18n("Cannot move the proxy clip to %1.", m_dest));
+        return false;
+    }
+    return true;
+}
+
+bool ProxyJob::writeSegmentPlaylist(const QString &path, const QList<QPair<int, int> > &ranges, const QVector<bool> &done, const QStringList &files) const
+{
+    QDomDocument doc;
+    QDomElement mlt = doc.createElement(QStringLiteral("mlt"));
+    mlt.setAttribute(QStringLiteral("LC_NUMERIC"), QStringLiteral("C"));
+    doc.appendChild(mlt);
+    auto addProducer = [&doc, &mlt](const QString &id, const QString &resource) {
+        QDomElement producer = doc.createElement(QStringLiteral("producer"));
+        producer.setAttribute(QStringLiteral("id"), id);
+        QDomElement prop = doc.createElement(QStringLiteral("property"));
+        prop.setAttribute(QStringLiteral("name"), QStringLiteral("resource"));
+        prop.appendChild(doc.createTextNode(resource));
+        producer.appendChild(prop);
+        mlt.appendChild(producer);
+    };
+    addProducer(QStringLiteral("source"), m_src);
+    QDomElement playlist = doc.createElement(QStringLiteral("playlist"));
+    playlist.setAttribute(QStringLiteral("id"), QStringLiteral("segments"));
+    for (int i = 0; i < ranges.count(); ++i) {
+        QDomElement entry = doc.createElement(QStringLiteral("entry"));
+        if (done.at(i)) {
+            const QString id = QStringLiteral("segment%1").arg(i);
+            addProducer(id, files.at(i));
+            entry.setAttribute(QStringLiteral("producer"), id);
+            entry.setAttribute(QStringLiteral("in"), 0);
+            entry.setAttribute(QStringLiteral("out"), ranges.at(i).second - ranges.at(i).first);
+        } else {
+            entry.setAttribute(QStringLiteral("producer"), QStringLiteral("source"));
+            entry.setAttribute(QStringLiteral("in"), ranges.at(i).first);
+            entry.setAttribute(QStringLiteral("out"), ranges.at(i).second);
+        }
+        playlist.appendChild(entry);
+    }
+    mlt.appendChild(playlist);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    file.write(doc.toByteArray());
+    file.close();
+    return true;
+}
+
 void ProxyJob::processLogInfo()
 {
     if (!m_jobProcess || m_jobStatus == JobAborted) {
@@ -322,11 +609,12 @@ QList<ProjectClip *> ProxyJob::filterClips(const QList<ProjectClip *> &clips)
 }
 
 // static
-QHash<ProjectClip *, AbstractClipJob *> ProxyJob::prepareJob(Bin *bin, const QList<ProjectClip *> &clips)
+QHash<ProjectClip *, AbstractClipJob *> ProxyJob::prepareJob(Bin *bin, double fps, const QList<ProjectClip *> &clips)
 {
     QHash<ProjectClip *, AbstractClipJob *> jobs;
     QSize renderSize = bin->getRenderSize();
     QString params = bin->getDocumentProperty(QStringLiteral("proxyparams")).simplified();
+    QStringList proxyPaths;
     for (int i = 0; i < clips.count(); i++) {
         ProjectClip *item = clips.at(i);
         QString id = item->clipId();
@@ -337,6 +625,7 @@ QHash<ProjectClip *, AbstractClipJob *> ProxyJob::prepareJob(Bin *bin, const QLi
         }
         // Reset proxy path until it is really created
         item->setProducerProperty(QStringLiteral("kdenlive:proxy"), QString());
+        proxyPaths << path;
         if (QFileInfo(path).size() > 0) {
             // Proxy already created
             item->setJobStatus(AbstractClipJob::PROXYJOB, JobDone);
@@ -366,9 +655,13 @@ QHash<ProjectClip *, AbstractClipJob *> ProxyJob::prepareJob(Bin *bin, const QLi
         }
         qCDebug(KDENLIVE_LOG)<<" * *PROXY PATH: "<<path<<", "<<sourcePath;
         parameters << path << sourcePath << item->getProducerProperty(QStringLiteral("_exif_orientation")) << params << QString::number(renderSize.width()) << QString::number(renderSize.height());
+        parameters << QString::number(item->duration().frames(fps)) << QString::number(fps, 'f');
         ProxyJob *job = new ProxyJob(item->clipType(), id, parameters, playlist);
         jobs.insert(item, job);
     }
+    if (SharedCache::isEnabled()) {
+        SharedCache::instance()->addReferences(proxyPaths, bin->getDocumentProperty(QStringLiteral("documentid")));
+    }
     return jobs;
 }
 
@@ -39,11 +39,14 @@ public:
     stringMap cancelProperties() Q_DECL_OVERRIDE;
     const QString statusMessage() Q_DECL_OVERRIDE;
     void processLogInfo() Q_DECL_OVERRIDE;
+    int threadCount() const Q_DECL_OVERRIDE;
     static QList<ProjectClip *> filterClips(const QList<ProjectClip *> &clips);
-    static QHash<ProjectClip *, AbstractClipJob *> prepareJob(Bin *bin, const QList<ProjectClip *> &clips);
+    static QHash<ProjectClip *, AbstractClipJob *> prepareJob(Bin *bin, double fps, const QList<ProjectClip *> &clips);
 
 private:
     QString m_dest;
+    /** @brief Temporary file receiving the encoded proxy, renamed to m_dest once complete */
+    QString m_output;
     QString m_src;
     int m_exif;
     QString m_proxyParams;
@@ -52,6 +55,23 @@ private:
     int m_jobDuration;
     bool m_isFfmpegJob;
     QTemporaryFile *m_playlist;
+    /** @brief Clip duration in project frames, used to split long clips in segments */
+    int m_frames;
+    double m_fps;
+    /** @brief Returns the number of segments encoded separately for this clip, 1 if it is encoded in one pass. */
+    int segmentCount() const;
+    /** @brief Encode the clip segments concurrently, then concatenate them in the proxy file. */
+    void startSegmentedJob();
+    /** @brief Move the complete proxy from m_output to m_dest, returns false on failure. */
+    bool commitOutput();
+    /** @brief Write an MLT playlist using the encoded segments, and the original clip for the others. */
+    bool writeSegmentPlaylist(const QString &path, const QList<QPair<int, int> > &ranges, const QVector<bool> &done, const QStringList &files) const;
+
+signals:
+    /** @brief Some segments are encoded, the temporary proxy @param path can be used until the job is finished. */
+    void proxySegmentsReady(const QString &id, const QString &path);
+    /** @brief The job is over, the segment @param files used by the temporary proxy can be deleted once it is replaced. */
+    void proxySegmentsFinished(const QString &id, const QStringList &files);
 };
 
 #endif
@@ -0,0 +1,267 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scenecutjob.h"
+#include "kdenlivesettings.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <klocalizedstring.h>
+
+#include <mlt++/Mlt.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Height of the decoded frames, enough to detect a change of scene
+#define ANALYSIS_HEIGHT 72
+// Number of luma histogram bins
+#define HISTOGRAM_BINS 64
+// Minimum number of frames analysed by a segment
+#define MIN_SEGMENT_FRAMES 250
+
+/** @brief Returns the sum of absolute differences between two luma planes of @param size bytes. */
+static quint64 lumaDifference(const uchar *a, const uchar *b, int size)
+{
+    quint64 sum = 0;
+    int i = 0;
+#ifdef __SSE2__
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sum = (quint64) _mm_cvtsi128_si32(acc) + (quint64) _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+    for (; i < size; ++i) {
+        sum += (quint64) qAbs(a[i] - b[i]);
+    }
+    return sum;
+}
+
+SceneCutJob::SceneCutJob(ClipType cType, const QString &id, const QString &url, int in, int out, const stringMap &extraParams)
+    : AbstractClipJob(MLTJOB, cType, id),
+      m_url(url),
+      m_in(qMax(0, in)),
+      m_out(out),
+      m_extra(extraParams)
+{
+    m_jobStatus = JobWaiting;
+    description = i18n("Auto split");
+}
+
+SceneCutJob::~SceneCutJob()
+{
+}
+
+int SceneCutJob::segmentCount() const
+{
+    int count = qBound(1, QThread::idealThreadCount(), 8);
+    if (m_out > m_in) {
+        count = qBound(1, (m_out - m_in) / MIN_SEGMENT_FRAMES, count);
+    }
+    return count;
+}
+
+void SceneCutJob::startJob()
+{
+    if (m_url.isEmpty()) {
+        m_errorMessage.append(i18n("No producer for this clip."));
+        setStatus(JobCrashed);
+        return;
+    }
+    if (m_out != -1 && m_out <= m_in) {
+        m_errorMessage.append(i18n("Clip zone undefined (%1 - %2).", m_in, m_out));
+        setStatus(JobCrashed);
+        return;
+    }
+    if (m_out == -1) {
+        Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+        Mlt::Producer producer(profile, m_url.toUtf8().constData());
+        if (!producer.is_valid()) {
+            setStatus(JobCrashed);
+            return;
+        }
+        m_out = producer.get_length() - 1;
+        if (m_out <= m_in) {
+            m_errorMessage.append(i18n("Clip zone undefined (%1 - %2).", m_in, m_out));
+            setStatus(JobCrashed);
+            return;
+        }
+    }
+    if (m_in > 0 && !m_extra.contains(QStringLiteral("offset"))) {
+        m_extra.insert(QStringLiteral("offset"), QString::number(m_in));
+    }
+    if (!m_extra.contains(QStringLiteral("key"))) {
+        m_extra.insert(QStringLiteral("key"), QStringLiteral("shot_change_list"));
+    }
+
+    // Split the zone in segments analysed in parallel, each one also decodes the last frame of the previous one
+    const int segments = segmentCount();
+    const int length = m_out - m_in + 1;
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(segments, allowedThreads()));
+    QList<QFuture<QStringList> > futures;
+    for (int i = 0; i < segments; ++i) {
+        int segIn = m_in + length * i / segments;
+        int segOut = m_in + length * (i + 1) / segments - 1;
+        futures << QtConcurrent::run(&pool, this, &SceneCutJob::analyseSegment, segIn, segOut);
+    }
+    bool running = true;
+    while (running) {
+        running = false;
+        for (const QFuture<QStringList> &future : futures) {
+            if (!future.isFinished()) {
+                running = true;
+                break;
+            }
+        }
+        if (running) {
+            QThread::msleep(200);
+        }
+        if (m_jobStatus == JobWorking) {
+            emit jobProgress(m_clipId, qMin(99, 100 * m_processed.load() / length), jobType);
+        }
+    }
+    if (m_jobStatus != JobWorking) {
+        return;
+    }
+    QStringList cuts;
+    for (const QFuture<QStringList> &future : futures) {
+        cuts << future.result();
+    }
+    if (cuts.contains(QStringLiteral("error"))) {
+        // A segment could not be analysed, the cut list would be incomplete
+        m_errorMessage.append(i18n("Cannot open file %1", m_url));
+        setStatus(JobCrashed);
+        return;
+    }
+    QMap<QString, QString> jobResults;
+    jobResults.insert(m_extra.value(QStringLiteral("key")), cuts.join(QLatin1Char(';')));
+    emit gotFilterJobResults(m_clipId, -1, -1, jobResults, m_extra);
+    m_jobStatus = JobDone;
+}
+
+QStringList SceneCutJob::analyseSegment(int in, int out)
+{
+    QStringList cuts;
+    Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+    // Decode at a very low resolution, the scaling is done by the producer
+    int width = (int)(ANALYSIS_HEIGHT * profile.dar() + 0.5);
+    width += width % 2;
+    profile.set_height(ANALYSIS_HEIGHT);
+    profile.set_width(width);
+    Mlt::Producer producer(profile, m_url.toUtf8().constData());
+    if (!producer.is_valid()) {
+        cuts << QStringLiteral("error");
+        return cuts;
+    }
+    // We only need the picture, and the loop filter does not matter for analysis
+    producer.set("audio_index", -1);
+    producer.set("skip_loop_filter", "all");
+    const int size = width * ANALYSIS_HEIGHT;
+    QVector<uchar> previousLuma(size);
+    QVector<uchar> luma(size);
+    QVector<int> previousHistogram(HISTOGRAM_BINS);
+    QVector<int> histogram(HISTOGRAM_BINS);
+    bool hasPrevious = false;
+    int pos = in > m_in ? in - 1 : in;
+    for (; pos <= out; ++pos) {
+        if (m_jobStatus == JobAborted) {
+            break;
+        }
+        producer.seek(pos);
+        Mlt::Frame *frame = producer.get_frame();
+        if (!frame || !frame->is_valid()) {
+            delete frame;
+            hasPrevious = false;
+            continue;
+        }
+        frame->set("rescale.interp", "nearest");
+        frame->set("deinterlace_method", "onefield");
+        frame->set("top_field_first", -1);
+        mlt_image_format format = mlt_image_yuv422;
+        int w = width;
+        int h = ANALYSIS_HEIGHT;
+        const uchar *image = frame->get_image(format, w, h);
+        if (!image || w != width || h != ANALYSIS_HEIGHT) {
+            delete frame;
+            hasPrevious = false;
+            continue;
+        }
+        // Packed YUYV, keep the luma samples
+        histogram.fill(0);
+        uchar *lumaData = luma.data();
+        for (int i = 0; i < size; ++i) {
+            lumaData[i] = image[2 * i];
+            histogram[lumaData[i] >> 2]++;
+        }
+        delete frame;
+        if (hasPrevious) {
+            int histogramDiff = 0;
+            for (int i = 0; i < HISTOGRAM_BINS; ++i) {
+                histogramDiff += qAbs(histogram.at(i) - previousHistogram.at(i));
+            }
+            double histogramScore = histogramDiff / (2.0 * size);
+            double lumaScore = lumaDifference(lumaData, previousLuma.constData(), size) / (255.0 * size);
+            // A large change in the luma distribution, or a smaller one with a large pixel difference
+            if (histogramScore >= 0.4 || (histogramScore >= 0.25 && lumaScore >= 0.1)) {
+                cuts << QStringLiteral("%1=%2").arg(pos - m_in).arg((int)(100 * histogramScore));
+            }
+        }
+        luma.swap(previousLuma);
+        histogram.swap(previousHistogram);
+        hasPrevious = true;
+        if (pos >= in) {
+            m_processed.fetchAndAddRelaxed(1);
+        }
+    }
+    return cuts;
+}
+
+const QString SceneCutJob::statusMessage()
+{
+    QString statusInfo;
+    switch (m_jobStatus) {
+    case JobWorking:
+        statusInfo = description;
+        break;
+    case JobWaiting:
+        statusInfo = i18n("Waiting to process clip");
+        break;
+    default:
+        break;
+    }
+    return statusInfo;
+}
+
+AbstractClipJob::JOBRESOURCE SceneCutJob::resourceClass() const
+{
+    return ANALYSISRESOURCE;
+}
+
+int SceneCutJob::threadCount() const
+{
+    return segmentCount();
+}
@@ -0,0 +1,72 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCENECUTJOB
+#define SCENECUTJOB
+
+#include "abstractclipjob.h"
+
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+ * @class SceneCutJob
+ * @brief Detects scene changes in a clip, returning them like MLT's motion_est shot_change_list.
+ *
+ * Frames are decoded at a very low resolution and compared using their luma histogram
+ * and pixel differences. The clip is split in segments analysed in parallel.
+ */
+
+class SceneCutJob : public AbstractClipJob
+{
+    Q_OBJECT
+
+public:
+    /** @brief Creates the Job.
+     *  @param url the clip file
+     *  @param in first frame to analyse
+     *  @param out last frame to analyse, -1 for the end of the clip
+     *  @param extraParams tell the bin what to do with the result (markers, cuts), as for MeltJob
+     */
+    SceneCutJob(ClipType cType, const QString &id, const QString &url, int in, int out, const stringMap &extraParams);
+    virtual ~ SceneCutJob();
+    void startJob() Q_DECL_OVERRIDE;
+    const QString statusMessage() Q_DECL_OVERRIDE;
+    JOBRESOURCE resourceClass() const Q_DECL_OVERRIDE;
+    int threadCount() const Q_DECL_OVERRIDE;
+
+private:
+    QString m_url;
+    int m_in;
+    int m_out;
+    stringMap m_extra;
+    /** @brief Frames analysed by all segments, for progress reporting */
+    QAtomicInt m_processed;
+    /** @brief Analyse frames from @param in to @param out, returns the cuts as position=score. */
+    QStringList analyseSegment(int in, int out);
+    /** @brief Returns the number of segments analysed in parallel. */
+    int segmentCount() const;
+
+signals:
+    void gotFilterJobResults(const QString &id, int startPos, int track, const stringMap &result, const stringMap &extra);
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "parallelgzipdevice.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <zlib.h>
+
+static const int blockSize = 1024 * 1024;
+static const int dictionarySize = 32 * 1024;
+
+ParallelGzipDevice::ParallelGzipDevice(const QString &fileName, QObject *parent)
+    : QIODevice(parent)
+    , m_file(fileName)
+    , m_maxBlocks(2 * QThread::idealThreadCount())
+    , m_crc(0)
+    , m_inputSize(0)
+    , m_failed(false)
+{
+}
+
+ParallelGzipDevice::~ParallelGzipDevice()
+{
+    if (isOpen()) {
+        close();
+    }
+}
+
+bool ParallelGzipDevice::open(OpenMode mode)
+{
+    if ((mode & ReadOnly) != 0 || !m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    m_crc = crc32(0L, Z_NULL, 0);
+    m_inputSize = 0;
+    m_failed = false;
+    m_pending.clear();
+    m_dictionary.clear();
+    // gzip member header: deflate, no flags, no timestamp, unix
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+    if (m_file.write(header, sizeof(header)) != sizeof(header)) {
+        m_file.close();
+        return false;
+    }
+    return QIODevice::open(mode);
+}
+
+void ParallelGzipDevice::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    queueBlock(m_pending, true);
+    m_pending.clear();
+    while (!m_blocks.isEmpty()) {
+        writeBlock();
+    }
+    char trailer[8];
+    quint32 inputSize = (quint32)m_inputSize;
+    for (int i = 0; i < 4; ++i) {
+        trailer[i] = (char)((m_crc >> (8 * i)) & 0xff);
+        trailer[i + 4] = (char)((inputSize >> (8 * i)) & 0xff);
+    }
+    if (m_file.write(trailer, sizeof(trailer)) != sizeof(trailer) || !m_file.flush()) {
+        m_failed = true;
+    }
+    m_file.close();
+    QIODevice::close();
+}
+
+bool ParallelGzipDevice::seek(qint64 pos)
+{
+    return pos == this->pos();
+}
+
+qint64 ParallelGzipDevice::size() const
+{
+    return pos();
+}
+
+bool ParallelGzipDevice::failed() const
+{
+    return m_failed;
+}
+
+qint64 ParallelGzipDevice::readData(char *data, qint64 maxSize)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(maxSize)
+    return -1;
+}
+
+qint64 ParallelGzipDevice::writeData(const char *data, qint64 size)
+{
+    if (m_failed) {
+        return -1;
+    }
+    m_pending.append(data, (int)size);
+    while (m_pending.size() >= blockSize) {
+        queueBlock(m_pending.left(blockSize), false);
+        m_pending.remove(0, blockSize);
+    }
+    return size;
+}
+
+void ParallelGzipDevice::queueBlock(const QByteArray &data, bool last)
+{
+    while (m_blocks.count() >= m_maxBlocks) {
+        writeBlock();
+    }
+    m_blocks.enqueue(QtConcurrent::run(&ParallelGzipDevice::compressBlock, data, m_dictionary, last));
+    m_dictionary = data.right(dictionarySize);
+}
+
+void ParallelGzipDevice::writeBlock()
+{
+    const Block block = m_blocks.dequeue().result();
+    m_crc = crc32_combine(m_crc, block.crc, block.size);
+    m_inputSize += block.size;
+    if (m_failed || !block.ok || m_file.write(block.data) != block.data.size()) {
+        m_failed = true;
+    }
+}
+
+ParallelGzipDevice::Block ParallelGzipDevice::compressBlock(const QByteArray &data, const QByteArray &dictionary, bool last)
+{
+    Block block;
+    block.ok = false;
+    block.size = data.size();
+    block.crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(data.constData()), (uInt)data.size());
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    // Raw deflate, the gzip header and trailer are written by the device
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return block;
+    }
+    if (!dictionary.isEmpty() && deflateSetDictionary(&stream, reinterpret_cast<const Bytef *>(dictionary.constData()), (uInt)dictionary.size()) != Z_OK) {
+        deflateEnd(&stream);
+        return block;
+    }
+    // Sync flush ends the block on a byte boundary so that blocks can be concatenated
+    block.data.resize((int)deflateBound(&stream, (uLong)data.size()) + 16);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = (uInt)data.size();
+    stream.next_out = reinterpret_cast<Bytef *>(block.data.data());
+    stream.avail_out = (uInt)block.data.size();
+    const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    // The output buffer is large enough to compress the whole block in one call
+    block.ok = stream.avail_in == 0 && result == (last ? Z_STREAM_END : Z_OK);
+    block.data.resize((int)stream.total_out);
+    deflateEnd(&stream);
+    return block;
+}
@@ -0,0 +1,78 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PARALLELGZIPDEVICE_H
+#define PARALLELGZIPDEVICE_H
+
+#include <QFile>
+#include <QFuture>
+#include <QIODevice>
+#include <QQueue>
+
+/**
+ * @class ParallelGzipDevice
+ * @brief Write only device producing a gzip file, compressing blocks of data in parallel.
+ *
+ * Data is split in blocks that are deflated by the global thread pool, each block using
+ * the end of the previous one as dictionary. The blocks are then written in order as a
+ * single gzip stream, readable by any gzip decoder.
+ */
+class ParallelGzipDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit ParallelGzipDevice(const QString &fileName, QObject *parent = nullptr);
+    ~ParallelGzipDevice();
+    bool open(OpenMode mode) Q_DECL_OVERRIDE;
+    void close() Q_DECL_OVERRIDE;
+    /** @brief Only seeking to the current position is possible */
+    bool seek(qint64 pos) Q_DECL_OVERRIDE;
+    qint64 size() const Q_DECL_OVERRIDE;
+    /** @brief Returns true if writing the compressed file failed */
+    bool failed() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+    qint64 writeData(const char *data, qint64 size) Q_DECL_OVERRIDE;
+
+private:
+    struct Block {
+        QByteArray data;
+        quint32 crc;
+        qint64 size;
+        /** @brief False if the block could not be compressed */
+        bool ok;
+    };
+    QFile m_file;
+    QByteArray m_pending;
+    QByteArray m_dictionary;
+    QQueue<QFuture<Block> > m_blocks;
+    int m_maxBlocks;
+    quint32 m_crc;
+    qint64 m_inputSize;
+    bool m_failed;
+    void queueBlock(const QByteArray &data, bool last);
+    void writeBlock();
+    static Block compressBlock(const QByteArray &data, const QByteArray &dictionary, bool last);
+};
+
+#endif
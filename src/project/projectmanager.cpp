@@ -17,9 +17,11 @@ the Free Software Foundation, either version 3 of the License, or
 #include "kdenlivesettings.h"
 #include "monitor/monitormanager.h"
 #include "doc/kdenlivedoc.h"
+#include "doc/autosavejournal.h"
 #include "timeline/timeline.h"
 #include "project/dialogs/projectsettings.h"
 #include "timeline/customtrackview.h"
+#include "timeline/timelinecommands.h"
 #include "transitionsettings.h"
 #include "project/dialogs/archivewidget.h"
 #include "effectstack/effectstackview2.h"
@@ -35,6 +37,7 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include <QProgressDialog>
 #include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QAction>
 #include "kdenlive_debug.h"
@@ -255,6 +258,9 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
             break;
         }
     }
+    if (m_project) {
+        m_project->releaseSharedFiles();
+    }
     if (!quit && !qApp->isSavingSession()) {
         m_autoSaveTimer.stop();
         if (m_project) {
@@ -277,23 +283,22 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 bool ProjectManager::saveFileAs(const QString &outputFileName)
 {
     pCore->monitorManager()->pauseActiveMonitor();
+    // The autosave file is written in a thread
+    m_project->waitForAutoSave();
     // Sync document properties
     prepareSave();
     QString saveFolder = QFileInfo(outputFileName).absolutePath();
-    QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
-    if (m_project->saveSceneList(outputFileName, scene) == false) {
+    bool multitrackEnabled = hideTimelineOverlays();
+    bool saved = m_project->saveSceneList(outputFileName, saveFolder, m_replacementPattern);
+    restoreTimelineOverlays(multitrackEnabled);
+    if (!saved) {
         return false;
     }
     QUrl url = QUrl::fromLocalFile(outputFileName);
     // Save timeline thumbnails
     m_trackView->projectView()->saveThumbnails();
+    // The journal only holds changes that are now in the project file
+    m_project->resetAutoSaveJournal();
     m_project->setUrl(url);
     // setting up autosave file in ~/.kde/data/stalefiles/kdenlive/
     // saved under file name
@@ -458,6 +463,7 @@ bool ProjectManager::checkForBackupFile(const QUrl &url, bool newFile)
             // remove the stale files
             foreach (KAutoSaveFile *stale, staleFiles) {
                 stale->open(QIODevice::ReadWrite);
+                AutoSaveJournal::clear(stale->fileName());
                 delete stale;
             }
         }
@@ -516,6 +522,9 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
         return;
     }
     m_fileRevert->setEnabled(true);
+    // Time to interactive, logged for each loading step
+    QElapsedTimer loadTime;
+    loadTime.start();
 
     // Recreate stopmotion widget on document change
     if (pCore->window()->m_stopmotion) {
@@ -530,6 +539,8 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     m_progressDialog->setLabelText(i18n("Loading project"));
     m_progressDialog->setMaximum(0);
     m_progressDialog->show();
+    // Timeline edits written after the recovered autosave
+    const QList<QJsonObject> journal = stale ? AutoSaveJournal::records(stale->fileName()) : QList<QJsonObject>();
     bool openBackup;
     m_notesPlugin->clear();
     KdenliveDoc *doc = new KdenliveDoc(stale ? QUrl::fromLocalFile(stale->fileName()) : url, QString(), pCore->window()->m_commandStack, KdenliveSettings::default_profile().isEmpty() ? KdenliveSettings::current_profile() : KdenliveSettings::default_profile(), QMap<QString, QString> (), QMap<QString, QString> (), QPoint(KdenliveSettings::videotracks(), KdenliveSettings::audiotracks()), pCore->monitorManager()->projectMonitor()->render, m_notesPlugin, &openBackup, pCore->window());
@@ -550,6 +561,7 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
         doc->setModified(true);
         stale->setParent(doc);
     }
+    qCDebug(KDENLIVE_LOG) << "// Project document ready in" << loadTime.elapsed() << "ms";
     m_progressDialog->setLabelText(i18n("Loading clips"));
     pCore->bin()->setDocument(doc);
 
@@ -569,6 +581,7 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     m_trackView->videoTarget = doc->getDocumentProperty(QStringLiteral("videotargettrack"), QStringLiteral("-1")).toInt();
     m_trackView->loadTimeline();
     m_trackView->loadGuides(pCore->binController()->takeGuidesData());
+    qCDebug(KDENLIVE_LOG) << "// Project timeline loaded in" << loadTime.elapsed() << "ms";
     connect(m_trackView->projectView(), SIGNAL(importPlaylistClips(ItemInfo, QString, QUndoCommand *)), pCore->bin(), SLOT(slotExpandUrl(ItemInfo, QString, QUndoCommand *)), Qt::DirectConnection);
     pCore->window()->connectDocument();
     bool disabled = m_project->getDocumentProperty(QStringLiteral("disabletimelineeffects")) == QLatin1String("1");
@@ -591,6 +604,9 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
         return;
     }
     m_trackView->setDuration(m_trackView->duration());
+    if (!journal.isEmpty()) {
+        replayJournal(journal);
+    }
 
     pCore->window()->slotGotProgressInfo(QString(), 100);
     pCore->monitorManager()->projectMonitor()->adjustRulerSize(m_trackView->duration() - 1);
@@ -600,6 +616,26 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     m_lastSave.start();
     delete m_progressDialog;
     m_progressDialog = nullptr;
+    qCDebug(KDENLIVE_LOG) << "// Project opened in" << loadTime.elapsed() << "ms";
+}
+
+void ProjectManager::replayJournal(const QList<QJsonObject> &journal)
+{
+    m_progressDialog->setLabelText(i18n("Recovering timeline edits"));
+    int replayed = 0;
+    for (const QJsonObject &record : journal) {
+        QUndoCommand *command = JournalCommand::fromRecord(m_trackView->projectView(), record);
+        if (!command) {
+            break;
+        }
+        m_project->commandStack()->push(command);
+        replayed++;
+    }
+    qCDebug(KDENLIVE_LOG) << "// Replayed" << replayed << "of" << journal.count() << "autosave journal records";
+    if (replayed < journal.count()) {
+        KMessageBox::sorry(pCore->window(), i18n("Some of the last changes could not be recovered."));
+    }
+    m_trackView->setDuration(m_trackView->duration());
 }
 
 void ProjectManager::slotRevert()
@@ -680,37 +716,49 @@ void ProjectManager::slotStartAutoSave()
 
 void ProjectManager::slotAutoSave()
 {
-    prepareSave();
-    bool multitrackEnabled = m_trackView->multitrackView;
-    if (multitrackEnabled) {
-        // Multitrack view was enabled, disable for auto save
-        m_trackView->slotMultitrackView(false);
+    if (m_project->deferAutoSave()) {
+        // The previous autosave is still being written
+        return;
     }
-    m_trackView->connectOverlayTrack(false);
-    m_project->slotAutoSave();
-    m_trackView->connectOverlayTrack(true);
-    if (multitrackEnabled) {
-        // Multitrack view was enabled, re-enable for auto save
-        m_trackView->slotMultitrackView(true);
+    if (m_project->autoSaveJournal()) {
+        // Only the journal was written, no need to prepare the timeline
+        m_lastSave.start();
+        return;
     }
+    prepareSave();
+    // The overlays are only hidden while the timeline snapshot is taken, the file is written in a thread
+    bool multitrackEnabled = hideTimelineOverlays();
+    m_project->slotAutoSave();
+    restoreTimelineOverlays(multitrackEnabled);
     m_lastSave.start();
 }
 
-QString ProjectManager::projectSceneList(const QString &outputFolder)
+QString ProjectManager::projectSceneList(const QString &outputFolder, bool keepPreview)
+{
+    bool multitrackEnabled = hideTimelineOverlays(keepPreview);
+    QString scene = pCore->monitorManager()->projectMonitor()->sceneList(outputFolder);
+    restoreTimelineOverlays(multitrackEnabled, keepPreview);
+    return scene;
+}
+
+bool ProjectManager::hideTimelineOverlays(bool keepPreview)
 {
     bool multitrackEnabled = m_trackView->multitrackView;
     if (multitrackEnabled) {
-        // Multitrack view was enabled, disable for auto save
+        // Multitrack view was enabled, disable for saving
         m_trackView->slotMultitrackView(false);
     }
-    m_trackView->connectOverlayTrack(false);
-    QString scene = pCore->monitorManager()->projectMonitor()->sceneList(outputFolder);
-    m_trackView->connectOverlayTrack(true);
+    m_trackView->connectOverlayTrack(false, keepPreview);
+    return multitrackEnabled;
+}
+
+void ProjectManager::restoreTimelineOverlays(bool multitrackEnabled, bool keepPreview)
+{
+    m_trackView->connectOverlayTrack(true, keepPreview);
     if (multitrackEnabled) {
-        // Multitrack view was enabled, re-enable for auto save
+        // Multitrack view was enabled, re-enable after saving
         m_trackView->slotMultitrackView(true);
     }
-    return scene;
 }
 
 void ProjectManager::prepareSave()
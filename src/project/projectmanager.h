@@ -29,6 +29,7 @@ class QUrl;
 class QProgressDialog;
 class KAutoSaveFile;
 class KJob;
+class QJsonObject;
 
 /**
  * @class ProjectManager
@@ -58,8 +59,8 @@ public:
     void disableBinEffects(bool disable);
     /** @brief Returns true if there is a selected item in timeline */
     bool hasSelection() const;
-    /** @brief Returns current project's xml scene */
-    QString projectSceneList(const QString &outputFolder);
+    /** @brief Returns current project's xml scene, including the timeline preview track if @param keepPreview is true */
+    QString projectSceneList(const QString &outputFolder, bool keepPreview = false);
     /** @brief returns a default hd profile depending on timezone*/
     static QString getDefaultProjectFormat();
     void saveZone(const QStringList &info, const QDir &dir);
@@ -152,6 +153,11 @@ private:
     NotesPlugin *m_notesPlugin;
     QProgressDialog *m_progressDialog;
     void saveRecentFiles();
+    /** @brief Redo the timeline edits recorded in the autosave journal after recovering a project */
+    void replayJournal(const QList<QJsonObject> &journal);
+    /** @brief Disable the multitrack view and timeline overlay track before saving, returns true if the multitrack view was enabled */
+    bool hideTimelineOverlays(bool keepPreview = false);
+    void restoreTimelineOverlays(bool multitrackEnabled, bool keepPreview = false);
 };
 
 #endif
@@ -0,0 +1,235 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sharedcache.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QLockFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+// A project that did not use a file for this long does not prevent its eviction
+const int referenceExpiryDays = 90;
+// Files being written by a running job are not evicted
+const int writeGuardSeconds = 600;
+}
+
+class SharedCacheCreator
+{
+public:
+    SharedCache object;
+};
+
+Q_GLOBAL_STATIC(SharedCacheCreator, creator)
+
+SharedCache::SharedCache()
+    : m_root(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/shared"))
+{
+    m_root.mkpath(QStringLiteral("proxy"));
+    m_root.mkpath(QStringLiteral("thumbs"));
+}
+
+SharedCache *SharedCache::instance()
+{
+    return &creator->object;
+}
+
+//static
+bool SharedCache::isEnabled()
+{
+    return KdenliveSettings::sharedclipcache();
+}
+
+QString SharedCache::proxyPath(const QString &fileHash, const QString &params, const QString &extension) const
+{
+    // Clips proxied with different parameters get different files
+    const QByteArray key = QCryptographicHash::hash(fileHash.toUtf8() + '\n' + params.simplified().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_root.absoluteFilePath(QStringLiteral("proxy/") + QString::fromLatin1(key) + extension);
+}
+
+QString SharedCache::thumbnailPath(const QString &fileHash) const
+{
+    return m_root.absoluteFilePath(QStringLiteral("thumbs/") + fileHash + QStringLiteral(".png"));
+}
+
+bool SharedCache::contains(const QString &path) const
+{
+    return !entryName(path).isEmpty();
+}
+
+QString SharedCache::entryName(const QString &path) const
+{
+    if (path.isEmpty()) {
+        return QString();
+    }
+    const QString relative = m_root.relativeFilePath(QFileInfo(path).absoluteFilePath());
+    if (relative.startsWith(QLatin1String("proxy/")) || relative.startsWith(QLatin1String("thumbs/"))) {
+        return relative;
+    }
+    return QString();
+}
+
+QJsonObject SharedCache::loadIndex() const
+{
+    QFile file(m_root.absoluteFilePath(QStringLiteral("index.json")));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void SharedCache::saveIndex(const QJsonObject &index) const
+{
+    QFile file(m_root.absoluteFilePath(QStringLiteral("index.json")));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write shared cache index" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+}
+
+void SharedCache::addReferences(const QStringList &paths, const QString &projectId)
+{
+    if (projectId.isEmpty()) {
+        return;
+    }
+    // The index is shared by all running Kdenlive instances
+    QLockFile lock(m_root.absoluteFilePath(QStringLiteral("index.lock")));
+    lock.lock();
+    QJsonObject index = loadIndex();
+    const QString now = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    bool changed = false;
+    for (const QString &path : paths) {
+        const QString name = entryName(path);
+        if (name.isEmpty()) {
+            continue;
+        }
+        QJsonObject entry = index.value(name).toObject();
+        QJsonObject projects = entry.value(QStringLiteral("projects")).toObject();
+        projects.insert(projectId, now);
+        entry.insert(QStringLiteral("projects"), projects);
+        entry.insert(QStringLiteral("used"), now);
+        index.insert(name, entry);
+        changed = true;
+    }
+    if (changed) {
+        saveIndex(index);
+    }
+}
+
+void SharedCache::removeReferences(const QStringList &paths, const QString &projectId)
+{
+    QLockFile lock(m_root.absoluteFilePath(QStringLiteral("index.lock")));
+    lock.lock();
+    QJsonObject index = loadIndex();
+    bool changed = false;
+    for (const QString &path : paths) {
+        const QString name = entryName(path);
+        if (name.isEmpty() || !index.contains(name)) {
+            continue;
+        }
+        QJsonObject entry = index.value(name).toObject();
+        QJsonObject projects = entry.value(QStringLiteral("projects")).toObject();
+        projects.remove(projectId);
+        entry.insert(QStringLiteral("projects"), projects);
+        index.insert(name, entry);
+        changed = true;
+    }
+    if (changed) {
+        saveIndex(index);
+    }
+}
+
+void SharedCache::evict()
+{
+    const qint64 maxSize = (qint64) KdenliveSettings::sharedcachesize() * 1024 * 1024;
+    if (maxSize <= 0) {
+        return;
+    }
+    QLockFile lock(m_root.absoluteFilePath(QStringLiteral("index.lock")));
+    lock.lock();
+    QJsonObject index = loadIndex();
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    struct Candidate {
+        QString name;
+        qint64 size;
+        QDateTime used;
+    };
+    QList<Candidate> candidates;
+    QStringList existing;
+    qint64 total = 0;
+    for (const QString &folder : {QStringLiteral("proxy"), QStringLiteral("thumbs")}) {
+        const QFileInfoList files = QDir(m_root.absoluteFilePath(folder)).entryInfoList(QDir::Files);
+        for (const QFileInfo &info : files) {
+            const QString name = folder + QLatin1Char('/') + info.fileName();
+            existing << name;
+            total += info.size();
+            if (info.lastModified().secsTo(QDateTime::currentDateTime()) < writeGuardSeconds) {
+                continue;
+            }
+            const QJsonObject entry = index.value(name).toObject();
+            bool referenced = false;
+            const QJsonObject projects = entry.value(QStringLiteral("projects")).toObject();
+            for (const QString &project : projects.keys()) {
+                if (QDateTime::fromString(projects.value(project).toString(), Qt::ISODate).daysTo(now) < referenceExpiryDays) {
+                    referenced = true;
+                    break;
+                }
+            }
+            if (!referenced) {
+                QDateTime used = QDateTime::fromString(entry.value(QStringLiteral("used")).toString(), Qt::ISODate);
+                candidates.append({name, info.size(), used.isValid() ? used : info.lastModified().toUTC()});
+            }
+        }
+    }
+    // Forget the files deleted by the user
+    bool changed = false;
+    for (const QString &name : index.keys()) {
+        if (!existing.contains(name)) {
+            index.remove(name);
+            changed = true;
+        }
+    }
+    if (total > maxSize) {
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+            return a.used < b.used;
+        });
+        for (const Candidate &candidate : candidates) {
+            if (total <= maxSize) {
+                break;
+            }
+            if (QFile::remove(m_root.absoluteFilePath(candidate.name))) {
+                total -= candidate.size;
+                index.remove(candidate.name);
+                changed = true;
+            }
+        }
+    }
+    if (changed) {
+        saveIndex(index);
+    }
+}
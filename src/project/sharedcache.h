@@ -0,0 +1,70 @@
+/*
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHAREDCACHE_H
+#define SHAREDCACHE_H
+
+#include <QDir>
+#include <QJsonObject>
+#include <QStringList>
+
+/**
+ * @class SharedCache
+ * @brief Proxy clips and thumbnails shared by all projects.
+ *
+ * Files are named after the clip's file hash (and the proxy parameters for proxies),
+ * so that a clip used in several projects is only processed once. The projects using
+ * a file are recorded in an index, and the least recently used files that no project
+ * references are deleted when the store exceeds its configured size.
+ */
+class SharedCache
+{
+public:
+    static SharedCache *instance();
+    /** @brief Returns true if the shared store is enabled in the settings. */
+    static bool isEnabled();
+    /** @brief Returns the proxy path for a clip.
+     *  @param fileHash the kdenlive:file_hash of the clip
+     *  @param params the proxy encoding parameters
+     *  @param extension the proxy file extension, including the dot */
+    QString proxyPath(const QString &fileHash, const QString &params, const QString &extension) const;
+    /** @brief Returns the path of the bin thumbnail for a clip. */
+    QString thumbnailPath(const QString &fileHash) const;
+    /** @brief Returns true if the file is in the store. */
+    bool contains(const QString &path) const;
+    /** @brief Record that a project uses these files, marking them as recently used. Files outside of the store are ignored. */
+    void addReferences(const QStringList &paths, const QString &projectId);
+    /** @brief The project does not use these files anymore. */
+    void removeReferences(const QStringList &paths, const QString &projectId);
+    /** @brief Delete the least recently used files until the store fits in its maximum size. Referenced files are kept. */
+    void evict();
+
+private:
+    SharedCache();
+    friend class SharedCacheCreator;
+    QDir m_root;
+    /** @brief Returns the path relative to the store, empty if the file is not in the store. */
+    QString entryName(const QString &path) const;
+    QJsonObject loadIndex() const;
+    void saveIndex(const QJsonObject &index) const;
+};
+
+#endif
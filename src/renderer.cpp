@@ -32,6 +32,8 @@
 #include "bin/projectclip.h"
 #include "timeline/clip.h"
 #include "monitor/glwidget.h"
+#include "monitor/framecache.h"
+#include "monitor/frameprefetcher.h"
 #include "mltcontroller/clipcontroller.h"
 #include "timeline/transitionhandler.h"
 #include "core.h"
@@ -41,9 +43,12 @@
 #include <KMessageBox>
 #include <KLocalizedString>
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QTextStream>
 #include <QString>
 #include <QApplication>
 #include <QProcess>
+#include <QSet>
 
 #include <cstdlib>
 #include <cstdarg>
@@ -68,6 +73,7 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_isZoneMode(false),
     m_isLoopMode(false),
     m_blackClip(nullptr),
+    m_prefetcher(nullptr),
     m_isActive(false),
     m_isRefreshing(false)
 {
@@ -89,6 +95,12 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_refreshTimer.setSingleShot(true);
     m_refreshTimer.setInterval(50);
     connect(&m_refreshTimer, &QTimer::timeout, this, &Render::refresh);
+    if (m_qmlView && m_qmlView->frameCache()) {
+        m_prefetcher = new FramePrefetcher(m_qmlView->frameCache(), m_qmlView->profile(), this);
+        m_prefetchTimer.setSingleShot(true);
+        m_prefetchTimer.setInterval(300);
+        connect(&m_prefetchTimer, &QTimer::timeout, this, &Render::slotStartPrefetch);
+    }
     connect(this, &Render::checkSeeking, this, &Render::slotCheckSeeking);
     if (m_name == Kdenlive::ProjectMonitor) {
         connect(m_binController, &BinController::prepareTimelineReplacement, this, &Render::prepareTimelineReplacement, Qt::DirectConnection);
@@ -105,6 +117,9 @@ Render::~Render()
 
 void Render::closeMlt()
 {
+    m_prefetchTimer.stop();
+    delete m_prefetcher;
+    m_prefetcher = nullptr;
     delete m_showFrameEvent;
     delete m_pauseEvent;
     delete m_mltConsumer;
@@ -122,6 +137,11 @@ void Render::slotSwitchFullscreen()
 void Render::prepareProfileReset(double fps)
 {
     m_refreshTimer.stop();
+    invalidateFrameCache();
+    if (m_prefetcher) {
+        // The profile is about to change, don't let the prefetch thread use it
+        m_prefetcher->waitForFinished();
+    }
     m_fps = fps;
 }
 
@@ -144,6 +164,57 @@ void Render::seek(const GenTime &time)
     seek(pos);
 }
 
+void Render::invalidateFrameCache(int start, int end)
+{
+    FrameCache *cache = m_qmlView ? m_qmlView->frameCache() : nullptr;
+    if (!cache) {
+        return;
+    }
+    if (m_prefetcher) {
+        // Our copy of the timeline is outdated
+        m_prefetchTimer.stop();
+        m_prefetcher->invalidate(start, end);
+    }
+    if (start < 0) {
+        cache->invalidate();
+    } else {
+        cache->invalidate(start, end);
+    }
+}
+
+void Render::cancelPrefetch()
+{
+    if (m_prefetcher) {
+        m_prefetchTimer.stop();
+        m_prefetcher->cancel();
+    }
+}
+
+void Render::slotStartPrefetch()
+{
+    if (!m_prefetcher || !m_isActive || externalConsumer || !m_mltProducer || m_mltProducer->get_speed() != 0 || requestedSeekPosition != SEEK_INACTIVE) {
+        return;
+    }
+    FrameCache *cache = m_qmlView->frameCache();
+    m_prefetcher->setWindow(cache->isEnabled() ? KdenliveSettings::monitorprefetch() : 0);
+    if (m_prefetcher->window() == 0) {
+        return;
+    }
+    const int position = seekFramePosition();
+    Mlt::Producer *timeline = nullptr;
+    if (m_prefetcher->needsTimeline(position)) {
+        // Copying the timeline reloads all its clips, do it at most every few seconds while editing
+        if (m_prefetchRebuild.isValid() && m_prefetchRebuild.elapsed() < 3000) {
+            m_prefetchTimer.start();
+            return;
+        }
+        m_prefetchRebuild.start();
+        // The copy is serialized in the prefetch thread
+        timeline = new Mlt::Producer(m_mltProducer->get_producer());
+    }
+    m_prefetcher->start(position, timeline);
+}
+
 void Render::silentSeek(int time)
 {
     if (m_isActive) {
@@ -156,10 +227,16 @@ void Render::silentSeek(int time)
 
 void Render::seek(int time)
 {
+    cancelPrefetch();
     resetZoneMode();
     time = qBound(0, time, m_mltProducer->get_length() - 1);
     if (requestedSeekPosition == SEEK_INACTIVE) {
         requestedSeekPosition = time;
+        if (m_mltProducer->get_speed() == 0 && !externalConsumer && m_qmlView && m_qmlView->showCachedFrame(time)) {
+            // Frame already decoded, only move the producer so that playback starts from here
+            m_mltProducer->seek(time);
+            return;
+        }
         if (m_mltProducer->get_speed() != 0) {
             m_mltConsumer->purge();
         }
@@ -329,6 +406,7 @@ void Render::loadUrl(const QString &url)
 
 bool Render::updateProducer(Mlt::Producer *producer)
 {
+    invalidateFrameCache();
     if (m_mltProducer) {
         if (strcmp(m_mltProducer->get("resource"), "<tractor>") == 0) {
             // We need to make some cleanup
@@ -359,6 +437,7 @@ bool Render::updateProducer(Mlt::Producer *producer)
 
 bool Render::setProducer(Mlt::Producer *producer, int position, bool isActive)
 {
+    invalidateFrameCache();
     m_refreshTimer.stop();
     requestedSeekPosition = SEEK_INACTIVE;
     QMutexLocker locker(&m_mutex);
@@ -444,11 +523,38 @@ void Render::startConsumer()
 
 int Render::setSceneList(const QDomDocument &list, int position)
 {
-    return setSceneList(list.toString(), position);
+    QElapsedTimer timer;
+    timer.start();
+    // Serialize the document once to utf8, without the previous profile info
+    QDomElement mlt = list.documentElement();
+    QDomElement profile = mlt.firstChildElement(QStringLiteral("profile"));
+    QDomNode profileSibling = profile.nextSibling();
+    if (!profile.isNull()) {
+        mlt.removeChild(profile);
+    }
+    QByteArray playlist;
+    QTextStream stream(&playlist, QIODevice::WriteOnly);
+    stream.setCodec("UTF-8");
+    list.save(stream, 1, QDomNode::EncodingFromTextStream);
+    stream.flush();
+    if (!profile.isNull()) {
+        mlt.insertBefore(profile, profileSibling);
+    }
+    int error = loadSceneList(playlist, mlt.attribute(QStringLiteral("root")), position);
+    qCDebug(KDENLIVE_LOG) << "// Scene list loaded in" << timer.elapsed() << "ms";
+    return error;
 }
 
 int Render::setSceneList(QString playlist, int position)
 {
+    QDomDocument doc;
+    doc.setContent(playlist);
+    return setSceneList(doc, position);
+}
+
+int Render::loadSceneList(const QByteArray &playlist, const QString &root, int position)
+{
+    invalidateFrameCache();
     requestedSeekPosition = SEEK_INACTIVE;
     m_refreshTimer.stop();
     QMutexLocker locker(&m_mutex);
@@ -457,13 +563,6 @@ int Render::setSceneList(QString playlist, int position)
 
     //qCDebug(KDENLIVE_LOG) << "//////  RENDER, SET SCENE LIST:\n" << playlist <<"\n..........:::.";
 
-    // Remove previous profile info
-    QDomDocument doc;
-    doc.setContent(playlist);
-    QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
-    doc.documentElement().removeChild(profile);
-    playlist = doc.toString();
-
     if (m_mltConsumer) {
         if (!m_mltConsumer->is_stopped()) {
             m_mltConsumer->stop();
@@ -486,10 +585,10 @@ int Render::setSceneList(QString playlist, int position)
     blockSignals(true);
     m_locale = QLocale();
     m_locale.setNumberOptions(QLocale::OmitGroupSeparator);
-    m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-string", playlist.toUtf8().constData());
+    m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-string", playlist.constData());
     //m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-nogl-string", playlist.toUtf8().constData());
     if (!m_mltProducer || !m_mltProducer->is_valid()) {
-        qCDebug(KDENLIVE_LOG) << " WARNING - - - - -INVALID PLAYLIST: " << playlist.toUtf8().constData();
+        qCDebug(KDENLIVE_LOG) << " WARNING - - - - -INVALID PLAYLIST: " << playlist.constData();
         m_mltProducer = m_blackClip->cut(0, 1);
         error = -1;
     }
@@ -504,7 +603,7 @@ int Render::setSceneList(QString playlist, int position)
     }
 
     // init MLT's document root, useful to find full urls
-    m_binController->setDocumentRoot(doc.documentElement().attribute(QStringLiteral("root")));
+    m_binController->setDocumentRoot(root);
 
     // Fill Bin's playlist
     Mlt::Service service(m_mltProducer->parent().get_service());
@@ -579,19 +678,35 @@ void Render::checkMaxThreads()
     }
 }
 
-const QString Render::sceneList(const QString &root)
+const QString Render::sceneList(const QString &root, bool optimise)
 {
-    QString playlist;
     qCDebug(KDENLIVE_LOG) << " * * *Setting document xml root: " << root;
     Mlt::Consumer xmlConsumer(*m_qmlView->profile(), "xml:kdenlive_playlist");
+    if (!runXmlConsumer(xmlConsumer, root, optimise)) {
+        return QString();
+    }
+    return QString::fromUtf8(xmlConsumer.get("kdenlive_playlist"));
+}
+
+bool Render::writeSceneList(const QString &path, const QString &root)
+{
+    // The xml consumer writes to a file when the resource has an extension
+    Mlt::Consumer xmlConsumer(*m_qmlView->profile(), ("xml:" + path).toUtf8().constData());
+    return runXmlConsumer(xmlConsumer, root, true);
+}
+
+bool Render::runXmlConsumer(Mlt::Consumer &xmlConsumer, const QString &root, bool optimise)
+{
     if (!root.isEmpty()) {
         xmlConsumer.set("root", root.toUtf8().constData());
     }
     //qCDebug(KDENLIVE_LOG)<<" ++ + READY TO SAVE: "<<m_qmlView->profile()->width()<<" / "<<m_qmlView->profile()->description();
     if (!xmlConsumer.is_valid()) {
-        return QString();
+        return false;
+    }
+    if (optimise) {
+        m_mltProducer->optimise();
     }
-    m_mltProducer->optimise();
     xmlConsumer.set("terminate_on_pause", 1);
     xmlConsumer.set("store", "kdenlive");
     // Disabling meta creates cleaner files, but then we don't have access to metadata on the fly (meta channels, etc)
@@ -599,12 +714,64 @@ const QString Render::sceneList(const QString &root)
     //xmlConsumer.set("no_meta", 1);
     Mlt::Producer prod(m_mltProducer->get_producer());
     if (!prod.is_valid()) {
-        return QString();
+        return false;
     }
     xmlConsumer.connect(prod);
     xmlConsumer.run();
-    playlist = QString::fromUtf8(xmlConsumer.get("kdenlive_playlist"));
-    return playlist;
+    return true;
+}
+
+static void collectEffects(Mlt::Service &service, QMap<QString, QString> &effects, QSet<mlt_service> &visited)
+{
+    if (!service.is_valid() || visited.contains(service.get_service())) {
+        return;
+    }
+    visited.insert(service.get_service());
+    for (int i = 0; i < service.filter_count(); ++i) {
+        QScopedPointer<Mlt::Filter> filter(service.filter(i));
+        if (filter && filter->is_valid()) {
+            QString id = QString::fromUtf8(filter->get("kdenlive_id"));
+            QString tag = QString::fromUtf8(filter->get("tag"));
+            if (!id.isEmpty() && !tag.isEmpty()) {
+                effects.insert(id, tag);
+            }
+        }
+    }
+    if (service.type() == playlist_type) {
+        Mlt::Playlist playlist((mlt_playlist) service.get_service());
+        for (int i = 0; i < playlist.count(); ++i) {
+            QScopedPointer<Mlt::Producer> clip(playlist.get_clip(i));
+            if (!clip || clip->is_blank()) {
+                continue;
+            }
+            collectEffects(*clip, effects, visited);
+            QScopedPointer<Mlt::Producer> parent(clip->parent());
+            if (parent) {
+                collectEffects(*parent, effects, visited);
+            }
+        }
+    } else if (service.type() == tractor_type) {
+        Mlt::Tractor tractor((mlt_tractor) service.get_service());
+        for (int i = 0; i < tractor.count(); ++i) {
+            QScopedPointer<Mlt::Producer> track(tractor.track(i));
+            if (track) {
+                collectEffects(*track, effects, visited);
+            }
+        }
+    }
+}
+
+QMap<QString, QString> Render::usedEffects() const
+{
+    QMap<QString, QString> effects;
+    QSet<mlt_service> visited;
+    if (m_mltProducer) {
+        Mlt::Producer prod(m_mltProducer->get_producer());
+        collectEffects(prod, effects, visited);
+        Mlt::Service bin(m_binController->service());
+        collectEffects(bin, effects, visited);
+    }
+    return effects;
 }
 
 void Render::saveZone(const QString &projectFolder, QPoint zone)
@@ -699,6 +866,9 @@ void Render::stop()
             m_mltConsumer->stop();
         }
     }
+    if (m_qmlView) {
+        m_qmlView->setPreviewScale(1);
+    }
     m_isRefreshing = false;
 }
 
@@ -742,6 +912,9 @@ void Render::switchPlay(bool play, double speed)
 {
     QMutexLocker locker(&m_mutex);
     requestedSeekPosition = SEEK_INACTIVE;
+    if (play) {
+        cancelPrefetch();
+    }
     if (!m_mltProducer || !m_mltConsumer || !m_isActive) {
         return;
     }
@@ -778,12 +951,16 @@ void Render::switchPlay(bool play, double speed)
         m_mltProducer->set_speed(0.0);
         m_mltProducer->seek(m_mltConsumer->position() + 1);
         m_mltConsumer->purge();
+        restorePreviewScale();
     }
 }
 
 void Render::play(double speed)
 {
     requestedSeekPosition = SEEK_INACTIVE;
+    if (speed != 0) {
+        cancelPrefetch();
+    }
     if (!m_mltProducer || !m_isActive) {
         return;
     }
@@ -809,11 +986,15 @@ void Render::play(double speed)
         m_mltConsumer->set("refresh", 1);
     }
     m_mltProducer->set_speed(speed);
+    if (speed == 0) {
+        restorePreviewScale();
+    }
 }
 
 void Render::play(const GenTime &startTime)
 {
     requestedSeekPosition = SEEK_INACTIVE;
+    cancelPrefetch();
     if (!m_mltProducer || !m_mltConsumer || !m_isActive) {
         return;
     }
@@ -892,6 +1073,7 @@ void Render::seekToFrameDiff(int diff)
 
 void Render::doRefresh()
 {
+    invalidateFrameCache();
     if (m_mltProducer && (playSpeed() == 0) && m_isActive) {
         if (m_isRefreshing) {
             m_refreshTimer.start();
@@ -935,6 +1117,28 @@ void Render::setDropFrames(bool drop)
     }
 }
 
+void Render::setPreviewScale(int scale)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_mltConsumer || !m_mltProducer || !m_qmlView->setPreviewScale(scale)) {
+        return;
+    }
+    if (m_mltProducer->get_speed() == 0) {
+        m_mltConsumer->set("refresh", 1);
+    } else if (!m_mltConsumer->is_stopped()) {
+        // Restart the consumer so that the new size is used for the next frames
+        m_mltConsumer->stop();
+        m_mltConsumer->start();
+    }
+}
+
+void Render::restorePreviewScale()
+{
+    if (m_qmlView && m_qmlView->setPreviewScale(1) && m_mltConsumer) {
+        m_mltConsumer->set("refresh", 1);
+    }
+}
+
 void Render::setConsumerProperty(const QString &name, const QString &value)
 {
     QMutexLocker locker(&m_mutex);
@@ -966,11 +1170,7 @@ double Render::playSpeed() const
 
 GenTime Render::seekPosition() const
 {
-    if (m_mltConsumer) {
-        return GenTime((int) m_mltConsumer->position(), m_fps);
-    } else {
-        return GenTime();
-    }
+    return GenTime(seekFramePosition(), m_fps);
 }
 
 int Render::seekFramePosition() const
@@ -1007,7 +1207,8 @@ int Render::getCurrentSeekPosition() const
     if (requestedSeekPosition != SEEK_INACTIVE) {
         return requestedSeekPosition;
     }
-    return (int) m_mltConsumer->position();
+    // When displaying a cached frame, only the producer is moved
+    return seekFramePosition();
 }
 
 bool Render::checkFrameNumber(int pos)
@@ -1020,6 +1221,9 @@ bool Render::checkFrameNumber(int pos)
         m_mltProducer->set_speed(0);
         m_mltProducer->seek(requestedSeekPosition);
         if (speed == 0) {
+            if (!externalConsumer && m_qmlView && m_qmlView->showCachedFrame(requestedSeekPosition)) {
+                return true;
+            }
             m_mltConsumer->set("refresh", 1);
         } else {
             m_mltProducer->set_speed(speed);
@@ -1028,6 +1232,7 @@ bool Render::checkFrameNumber(int pos)
         m_isRefreshing = false;
         if (pos <= 0) {
             m_mltProducer->set_speed(0);
+            restorePreviewScale();
             return false;
         }
     } else {
@@ -1041,11 +1246,20 @@ bool Render::checkFrameNumber(int pos)
                     m_mltConsumer->set("refresh", 1);
                 } else {
                     if (speed == 0) {
+                        restorePreviewScale();
                         return false;
                     }
                 }
             }
         }
+        if (speed == 0 && m_qmlView && m_qmlView->previewScale() != 1) {
+            // Playback stopped by itself, for example at the end of the timeline
+            restorePreviewScale();
+        }
+        if (speed == 0 && m_prefetcher) {
+            // Monitor is paused, decode the surrounding frames once it stays idle
+            m_prefetchTimer.start();
+        }
     }
     return true;
 }
@@ -1200,6 +1414,7 @@ Mlt::Tractor *Render::lockService()
 
 void Render::unlockService(Mlt::Tractor *tractor)
 {
+    invalidateFrameCache();
     if (tractor) {
         delete tractor;
     }
@@ -1216,6 +1431,7 @@ void Render::unlockService(Mlt::Tractor *tractor)
 
 void Render::mltInsertSpace(const QMap<int, int> &trackClipStartList, const QMap<int, int> &trackTransitionStartList, int track, const GenTime &duration, const GenTime &timeOffset)
 {
+    invalidateFrameCache();
     if (!m_mltProducer) {
         //qCDebug(KDENLIVE_LOG) << "PLAYLIST NOT INITIALISED //////";
         return;
@@ -1366,6 +1582,7 @@ void Render::mltInsertSpace(const QMap<int, int> &trackClipStartList, const QMap
 
 bool Render::mltResizeClipCrop(const ItemInfo &info, GenTime newCropStart)
 {
+    invalidateFrameCache();
     Mlt::Service service(m_mltProducer->parent().get_service());
     int newCropFrame = (int) newCropStart.frames(m_fps);
     Mlt::Tractor tractor(service);
@@ -1489,6 +1706,7 @@ void Render::fillSlowMotionProducers()
 //Updates all transitions
 QList<TransitionInfo> Render::mltInsertTrack(int ix, const QString &name, bool videoTrack)
 {
+    invalidateFrameCache();
     QList<TransitionInfo> transitionInfos;
     // Track add / delete was only added recently in MLT (pre 0.9.8 release).
 #if (LIBMLT_VERSION_INT < 0x0908)
@@ -50,11 +50,13 @@
 #include <QMutex>
 #include <QSemaphore>
 #include <QTimer>
+#include <QElapsedTimer>
 
 class KComboBox;
 class BinController;
 class ClipController;
 class GLWidget;
+class FramePrefetcher;
 
 namespace Mlt
 {
@@ -122,14 +124,21 @@ Q_OBJECT public:
      * @param position (optional) time to seek to
      * @return 0 when it has success, different from 0 otherwise
      *
-     * Creates the producer from the text playlist. */
+     * Parses the text playlist, prefer the QDomDocument version. */
     int setSceneList(QString playlist, int position = 0);
     bool updateProducer(Mlt::Producer *producer);
     bool setProducer(Mlt::Producer *producer, int position, bool isActive);
 
     /** @brief Get the current MLT producer playlist.
+     * @param optimise if false, the timeline is not optimised before being saved, use it when it may be playing
      * @return A string describing the playlist */
-    const QString sceneList(const QString &root);
+    const QString sceneList(const QString &root, bool optimise = true);
+    /** @brief Write the current MLT producer playlist directly to a file.
+     * @param path the destination, it must have an extension
+     * @return true on success */
+    bool writeSceneList(const QString &path, const QString &root);
+    /** @brief Returns the kdenlive_id / tag of all effects used in the timeline and bin. */
+    QMap<QString, QString> usedEffects() const;
 
     /** @brief Tells the renderer to play the scene at the specified speed,
      * @param speed speed to play the scene to
@@ -195,6 +204,8 @@ Q_OBJECT public:
 
     //const QList<Mlt::Producer *> producersList();
     void setDropFrames(bool show);
+    /** @brief Lower the processing resolution during playback, see GLWidget::setPreviewScale */
+    void setPreviewScale(int scale);
     /** @brief Sets an MLT consumer property. */
     void setConsumerProperty(const QString &name, const QString &value);
 
@@ -251,6 +262,10 @@ Q_OBJECT public:
     void updateSlowMotionProducers(const QString &id, const QMap<QString, QString> &passProperties);
     void preparePreviewRendering(const QString &sceneListFile);
     void silentSeek(int time);
+    /** @brief Stop decoding frames in advance, for example before playing */
+    void cancelPrefetch();
+    /** @brief Drop the cached monitor frames after a timeline change, in the [start, end] range or everywhere if start is -1 */
+    void invalidateFrameCache(int start = -1, int end = -1);
 
 private:
 
@@ -278,6 +293,11 @@ private:
     Mlt::Producer *m_blackClip;
 
     QTimer m_refreshTimer;
+    /** @brief Starts frame prefetching once the project monitor stays paused */
+    QTimer m_prefetchTimer;
+    /** @brief Time since the prefetcher's copy of the timeline was last rebuilt */
+    QElapsedTimer m_prefetchRebuild;
+    FramePrefetcher *m_prefetcher;
     QMutex m_mutex;
     QMutex m_infoMutex;
 
@@ -294,19 +314,27 @@ private:
     //void buildConsumer();
     /** @brief Restore normal mode */
     void resetZoneMode();
+    /** @brief Paused frames are always displayed at full resolution */
+    void restorePreviewScale();
     void fillSlowMotionProducers();
+    /** @brief Create the producer from the utf8 xml playlist of the project */
+    int loadSceneList(const QByteArray &playlist, const QString &root, int position);
     /** @brief Make sure we inform MLT if we need a lot of threads for avformat producer */
     void checkMaxThreads();
     /** @brief Clone serialisable properties only */
     void cloneProperties(Mlt::Properties &dest, Mlt::Properties &source);
     /** @brief Get a track producer from a clip's id */
     Mlt::Producer *getProducerForTrack(Mlt::Playlist &trackPlaylist, const QString &clipId);
+    /** @brief Serialize the timeline with an xml consumer */
+    bool runXmlConsumer(Mlt::Consumer &xmlConsumer, const QString &root, bool optimise);
 
 private slots:
 
     /** @brief Refreshes the monitor display. */
     void refresh();
     void slotCheckSeeking();
+    /** @brief Decode the frames around the paused position into the monitor cache. */
+    void slotStartPrefetch();
 
 signals:
     /** @brief The renderer stopped, either playing or rendering. */
@@ -38,6 +38,7 @@
 #include "mainwindow.h"
 #include "transitionhandler.h"
 #include "project/clipmanager.h"
+#include "project/cacheledger.h"
 #include "utils/KoIconUtils.h"
 #include "effectslist/initeffects.h"
 #include "effectstack/widgets/keyframeimport.h"
@@ -6954,7 +6955,7 @@ void CustomTrackView::slotUpdateAllThumbs()
     for (int i = 0; i < itemList.count(); ++i) {
         if (itemList.at(i)->type() == AVWidget) {
             item = static_cast <ClipItem *>(itemList.at(i));
-            if (item && item->isEnabled() && item->clipType() != Color && item->clipType() != Audio) {
+            if (item && item->isEnabled() && item->clipType() != Color && item->clipType() != Audio && !item->getBinHash().isEmpty()) {
                 // Check if we have a cached thumbnail
                 if (item->clipType() == Image || item->clipType() == Text) {
                     QString thumb = thumbsFolder.absoluteFilePath(item->getBinHash() + QStringLiteral("#0.png"));
@@ -7001,23 +7002,23 @@ void CustomTrackView::saveThumbnails()
     for (int i = 0; i < itemList.count(); ++i) {
         if (itemList.at(i)->type() == AVWidget) {
             item = static_cast <ClipItem *>(itemList.at(i));
-            if (item->clipType() != Color && item->clipType() != Audio) {
+            if (item->clipType() != Color && item->clipType() != Audio && !item->getBinHash().isEmpty()) {
                 // Check if we have a cached thumbnail
                 if (item->clipType() == Image || item->clipType() == Text || item->clipType() == Audio) {
                     QString thumb = thumbsFolder.absoluteFilePath(item->getBinHash() + QStringLiteral("#0.png"));
-                    if (!QFile::exists(thumb)) {
-                        item->startThumb().save(thumb);
+                    if (!QFile::exists(thumb) && item->startThumb().save(thumb)) {
+                        CacheLedger::instance()->addFile(thumbsFolder, thumb);
                     }
                 } else {
                     QString startThumb = thumbsFolder.absoluteFilePath(item->getBinHash() + QLatin1Char('#'));
                     QString endThumb = startThumb;
                     startThumb.append(QString::number((int) item->speedIndependantCropStart().frames(m_document->fps())) + QStringLiteral(".png"));
                     endThumb.append(QString::number((int)(item->speedIndependantCropStart() + item->speedIndependantCropDuration()).frames(m_document->fps()) - 1) + QStringLiteral(".png"));
-                    if (!QFile::exists(startThumb)) {
-                        item->startThumb().save(startThumb);
+                    if (!QFile::exists(startThumb) && item->startThumb().save(startThumb)) {
+                        CacheLedger::instance()->addFile(thumbsFolder, startThumb);
                     }
-                    if (!QFile::exists(endThumb)) {
-                        item->endThumb().save(endThumb);
+                    if (!QFile::exists(endThumb) && item->endThumb().save(endThumb)) {
+                        CacheLedger::instance()->addFile(thumbsFolder, endThumb);
                     }
                 }
             }
@@ -7667,6 +7668,7 @@ void CustomTrackView::monitorRefresh(const QList<ItemInfo> &range, bool invalida
 {
     bool refreshMonitor = false;
     for (int i = 0; i < range.count(); i++) {
+        m_document->renderer()->invalidateFrameCache(range.at(i).startPos.frames(m_document->fps()), range.at(i).endPos.frames(m_document->fps()));
         if (range.at(i).contains(GenTime(m_cursorPos, m_document->fps()))) {
             refreshMonitor = true;
         }
@@ -7681,6 +7683,7 @@ void CustomTrackView::monitorRefresh(const QList<ItemInfo> &range, bool invalida
 
 void CustomTrackView::monitorRefresh(const ItemInfo &range, bool invalidateRange)
 {
+    m_document->renderer()->invalidateFrameCache(range.startPos.frames(m_document->fps()), range.endPos.frames(m_document->fps()));
     if (range.contains(GenTime(m_cursorPos, m_document->fps()))) {
         m_document->renderer()->doRefresh();
     }
@@ -21,6 +21,7 @@
 #include "../customruler.h"
 #include "kdenlivesettings.h"
 #include "doc/kdenlivedoc.h"
+#include "project/cacheledger.h"
 
 #include <KLocalizedString>
 #include <QtConcurrent>
@@ -45,6 +46,7 @@ PreviewManager::~PreviewManager()
         abortRendering();
         if (m_undoDir.dirName() == QLatin1String("undo")) {
             m_undoDir.removeRecursively();
+            CacheLedger::instance()->removeFolder(m_cacheDir, QStringLiteral("undo"));
         }
         if ((m_doc->url().isEmpty() && m_cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty()) || m_cacheDir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty()) {
             if (m_cacheDir.dirName() == QLatin1String("preview")) {
@@ -223,6 +225,8 @@ void PreviewManager::invalidatePreviews(const QList<int> &chunks)
         foreach (int i, chunks) {
             QString current = QStringLiteral("%1.%2").arg(i).arg(m_extension);
             if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(ix).arg(current))) {
+                CacheLedger::instance()->removeFile(m_cacheDir, current);
+                CacheLedger::instance()->addFile(m_cacheDir, QStringLiteral("undo/%1/%2").arg(ix).arg(current));
                 foundPreviews = true;
             }
         }
@@ -245,6 +249,8 @@ void PreviewManager::invalidatePreviews(const QList<int> &chunks)
                 foreach (int i, chunks) {
                     QString current = QStringLiteral("%1.%2").arg(i).arg(m_extension);
                     if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(stackMax).arg(current))) {
+                        CacheLedger::instance()->removeFile(m_cacheDir, current);
+                        CacheLedger::instance()->addFile(m_cacheDir, QStringLiteral("undo/%1/%2").arg(stackMax).arg(current));
                         foundPreviews = true;
                     }
                 }
@@ -263,9 +269,11 @@ void PreviewManager::invalidatePreviews(const QList<int> &chunks)
             QString cacheFileName = QStringLiteral("%1.%2").arg(i).arg(m_extension);
             if (!lastUndo) {
                 m_cacheDir.remove(cacheFileName);
+                CacheLedger::instance()->removeFile(m_cacheDir, cacheFileName);
             }
             if (moveFile) {
                 if (QFile::copy(tmpDir.absoluteFilePath(cacheFileName), m_cacheDir.absoluteFilePath(cacheFileName))) {
+                    CacheLedger::instance()->addFile(m_cacheDir, cacheFileName);
                     foundChunks << i;
                 }
             }
@@ -302,6 +310,7 @@ void PreviewManager::doCleanupOldPreviews()
         dirName.toInt(&ok);
         if (ok && tmp.cd(dirName)) {
             tmp.removeRecursively();
+            CacheLedger::instance()->removeFolder(m_cacheDir, QStringLiteral("undo/") + dirName);
         }
     }
 }
@@ -315,6 +324,7 @@ void PreviewManager::clearPreviewRange()
     bool hasPreview = m_previewTrack != nullptr;
     foreach (int ix, toProcess) {
         m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix).arg(m_extension));
+        CacheLedger::instance()->removeFile(m_cacheDir, QStringLiteral("%1.%2").arg(ix).arg(m_extension));
         if (!hasPreview) {
             continue;
         }
@@ -361,6 +371,7 @@ void PreviewManager::addPreviewRange(bool add)
         bool hasPreview = m_previewTrack != nullptr;
         foreach (int ix, toProcess) {
             m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix).arg(m_extension));
+            CacheLedger::instance()->removeFile(m_cacheDir, QStringLiteral("%1.%2").arg(ix).arg(m_extension));
             if (!hasPreview) {
                 continue;
             }
@@ -428,6 +439,7 @@ void PreviewManager::doPreviewRender(const QString &scene)
         }
         if (m_cacheDir.exists(fileName)) {
             // This chunk already exists
+            CacheLedger::instance()->addFile(m_cacheDir, fileName);
             emit previewRender(i, m_cacheDir.absoluteFilePath(fileName), progress);
             continue;
         }
@@ -451,8 +463,10 @@ void PreviewManager::doPreviewRender(const QString &scene)
                     emit previewRender(i, previewProcess.readAllStandardError(), -1);
                 }
                 QFile::remove(m_cacheDir.absoluteFilePath(fileName));
+                CacheLedger::instance()->removeFile(m_cacheDir, fileName);
                 break;
             } else {
+                CacheLedger::instance()->addFile(m_cacheDir, fileName);
                 emit previewRender(i, m_cacheDir.absoluteFilePath(fileName), progress);
             }
         } else {
@@ -1730,15 +1730,15 @@ void Timeline::slotMultitrackView(bool enable)
     transitionHandler->enableMultiTrack(enable);
 }
 
-void Timeline::connectOverlayTrack(bool enable)
+void Timeline::connectOverlayTrack(bool enable, bool keepPreview)
 {
-    if (!m_hasOverlayTrack && !m_usePreview) {
+    if (!m_hasOverlayTrack && (!m_usePreview || keepPreview)) {
         return;
     }
     m_tractor->lock();
     if (enable) {
         // Re-add overlaytrack
-        if (m_usePreview) {
+        if (m_usePreview && !keepPreview) {
             m_timelinePreview->reconnectTrack();
         }
         if (m_hasOverlayTrack) {
@@ -1747,7 +1747,7 @@ void Timeline::connectOverlayTrack(bool enable)
             m_overlayTrack = nullptr;
         }
     } else {
-        if (m_usePreview) {
+        if (m_usePreview && !keepPreview) {
             m_timelinePreview->disconnectTrack();
         }
         if (m_hasOverlayTrack) {
@@ -1758,6 +1758,11 @@ void Timeline::connectOverlayTrack(bool enable)
     m_tractor->unlock();
 }
 
+bool Timeline::hasPreviewTrack() const
+{
+    return m_usePreview;
+}
+
 void Timeline::removeSplitOverlay()
 {
     if (!m_hasOverlayTrack) {
@@ -2012,6 +2017,7 @@ void Timeline::updatePreviewSettings(const QString &profile)
 
 void Timeline::invalidateTrack(int ix)
 {
+    m_doc->renderer()->invalidateFrameCache();
     if (!m_timelinePreview) {
         return;
     }
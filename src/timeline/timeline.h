@@ -158,8 +158,10 @@ public:
     /** @brief Creates an overlay track with a ripple transition*/
     bool createRippleWindow(int tk, int startPos, OperationType mode);
     void removeSplitOverlay();
-    /** @brief Temporarily add/remove track before saving */
-    void connectOverlayTrack(bool enable);
+    /** @brief Temporarily add/remove track before saving, @param keepPreview leaves the timeline preview track in place */
+    void connectOverlayTrack(bool enable, bool keepPreview = false);
+    /** @brief Returns true if the timeline preview track is used */
+    bool hasPreviewTrack() const;
     /** @brief Update composite and mix transitions's tracks */
     void refreshTransitions();
     /** @brief Switch current track target state */
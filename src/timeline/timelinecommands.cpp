@@ -25,6 +25,87 @@
 #include "timeline.h"
 
 #include <klocalizedstring.h>
+#include <QJsonArray>
+
+static QJsonObject itemInfoRecord(const ItemInfo &info)
+{
+    QJsonObject record;
+    record.insert(QStringLiteral("start"), info.startPos.seconds());
+    record.insert(QStringLiteral("end"), info.endPos.seconds());
+    record.insert(QStringLiteral("cropstart"), info.cropStart.seconds());
+    record.insert(QStringLiteral("cropduration"), info.cropDuration.seconds());
+    record.insert(QStringLiteral("track"), info.track);
+    return record;
+}
+
+static ItemInfo itemInfoFromRecord(const QJsonValue &value)
+{
+    const QJsonObject record = value.toObject();
+    ItemInfo info;
+    info.startPos = GenTime(record.value(QStringLiteral("start")).toDouble());
+    info.endPos = GenTime(record.value(QStringLiteral("end")).toDouble());
+    info.cropStart = GenTime(record.value(QStringLiteral("cropstart")).toDouble());
+    info.cropDuration = GenTime(record.value(QStringLiteral("cropduration")).toDouble());
+    info.track = record.value(QStringLiteral("track")).toInt();
+    return info;
+}
+
+//static
+QJsonObject JournalCommand::record(const QUndoCommand *command)
+{
+    const JournalCommand *journalCommand = dynamic_cast<const JournalCommand *>(command);
+    if (journalCommand) {
+        return journalCommand->journalRecord();
+    }
+    if (command->childCount() == 0) {
+        return QJsonObject();
+    }
+    // A macro, only replayable if all its children are
+    QJsonArray children;
+    for (int i = 0; i < command->childCount(); ++i) {
+        QJsonObject child = record(command->child(i));
+        if (child.isEmpty()) {
+            return QJsonObject();
+        }
+        children.append(child);
+    }
+    QJsonObject macro;
+    macro.insert(QStringLiteral("type"), QStringLiteral("macro"));
+    macro.insert(QStringLiteral("text"), command->text());
+    macro.insert(QStringLiteral("children"), children);
+    return macro;
+}
+
+//static
+QUndoCommand *JournalCommand::fromRecord(CustomTrackView *view, const QJsonObject &record, QUndoCommand *parent)
+{
+    const QString type = record.value(QStringLiteral("type")).toString();
+    if (type == QLatin1String("move")) {
+        return new MoveClipCommand(view, itemInfoFromRecord(record.value(QStringLiteral("from"))), itemInfoFromRecord(record.value(QStringLiteral("to"))), false, true, parent);
+    }
+    if (type == QLatin1String("resize")) {
+        return new ResizeClipCommand(view, itemInfoFromRecord(record.value(QStringLiteral("from"))), itemInfoFromRecord(record.value(QStringLiteral("to"))), true, record.value(QStringLiteral("dontworry")).toBool(), parent);
+    }
+    if (type == QLatin1String("guide")) {
+        return new EditGuideCommand(view, GenTime(record.value(QStringLiteral("oldpos")).toDouble()), record.value(QStringLiteral("oldcomment")).toString(), GenTime(record.value(QStringLiteral("pos")).toDouble()), record.value(QStringLiteral("comment")).toString(), true, parent);
+    }
+    if (type == QLatin1String("macro")) {
+        const QJsonArray children = record.value(QStringLiteral("children")).toArray();
+        if (children.isEmpty()) {
+            return nullptr;
+        }
+        QUndoCommand *macro = new QUndoCommand(parent);
+        macro->setText(record.value(QStringLiteral("text")).toString());
+        for (const QJsonValue &child : children) {
+            if (!fromRecord(view, child.toObject(), macro)) {
+                delete macro;
+                return nullptr;
+            }
+        }
+        return macro;
+    }
+    return nullptr;
+}
 
 AddEffectCommand::AddEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &effect, bool doIt, QUndoCommand *parent) :
     QUndoCommand(parent),
@@ -390,6 +471,17 @@ void EditGuideCommand::redo()
     m_doIt = true;
 }
 
+QJsonObject EditGuideCommand::journalRecord() const
+{
+    QJsonObject record;
+    record.insert(QStringLiteral("type"), QStringLiteral("guide"));
+    record.insert(QStringLiteral("oldpos"), m_oldPos.seconds());
+    record.insert(QStringLiteral("oldcomment"), m_oldcomment);
+    record.insert(QStringLiteral("pos"), m_pos.seconds());
+    record.insert(QStringLiteral("comment"), m_comment);
+    return record;
+}
+
 EditTransitionCommand::EditTransitionCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &oldeffect, const QDomElement &effect, bool doIt, QUndoCommand *parent) :
     QUndoCommand(parent),
     m_view(view),
@@ -583,6 +675,19 @@ void MoveClipCommand::redo()
     m_alreadyMoved = false;
 }
 
+QJsonObject MoveClipCommand::journalRecord() const
+{
+    if (!m_success) {
+        // Nothing was changed
+        return QJsonObject();
+    }
+    QJsonObject record;
+    record.insert(QStringLiteral("type"), QStringLiteral("move"));
+    record.insert(QStringLiteral("from"), itemInfoRecord(m_startPos));
+    record.insert(QStringLiteral("to"), itemInfoRecord(m_endPos));
+    return record;
+}
+
 MoveEffectCommand::MoveEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QList<int> &oldPos, int newPos, QUndoCommand *parent) :
     QUndoCommand(parent),
     m_view(view),
@@ -827,6 +932,16 @@ void ResizeClipCommand::redo()
     m_doIt = true;
 }
 
+QJsonObject ResizeClipCommand::journalRecord() const
+{
+    QJsonObject record;
+    record.insert(QStringLiteral("type"), QStringLiteral("resize"));
+    record.insert(QStringLiteral("from"), itemInfoRecord(m_startPos));
+    record.insert(QStringLiteral("to"), itemInfoRecord(m_endPos));
+    record.insert(QStringLiteral("dontworry"), m_dontWorry);
+    return record;
+}
+
 SplitAudioCommand::SplitAudioCommand(CustomTrackView *view, const int track, int destTrack, const GenTime &pos, QUndoCommand *parent) :
     QUndoCommand(parent),
     m_view(view),
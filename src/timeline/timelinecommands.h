@@ -25,12 +25,28 @@
 
 #include <QUndoCommand>
 #include <QDomElement>
+#include <QJsonObject>
 #include "definitions.h"
 #include "effectslist/effectslist.h"
 class GenTime;
 class CustomTrackView;
 class Timeline;
 
+/** @class JournalCommand
+ *  @brief A timeline command that can be written to the autosave journal and replayed on crash recovery.
+ */
+class JournalCommand
+{
+public:
+    virtual ~JournalCommand() {}
+    /** @brief Returns the parameters needed to redo the command. */
+    virtual QJsonObject journalRecord() const = 0;
+    /** @brief Returns the journal record of a command, or of a macro made of journal commands, empty if it cannot be replayed. */
+    static QJsonObject record(const QUndoCommand *command);
+    /** @brief Creates a command from a journal record, returns nullptr if the record is invalid. */
+    static QUndoCommand *fromRecord(CustomTrackView *view, const QJsonObject &record, QUndoCommand *parent = nullptr);
+};
+
 class AddEffectCommand : public QUndoCommand
 {
 public:
@@ -186,12 +202,13 @@ private:
     bool m_refreshMonitor;
 };
 
-class EditGuideCommand : public QUndoCommand
+class EditGuideCommand : public QUndoCommand, public JournalCommand
 {
 public:
     EditGuideCommand(CustomTrackView *view, const GenTime &oldPos, const QString &oldcomment, const GenTime &pos, const QString &comment, bool doIt, QUndoCommand *parent = nullptr);
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    QJsonObject journalRecord() const Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     QString m_oldcomment;
@@ -274,12 +291,13 @@ private:
     bool m_lock;
 };
 
-class MoveClipCommand : public QUndoCommand
+class MoveClipCommand : public QUndoCommand, public JournalCommand
 {
 public:
     MoveClipCommand(CustomTrackView *view, const ItemInfo &start, const ItemInfo &end, bool alreadyMoved, bool doIt, QUndoCommand *parent = nullptr);
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    QJsonObject journalRecord() const Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     const ItemInfo m_startPos;
@@ -409,12 +427,13 @@ private:
     bool m_execOnUndo;
 };
 
-class ResizeClipCommand : public QUndoCommand
+class ResizeClipCommand : public QUndoCommand, public JournalCommand
 {
 public:
     ResizeClipCommand(CustomTrackView *view, const ItemInfo &start, const ItemInfo &end, bool doIt, bool dontWorry, QUndoCommand *parent = nullptr);
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    QJsonObject journalRecord() const Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     ItemInfo m_startPos;
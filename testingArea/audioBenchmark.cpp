@@ -0,0 +1,273 @@
+/*
+Copyright (C) 2012  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+Copyright (C) 2026 Kdenlive team <kdenlive@kde.org>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+/*
+  Benchmark for the audio alignment code in src/lib/audio.
+
+  Synthetic audio signals with a known offset are generated, so no external
+  media is needed. For every requested length, the envelope extraction, the
+  direct and FFT based correlation and the complete alignment are timed and
+  the detected shift is compared to the expected one.
+  Results are written as JSON; the exit code is non-zero if a detected shift
+  is off by more than the allowed tolerance.
+*/
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QVector>
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include "../src/lib/audio/audioCorrelation.h"
+#include "../src/lib/audio/audioCorrelationInfo.h"
+#include "../src/lib/audio/audioEnvelope.h"
+#include "../src/lib/audio/fftCorrelation.h"
+
+namespace {
+
+/// Sub clip and its expected shift relative to the main clip.
+struct AlignCase {
+    int mainLength;
+    int subLength;
+    int offset;
+};
+
+/**
+  Generates a speech-like signal: bursts of noise with random loudness,
+  separated by short quiet gaps, so that the envelope has some structure.
+  */
+QVector<qint16> generateSignal(int frames, int samplesPerFrame, quint32 seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> sample(-1.0, 1.0);
+    std::uniform_int_distribution<int> burstLength(3, 20);
+    std::uniform_int_distribution<int> gapLength(1, 10);
+    std::uniform_int_distribution<int> burstLevel(500, 8000);
+
+    QVector<qint16> signal(frames * samplesPerFrame);
+    int remaining = 0;
+    bool burst = false;
+    int level = 0;
+    for (int f = 0; f < frames; ++f) {
+        if (remaining == 0) {
+            burst = !burst;
+            remaining = burst ? burstLength(generator) : gapLength(generator);
+            level = burst ? burstLevel(generator) : 100;
+        }
+        --remaining;
+        qint16 *data = signal.data() + f * samplesPerFrame;
+        for (int k = 0; k < samplesPerFrame; ++k) {
+            data[k] = static_cast<qint16>(level * sample(generator));
+        }
+    }
+    return signal;
+}
+
+/**
+  Builds the sub signal: the main signal starting at frame \c offset, with
+  some added noise. Frames outside of the main signal are filled with
+  unrelated audio.
+  */
+QVector<qint16> generateSubSignal(const QVector<qint16> &main, const AlignCase &c, int samplesPerFrame)
+{
+    std::mt19937 generator(4711);
+    std::uniform_int_distribution<int> noise(-200, 200);
+    const QVector<qint16> unrelated = generateSignal(c.subLength, samplesPerFrame, 815);
+
+    QVector<qint16> sub(c.subLength * samplesPerFrame);
+    for (int f = 0; f < c.subLength; ++f) {
+        const int source = f + c.offset;
+        const qint16 *from = (source >= 0 && source < c.mainLength) ? main.constData() + source * samplesPerFrame
+                                                                   : unrelated.constData() + f * samplesPerFrame;
+        qint16 *to = sub.data() + f * samplesPerFrame;
+        for (int k = 0; k < samplesPerFrame; ++k) {
+            to[k] = static_cast<qint16>(qBound(-32768, from[k] + noise(generator), 32767));
+        }
+    }
+    return sub;
+}
+
+/// Same computation as AudioEnvelope::loadEnvelope(), followed by the mean removal of AudioEnvelope::slotProcessEnveloppe().
+QVector<qint64> extractEnvelope(const QVector<qint16> &signal, int samplesPerFrame)
+{
+    const int frames = signal.size() / samplesPerFrame;
+    QVector<qint64> envelope(frames);
+    qint64 mean = 0;
+    for (int f = 0; f < frames; ++f) {
+        envelope[f] = AudioEnvelope::frameEnvelope(signal.constData() + f * samplesPerFrame, samplesPerFrame);
+        mean += envelope.at(f);
+    }
+    mean /= frames;
+    for (int f = 0; f < frames; ++f) {
+        envelope[f] -= mean;
+    }
+    return envelope;
+}
+
+/// Runs \c job \c repeat times and returns the median duration in milliseconds.
+template <typename Job>
+double medianMs(int repeat, Job job)
+{
+    QVector<double> durations;
+    QElapsedTimer timer;
+    for (int i = 0; i < repeat; ++i) {
+        timer.start();
+        job();
+        durations << timer.nsecsElapsed() / 1000000.0;
+    }
+    std::sort(durations.begin(), durations.end());
+    return durations.at(durations.size() / 2);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("audioBenchmark"));
+    // The correlation code logs every run, which would spoil the timings
+    QLoggingCategory::setFilterRules(QStringLiteral("org.kde.multimedia.kdenlive.debug=false"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmarks and verifies the audio alignment code on synthetic signals."));
+    parser.addHelpOption();
+    QCommandLineOption lengthsOption(QStringLiteral("lengths"), QStringLiteral("Comma separated list of main clip lengths, in frames."),
+                                     QStringLiteral("frames"), QStringLiteral("250,1000,4000,12000"));
+    QCommandLineOption repeatOption(QStringLiteral("repeat"), QStringLiteral("Number of runs per measurement, the median is reported."),
+                                    QStringLiteral("count"), QStringLiteral("5"));
+    QCommandLineOption directOption(QStringLiteral("direct-limit"), QStringLiteral("Longest main clip for which the O(n²) direct correlation is run."),
+                                    QStringLiteral("frames"), QStringLiteral("4000"));
+    QCommandLineOption toleranceOption(QStringLiteral("tolerance"), QStringLiteral("Allowed difference between detected and expected shift."),
+                                       QStringLiteral("frames"), QStringLiteral("0"));
+    QCommandLineOption fpsOption(QStringLiteral("fps"), QStringLiteral("Frame rate of the synthetic clips."), QStringLiteral("fps"),
+                                 QStringLiteral("25"));
+    QCommandLineOption rateOption(QStringLiteral("frequency"), QStringLiteral("Audio sampling rate of the synthetic clips."),
+                                  QStringLiteral("Hz"), QStringLiteral("48000"));
+    QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("Write the JSON results to this file instead of stdout."),
+                                    QStringLiteral("file"));
+    parser.addOption(lengthsOption);
+    parser.addOption(repeatOption);
+    parser.addOption(directOption);
+    parser.addOption(toleranceOption);
+    parser.addOption(fpsOption);
+    parser.addOption(rateOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+    const int directLimit = parser.value(directOption).toInt();
+    const int tolerance = parser.value(toleranceOption).toInt();
+    const int fps = qMax(1, parser.value(fpsOption).toInt());
+    const int frequency = qMax(fps, parser.value(rateOption).toInt());
+    const int samplesPerFrame = frequency / fps;
+
+    QList<AlignCase> cases;
+    const QStringList lengths = parser.value(lengthsOption).split(QLatin1Char(','), QString::SkipEmptyParts);
+    for (const QString &length : lengths) {
+        const int mainLength = length.toInt();
+        if (mainLength < 16) {
+            std::cerr << "Ignoring invalid length " << length.toStdString() << std::endl;
+            continue;
+        }
+        // Sub clip inside of the main clip, and sub clip starting before the main clip
+        cases << AlignCase{mainLength, mainLength / 2, mainLength / 3};
+        cases << AlignCase{mainLength, mainLength / 2, -mainLength / 8};
+    }
+    if (cases.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    bool passed = true;
+    QJsonArray results;
+    for (const AlignCase &c : cases) {
+        const QVector<qint16> mainSignal = generateSignal(c.mainLength, samplesPerFrame, 42);
+        const QVector<qint16> subSignal = generateSubSignal(mainSignal, c, samplesPerFrame);
+        QJsonObject result;
+        result.insert(QStringLiteral("length"), c.mainLength);
+        result.insert(QStringLiteral("subLength"), c.subLength);
+        result.insert(QStringLiteral("expectedShift"), c.offset);
+
+        QVector<qint64> envMain;
+        QVector<qint64> envSub;
+        result.insert(QStringLiteral("envelopeMs"), medianMs(repeat, [&]() {
+            envMain = extractEnvelope(mainSignal, samplesPerFrame);
+            envSub = extractEnvelope(subSignal, samplesPerFrame);
+        }));
+
+        bool ok = true;
+        AudioCorrelationInfo info(c.mainLength, c.subLength);
+        if (c.mainLength <= directLimit) {
+            result.insert(QStringLiteral("directMs"), medianMs(repeat, [&]() {
+                AudioCorrelation::correlate(envMain.constData(), c.mainLength, envSub.constData(), c.subLength, info.correlationVector());
+            }));
+            const int shift = info.maxIndex() - c.subLength;
+            result.insert(QStringLiteral("directShift"), shift);
+            ok = ok && qAbs(shift - c.offset) <= tolerance;
+        }
+
+        result.insert(QStringLiteral("fftMs"), medianMs(repeat, [&]() {
+            FFTCorrelation::correlate(envMain.constData(), c.mainLength, envSub.constData(), c.subLength, info.correlationVector());
+        }));
+        int shift = info.maxIndex() - c.subLength;
+        result.insert(QStringLiteral("fftShift"), shift);
+        ok = ok && qAbs(shift - c.offset) <= tolerance;
+
+        // Complete alignment, as done when aligning clips in the timeline
+        result.insert(QStringLiteral("alignMs"), medianMs(repeat, [&]() {
+            const QVector<qint64> mainEnv = extractEnvelope(mainSignal, samplesPerFrame);
+            const QVector<qint64> subEnv = extractEnvelope(subSignal, samplesPerFrame);
+            AudioCorrelationInfo *alignInfo = AudioCorrelation::correlateEnvelopes(mainEnv.constData(), mainEnv.size(), subEnv.constData(), subEnv.size());
+            shift = alignInfo->maxIndex() - subEnv.size();
+            delete alignInfo;
+        }));
+        result.insert(QStringLiteral("alignShift"), shift);
+        ok = ok && qAbs(shift - c.offset) <= tolerance;
+
+        result.insert(QStringLiteral("ok"), ok);
+        results.append(result);
+        passed = passed && ok;
+
+        std::cerr << (ok ? "ok   " : "FAIL ") << c.mainLength << " frames, offset " << c.offset
+                  << ": envelope " << result.value(QStringLiteral("envelopeMs")).toDouble() << " ms"
+                  << ", fft " << result.value(QStringLiteral("fftMs")).toDouble() << " ms"
+                  << ", align " << result.value(QStringLiteral("alignMs")).toDouble() << " ms" << std::endl;
+    }
+
+    QJsonObject report;
+    report.insert(QStringLiteral("benchmark"), QStringLiteral("audio-alignment"));
+    report.insert(QStringLiteral("fps"), fps);
+    report.insert(QStringLiteral("frequency"), frequency);
+    report.insert(QStringLiteral("repeat"), repeat);
+    report.insert(QStringLiteral("tolerance"), tolerance);
+    report.insert(QStringLiteral("results"), results);
+    report.insert(QStringLiteral("passed"), passed);
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::cerr << "Cannot write " << file.fileName().toStdString() << std::endl;
+            return 2;
+        }
+        file.write(json);
+    } else {
+        std::cout << json.constData();
+    }
+    return passed ? 0 : 1;
+}